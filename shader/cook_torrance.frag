@@ -1,6 +1,8 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
 layout (location = 2) in vec3 fragPositionWorld;
 layout (location = 3) in vec3 fragNormalWorld;
 // layout (location = 2) in vec2 fragUV;
@@ -17,16 +19,28 @@ struct Material {
     float ambientOcclusion;
     float padding1; // pad to 16 bytes
     float emission;
+    int albedoTexture; // 材质贴图数组中的下标，-1 表示没有贴图
+    int roughnessTexture;
+    int metallicTexture;
+    int normalTexture;
 };
 
-layout(binding = 2) uniform MaterialBlock {
-    Material materials[8]; // Max 128 shapes
+layout(std430, binding = 2) readonly buffer MaterialBlock {
+    Material materials[]; // 数量与形状数一致
 }Material_ubo;
 
 layout(set = 0, binding = 4) uniform samplerCube irradianceMap; // 辐照度贴图
 layout(set = 0, binding = 5) uniform samplerCube prefilteredMap; // 预过滤环境贴图
 layout(set = 0, binding = 6) uniform sampler2D brdfLUT; // BRDF LUT
 
+#define MAX_MATERIAL_TEXTURES 128 // 与 C++ 侧一致，空位绑定默认白色贴图
+layout(set = 0, binding = 7) uniform sampler2D materialTextures[MAX_MATERIAL_TEXTURES];
+// mip 流式加载：片元着色器上报需要的最精细层级，CPU 据此上传，并写回已驻留的层级
+layout(std430, set = 0, binding = 8) buffer MaterialTextureStreaming {
+    uint requestedMip[MAX_MATERIAL_TEXTURES];
+    float residentMip[MAX_MATERIAL_TEXTURES];
+};
+
 // // === Material Parameters ===
 // uniform vec3 albedo = vec3(1.0, 0.0, 0.0);   // Base color
 // uniform float metallic = 0.0;
@@ -74,6 +88,37 @@ vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness) {
     return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(1.0 - cosTheta, 5.0);
 } 
 
+// === 材质贴图 ===
+bool hasMaterialTexture(int index) {
+    return index >= 0 && index < MAX_MATERIAL_TEXTURES;
+}
+
+vec4 sampleMaterialTexture(int index) {
+    float lod = textureQueryLod(materialTextures[nonuniformEXT(index)], fragTexCoord).x;
+    // 每个 8x8 像素块只由一个像素上报，减少原子操作
+    if (all(equal(ivec2(gl_FragCoord.xy) & 7, ivec2(0)))) {
+        atomicMin(requestedMip[index], uint(max(lod, 0.0)));
+    }
+    // 未驻留的精细层级内容未定义，钳制到已驻留的层级
+    return textureLod(materialTextures[nonuniformEXT(index)], fragTexCoord, max(lod, residentMip[index]));
+}
+
+// 没有顶点切线，用屏幕空间导数构建余切坐标系
+vec3 perturbNormal(vec3 normal, vec3 tangentNormal) {
+    vec3 dp1 = dFdx(fragPositionWorld);
+    vec3 dp2 = dFdy(fragPositionWorld);
+    vec2 duv1 = dFdx(fragTexCoord);
+    vec2 duv2 = dFdy(fragTexCoord);
+    vec3 dp2perp = cross(dp2, normal);
+    vec3 dp1perp = cross(normal, dp1);
+    vec3 T = dp2perp * duv1.x + dp1perp * duv2.x;
+    vec3 B = dp2perp * duv1.y + dp1perp * duv2.y;
+    float invmax = inversesqrt(max(dot(T, T), dot(B, B)));
+    if (isinf(invmax)) return normal;
+    // 加载时翻转了 V，切线空间的 +Y 对应 -dP/dv
+    return normalize(T * invmax * tangentNormal.x - B * invmax * tangentNormal.y + normal * tangentNormal.z);
+}
+
 // === Main Shader ===
 void main() {
     // === Material Parameters ===
@@ -83,6 +128,10 @@ void main() {
     vec3 albedo = fragColor;   // Base color
     float metallic = mat.metallic;
     float roughness = mat.roughness;
+    // 贴图以 UNORM 存储，基础色在这里做 sRGB 解码
+    if (hasMaterialTexture(mat.albedoTexture)) albedo *= pow(sampleMaterialTexture(mat.albedoTexture).rgb, vec3(2.2));
+    if (hasMaterialTexture(mat.roughnessTexture)) roughness *= sampleMaterialTexture(mat.roughnessTexture).g;
+    if (hasMaterialTexture(mat.metallicTexture)) metallic *= sampleMaterialTexture(mat.metallicTexture).b;
     float ambientOcclusion = mat.ambientOcclusion;
 
     // === Camera & Light ===
@@ -93,6 +142,9 @@ void main() {
     // 基础向量
     vec3 flipNormal = dot(fragNormalWorld, normalize(viewPos - fragPositionWorld)) > 0.0 ? fragNormalWorld : -fragNormalWorld; // 反转法线 
     vec3 normal = normalize(flipNormal);
+    if (hasMaterialTexture(mat.normalTexture)) {
+        normal = perturbNormal(normal, sampleMaterialTexture(mat.normalTexture).xyz * 2.0 - 1.0);
+    }
     vec3 viewDirection = normalize(cameraPosition - fragPositionWorld);
     vec3 lightDirection = normalize(lightPosition - fragPositionWorld);
     vec3 halfVector = normalize(viewDirection + lightDirection);
@@ -3,10 +3,13 @@
 layout(location = 0) in vec3 fragPosition;  // 从顶点着色器传递的世界空间位置
 layout(location = 1) in vec3 fragNormal;    // 从顶点着色器传递的世界空间法线
 layout(location = 2) in vec3 fragColor;     // 从顶点着色器传递的顶点颜色
+layout(location = 3) in vec4 fragCurrentClip;  // 本帧裁剪空间位置
+layout(location = 4) in vec4 fragPreviousClip; // 上一帧裁剪空间位置
 
 layout(location = 0) out vec4 outColor;     // 输出到颜色附件
 layout(location = 1) out vec4 outNormal;    // 输出到法线附件
 layout(location = 2) out vec4 outPosition;  // 输出到位置附件
+layout(location = 3) out vec2 outMotion;    // 输出到运动向量附件：本帧 uv - 上一帧 uv
 
 void main() {
     // 输出漫反射颜色
@@ -17,4 +20,9 @@ void main() {
 
     // 输出世界空间位置
     outPosition = vec4(fragPosition, 1.0);
-}
\ No newline at end of file
+
+    // 屏幕空间运动向量，上一帧的 uv = 本帧 uv - outMotion
+    vec2 currentUV = fragCurrentClip.xy / fragCurrentClip.w * 0.5 + 0.5;
+    vec2 previousUV = fragPreviousClip.xy / fragPreviousClip.w * 0.5 + 0.5;
+    outMotion = currentUV - previousUV;
+}
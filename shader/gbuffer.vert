@@ -8,11 +8,17 @@ layout(location = 3) in uint inShapeID;
 layout(location = 0) out vec3 fragPosition;  // 传递到片段着色器的世界空间位置
 layout(location = 1) out vec3 fragNormal;    // 传递到片段着色器的世界空间法线
 layout(location = 2) out vec3 fragColor;     // 传递到片段着色器的顶点颜色
+layout(location = 3) out vec4 fragCurrentClip;  // 本帧裁剪空间位置
+layout(location = 4) out vec4 fragPreviousClip; // 上一帧裁剪空间位置
 
 layout(set = 0, binding = 0) uniform UniformBufferObject {
     mat4 model;       // 模型矩阵
     mat4 view;        // 视图矩阵
     mat4 projection;  // 投影矩阵
+    vec3 cameraPos;
+    float padding;
+    mat4 lightSpaceMatrix;
+    mat4 prevViewProj; // 上一帧的视图投影矩阵
 } ubo;
 
 void main() {
@@ -28,4 +34,8 @@ void main() {
 
     // 计算裁剪空间位置
     gl_Position = ubo.projection * ubo.view * worldPosition;
+
+    // 运动向量在片段着色器中按像素做透视除法，避免插值后的误差
+    fragCurrentClip = gl_Position;
+    fragPreviousClip = ubo.prevViewProj * worldPosition;
 }
\ No newline at end of file
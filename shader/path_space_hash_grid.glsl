@@ -0,0 +1,96 @@
+// path_space_hash_grid.glsl
+// 路径空间滤波与辐亮度缓存共用的哈希网格：以量化位置 + 法线朝向为键的开放寻址哈希表 (线性探测)，
+// 路径追踪把缓存顶点的出射辐亮度累加进格子，解析 pass 再把本帧的和并入跨帧的均值
+#ifndef PATH_SPACE_HASH_GRID_GLSL
+#define PATH_SPACE_HASH_GRID_GLSL
+
+// 布局与 C++ 侧 PathSpaceCacheCell 一致 (std430，48 字节)
+struct HashGridCell {
+    vec4 radiance;         // 解析后的出射辐亮度，a 为有效历史样本数
+    uint accumulatedR;     // 本帧累加的定点辐亮度，由解析 pass 清零
+    uint accumulatedG;
+    uint accumulatedB;
+    uint accumulatedCount;
+    uint key;              // HASH_GRID_EMPTY 为空槽，HASH_GRID_TOMBSTONE 为已删除
+    uint age;              // 连续没有新样本的帧数
+    uint padding0;
+    uint padding1;
+};
+
+#ifndef HASH_GRID_SET
+#define HASH_GRID_SET 1
+#define HASH_GRID_BINDING 12
+#endif
+layout(std430, set = HASH_GRID_SET, binding = HASH_GRID_BINDING) buffer PathSpaceHashGrid {
+    HashGridCell hashGridCells[];
+};
+
+#define HASH_GRID_INVALID 0xFFFFFFFFu   // 插入失败时返回的槽位
+#define HASH_GRID_EMPTY 0u               // 从未使用过的槽位，探测到这里即可确定键不存在
+#define HASH_GRID_TOMBSTONE 0xFFFFFFFFu // 被删除的槽位，探测时跳过，只有新插入的键可以回收
+#define HASH_GRID_PROBE_COUNT 8      // 线性探测的最大步数，用完视为表满
+// 定点累加：单个样本最多 MAX_RADIANCE * RADIANCE_SCALE = 65536，每帧每格最多累加 MAX_FRAME_SAMPLES 个样本，
+// 65536 * 65535 < 2^32，一帧内的 uint 和不会回绕；超出名额的样本只计数不累加
+#define HASH_GRID_RADIANCE_SCALE 256.0
+#define HASH_GRID_MAX_RADIANCE 256.0
+#define HASH_GRID_MAX_FRAME_SAMPLES 65535u
+#define HASH_GRID_MIN_DISTANCE 0.01
+#define HASH_GRID_MAX_HISTORY 64.0   // 跨帧均值的最大样本权重，光照变化后约这么多样本内跟上
+#define HASH_GRID_MIN_HISTORY 4.0    // 样本数达到后才用于代替路径本身的估计
+#define HASH_GRID_MAX_AGE 120u       // 连续这么多帧没有样本的格子让出槽位
+#define HASH_GRID_MIN_ROUGHNESS 0.3  // 顶点足够粗糙时出射辐亮度才近似与方向无关
+
+uint hashGridMix(uint x) {
+    uint state = x * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+// 格子边长取 2 的幂并随到相机的距离增大 (约为 distance * cellScale)，在屏幕上的大小大致不变；
+// 法线按主轴量化到 6 个方向，墙角两侧的表面不会落进同一个格子
+uint hashGridKey(vec3 P, vec3 N, vec3 viewPosition, float cellScale) {
+    float distanceToView = max(length(P - viewPosition), HASH_GRID_MIN_DISTANCE);
+    int level = int(floor(log2(distanceToView * cellScale)));
+    ivec3 cell = ivec3(floor(P / exp2(float(level))));
+    vec3 a = abs(N);
+    uint axis = (a.x > a.y && a.x > a.z) ? 0u : (a.y > a.z ? 1u : 2u);
+    uint normalCode = axis * 2u + (N[axis] < 0.0 ? 1u : 0u);
+
+    uint h = hashGridMix(uint(cell.x));
+    h = hashGridMix(h ^ uint(cell.y));
+    h = hashGridMix(h ^ uint(cell.z));
+    h = hashGridMix(h ^ ((uint(level + 128) << 3u) | normalCode));
+    return clamp(h, HASH_GRID_EMPTY + 1u, HASH_GRID_TOMBSTONE - 1u); // 两端保留给空槽与墓碑
+}
+
+// 查找键所在的槽位，不存在时插入。探测跳过墓碑，遇到空槽说明键不在链上，直接占用；
+// 探测步数用完仍未找到时回收第一个墓碑，都失败返回 HASH_GRID_INVALID。
+// 墓碑只在整条链没有空槽时回收，同一个键的并发插入走相同的探测序列，不会落进两个槽位
+uint hashGridInsert(uint key) {
+    uint capacity = uint(hashGridCells.length());
+    uint firstTombstone = HASH_GRID_INVALID;
+    for (uint i = 0u; i < HASH_GRID_PROBE_COUNT; ++i) {
+        uint index = (key + i) % capacity;
+        uint previous = atomicCompSwap(hashGridCells[index].key, HASH_GRID_EMPTY, key);
+        if (previous == HASH_GRID_EMPTY || previous == key) return index;
+        if (previous == HASH_GRID_TOMBSTONE && firstTombstone == HASH_GRID_INVALID) firstTombstone = index;
+    }
+    if (firstTombstone == HASH_GRID_INVALID) return HASH_GRID_INVALID;
+
+    uint previous = atomicCompSwap(hashGridCells[firstTombstone].key, HASH_GRID_TOMBSTONE, key);
+    return (previous == HASH_GRID_TOMBSTONE || previous == key) ? firstTombstone : HASH_GRID_INVALID;
+}
+
+void hashGridAccumulate(uint index, vec3 radiance) {
+    // 先占样本名额，名额用完的样本不再累加，解析时样本数按名额上限截断
+    uint sampleSlot = atomicAdd(hashGridCells[index].accumulatedCount, 1u);
+    if (sampleSlot >= HASH_GRID_MAX_FRAME_SAMPLES) return;
+
+    vec3 clamped = clamp(radiance, vec3(0.0), vec3(HASH_GRID_MAX_RADIANCE));
+    uvec3 fixedPoint = uvec3(clamped * HASH_GRID_RADIANCE_SCALE + 0.5);
+    if (fixedPoint.r > 0u) atomicAdd(hashGridCells[index].accumulatedR, fixedPoint.r);
+    if (fixedPoint.g > 0u) atomicAdd(hashGridCells[index].accumulatedG, fixedPoint.g);
+    if (fixedPoint.b > 0u) atomicAdd(hashGridCells[index].accumulatedB, fixedPoint.b);
+}
+
+#endif
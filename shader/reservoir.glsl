@@ -0,0 +1,53 @@
+// reservoir.glsl
+// ReSTIR DI 的加权蓄水池采样 (Bitterli et al. 2020)，布局与 C++ 端 Reservoir 结构体一致 (std430)
+#ifndef RESERVOIR_GLSL
+#define RESERVOIR_GLSL
+
+struct Reservoir {
+    vec3 lightPosition;   // 选中的光源采样点
+    float weightSum;      // 候选权重之和
+    vec3 lightNormal;     // 光源采样点法线
+    float sampleCount;    // M
+    vec3 surfacePosition; // 着色点，用于复用时的几何校验
+    float W;              // 无偏贡献权重
+    vec3 surfaceNormal;
+    uint lightIndex;      // 光源三角形索引
+};
+
+Reservoir emptyReservoir() {
+    Reservoir r;
+    r.lightPosition = vec3(0.0);
+    r.weightSum = 0.0;
+    r.lightNormal = vec3(0.0, 1.0, 0.0);
+    r.sampleCount = 0.0;
+    r.surfacePosition = vec3(0.0);
+    r.W = 0.0;
+    r.surfaceNormal = vec3(0.0, 1.0, 0.0);
+    r.lightIndex = 0u;
+    return r;
+}
+
+// 以权重 w 加入一个候选，u 为 [0, 1) 随机数
+bool updateReservoir(inout Reservoir r, vec3 lightPosition, vec3 lightNormal, uint lightIndex, float w, float u) {
+    r.weightSum += w;
+    if (w > 0.0 && u * r.weightSum < w) {
+        r.lightPosition = lightPosition;
+        r.lightNormal = lightNormal;
+        r.lightIndex = lightIndex;
+        return true;
+    }
+    return false;
+}
+
+// 合并另一个蓄水池，targetPdf 为 src 的样本在 dst 着色点处的目标函数值
+void mergeReservoir(inout Reservoir dst, Reservoir src, float targetPdf, float u) {
+    updateReservoir(dst, src.lightPosition, src.lightNormal, src.lightIndex, targetPdf * src.W * src.sampleCount, u);
+    dst.sampleCount += src.sampleCount;
+}
+
+// W = weightSum / (M * p_hat(y))
+void finalizeReservoir(inout Reservoir r, float targetPdf) {
+    r.W = (targetPdf > 0.0 && r.sampleCount > 0.0) ? r.weightSum / (r.sampleCount * targetPdf) : 0.0;
+}
+
+#endif
@@ -0,0 +1,147 @@
+// restir_di_common.glsl
+// ReSTIR DI 时域 / 空间复用两个 pass 共享的资源声明与目标函数
+#ifndef RESTIR_DI_COMMON_GLSL
+#define RESTIR_DI_COMMON_GLSL
+
+#include "sampler.glsl"
+#include "reservoir.glsl"
+
+struct Triangle {
+    vec3 v0, v1, v2;
+    vec3 n0, n1, n2; // 顶点法线
+    vec3 normal;
+    uint materialID;
+    vec2 uv0, uv1, uv2; // 顶点纹理坐标
+};
+
+struct EmissiveTriangle {
+    uint emissiveTriangleIndex;
+};
+
+struct Material {
+    vec3 albedo;
+    float metallic;
+    float roughness;
+    float ambientOcclusion;
+    float padding1;
+    float emission;
+    int albedoTexture; // 材质贴图数组中的下标，-1 表示没有贴图
+    int roughnessTexture;
+    int metallicTexture;
+    int normalTexture;
+};
+
+// set 0：与交换链图像对应的 G-buffer 与蓄水池
+layout(set = 0, binding = 0) uniform sampler2D gbufferPosition; // 世界空间位置
+layout(set = 0, binding = 1) uniform sampler2D gbufferNormal;   // n * 0.5 + 0.5
+layout(set = 0, binding = 2) uniform sampler2D gbufferDepth;
+layout(std430, set = 0, binding = 3) buffer Reservoirs { Reservoir reservoirs[]; };                         // 最终 / 历史
+layout(std430, set = 0, binding = 4) buffer IntermediateReservoirs { Reservoir intermediateReservoirs[]; }; // 时域复用结果
+
+// set 1：与 MAX_FRAMES_IN_FLIGHT 对应的场景数据，布局与路径追踪管线一致
+layout(std140, set = 1, binding = 0) buffer Triangles { Triangle tris[]; };
+layout(std430, set = 1, binding = 1) readonly buffer MaterialBlock { Material materials[]; };
+layout(std140, set = 1, binding = 2) uniform CameraData {
+    mat4 invViewProj;
+    vec3 cameraPos;
+    int frame;
+    mat4 prevViewProj;
+    uint frameCounter;
+    int useReSTIR;
+    int maxBounces;
+    int rouletteMinDepth;
+    vec2 pixelJitter;
+    float renderScale;
+    float noiseTarget;
+    int samplesPerPixel;
+    int fireflyMode;
+    float fireflyClampFactor;
+    float regularizationStrength;
+    int collectRayStatistics;
+    int compensatedAccumulation;
+    int pathSpaceFiltering;
+    float pathSpaceCellSize;
+    int radianceCache;
+    int radianceCacheBounce;
+    float radianceCacheUpdateRate;
+};
+layout(std140, set = 1, binding = 3) buffer EmissiveTriangles { EmissiveTriangle emissiveIndex[]; };
+
+// 蓄水池与路径追踪输出同尺寸，可能小于 G-buffer (renderScale < 1)
+layout(push_constant) uniform ReSTIRParams { ivec2 reservoirExtent; };
+
+#define RESTIR_INITIAL_CANDIDATES 32   // 每像素初始候选数
+#define RESTIR_MAX_HISTORY 20.0        // 历史 M 上限 (相对当前帧 M 的倍数)
+#define RESTIR_SPATIAL_SAMPLES 5       // 空间复用邻居数
+#define RESTIR_SPATIAL_RADIUS 30.0     // 空间复用半径 (像素)
+#define RESTIR_NORMAL_THRESHOLD 0.9    // 法线夹角余弦阈值
+#define RESTIR_DEPTH_THRESHOLD 0.05    // 平面距离阈值 (相对到相机的距离)
+#define RESTIR_EPSILON 0.000001
+
+bool isInsideImage(ivec2 pix, ivec2 size) {
+    return all(greaterThanEqual(pix, ivec2(0))) && all(lessThan(pix, size));
+}
+
+// 两个着色点是否足够相似，可以互相复用样本
+bool isSimilarSurface(vec3 P, vec3 N, vec3 otherP, vec3 otherN) {
+    if (dot(N, otherN) < RESTIR_NORMAL_THRESHOLD) return false;
+    float viewDistance = max(length(P - cameraPos), RESTIR_EPSILON);
+    return abs(dot(N, otherP - P)) < RESTIR_DEPTH_THRESHOLD * viewDistance;
+}
+
+float lightEmission(uint lightIndex) {
+    if (lightIndex >= uint(tris.length())) return 0.0;
+    return materials[tris[lightIndex].materialID].emission;
+}
+
+// 目标函数 p_hat = Le * cos_s * cos_l / d^2，不含 BRDF 与可见性
+float targetPdf(vec3 P, vec3 N, vec3 lightPosition, vec3 lightNormal, uint lightIndex) {
+    vec3 toLight = lightPosition - P;
+    float distSq = dot(toLight, toLight);
+    if (distSq <= RESTIR_EPSILON) return 0.0;
+    vec3 L = toLight * inversesqrt(distSq);
+    float cosSurface = dot(N, L);
+    float cosLight = abs(dot(lightNormal, L)); // 光源双面发光
+    if (cosSurface <= 0.0) return 0.0;
+    return lightEmission(lightIndex) * cosSurface * cosLight / distSq;
+}
+
+float targetPdf(vec3 P, vec3 N, Reservoir r) {
+    return targetPdf(P, N, r.lightPosition, r.lightNormal, r.lightIndex);
+}
+
+// 均匀选择发光三角形并在其上均匀采样一点，返回面积测度下的 pdf
+float sampleLight(float uSelect, vec2 uTriangle, out vec3 lightPosition, out vec3 lightNormal, out uint lightIndex) {
+    uint numLights = uint(emissiveIndex.length());
+    uint emissiveArrayIndex = min(uint(uSelect * float(numLights)), numLights - 1u);
+    lightIndex = emissiveIndex[emissiveArrayIndex].emissiveTriangleIndex;
+
+    Triangle tri = tris[lightIndex];
+    float su0 = sqrt(uTriangle.x);
+    float b0 = 1.0 - su0;
+    float b1 = uTriangle.y * su0;
+    lightPosition = tri.v0 * b0 + tri.v1 * b1 + tri.v2 * (1.0 - b0 - b1);
+    vec3 crossEdges = cross(tri.v1 - tri.v0, tri.v2 - tri.v0);
+    float area = length(crossEdges) * 0.5;
+    lightNormal = crossEdges / max(2.0 * area, RESTIR_EPSILON);
+    return area > RESTIR_EPSILON ? 1.0 / (float(numLights) * area) : 0.0;
+}
+
+// 蓄水池像素中心对应的 G-buffer 像素
+ivec2 toGBufferPixel(ivec2 pix) {
+    ivec2 gbufferSize = textureSize(gbufferPosition, 0);
+    vec2 scale = vec2(gbufferSize) / vec2(reservoirExtent);
+    return min(ivec2((vec2(pix) + 0.5) * scale), gbufferSize - 1);
+}
+
+void loadSurface(ivec2 pix, out vec3 P, out vec3 N) {
+    ivec2 gbufferPix = toGBufferPixel(pix);
+    P = texelFetch(gbufferPosition, gbufferPix, 0).xyz;
+    N = normalize(texelFetch(gbufferNormal, gbufferPix, 0).xyz * 2.0 - 1.0);
+}
+
+bool isBackground(ivec2 pix) {
+    return texelFetch(gbufferDepth, toGBufferPixel(pix), 0).r >= 1.0;
+}
+
+#endif
@@ -0,0 +1,79 @@
+// sampler.glsl
+// 路径追踪共享的低差异采样器：Owen 扰乱的 Sobol 序列 (Burley 2020, "Practical Hash-based Owen Scrambling")
+// 每次调用 rand()/rand2() 消耗一个维度；每个维度使用独立种子对 2D Sobol 进行 shuffle + scramble (padding)，
+// 因此任意维度都保持良好的分层性，同时不同像素之间去相关。
+#ifndef SAMPLER_GLSL
+#define SAMPLER_GLSL
+
+uint samplerPixelSeed;  // 像素种子
+uint samplerIndex;      // 当前样本序号 (frame * SPP + i)
+uint samplerDimension;  // 当前已消耗的维度
+
+uint hashUint(uint x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+uint hashCombine(uint seed, uint v) {
+    return seed ^ (v + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+}
+
+// Sobol 第 0 维就是 van der Corput 序列 (按位反转)
+uint sobolDim0(uint index) {
+    return bitfieldReverse(index);
+}
+
+// Sobol 第 1 维，生成矩阵为 mod 2 的 Pascal 矩阵
+uint sobolDim1(uint index) {
+    uint result = 0u;
+    for (uint v = 1u << 31; index != 0u; index >>= 1, v ^= v >> 1) {
+        if ((index & 1u) != 0u) result ^= v;
+    }
+    return result;
+}
+
+uint laineKarrasPermutation(uint x, uint seed) {
+    x ^= x * 0x3d20adeau;
+    x += seed;
+    x *= (seed >> 16) | 1u;
+    x ^= x * 0x05526c56u;
+    x ^= x * 0x53a22864u;
+    return x;
+}
+
+uint nestedUniformScramble(uint x, uint seed) {
+    x = bitfieldReverse(x);
+    x = laineKarrasPermutation(x, seed);
+    x = bitfieldReverse(x);
+    return x;
+}
+
+float uintToUnitFloat(uint x) {
+    return float(x >> 8) * (1.0 / 16777216.0); // 保证结果 < 1
+}
+
+void initSampler(uvec2 pix, uint sampleIndex) {
+    samplerPixelSeed = hashUint(pix.x ^ hashUint(pix.y));
+    samplerIndex = sampleIndex;
+    samplerDimension = 0u;
+}
+
+vec2 rand2() {
+    uint seed = hashCombine(samplerPixelSeed, hashUint(samplerDimension++));
+    uint shuffledIndex = nestedUniformScramble(samplerIndex, seed);
+    uint x = nestedUniformScramble(sobolDim0(shuffledIndex), hashCombine(seed, 0u));
+    uint y = nestedUniformScramble(sobolDim1(shuffledIndex), hashCombine(seed, 1u));
+    return vec2(uintToUnitFloat(x), uintToUnitFloat(y));
+}
+
+float rand() {
+    uint seed = hashCombine(samplerPixelSeed, hashUint(samplerDimension++));
+    uint shuffledIndex = nestedUniformScramble(samplerIndex, seed);
+    return uintToUnitFloat(nestedUniformScramble(sobolDim0(shuffledIndex), hashCombine(seed, 0u)));
+}
+
+#endif
@@ -12,6 +12,7 @@ layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec3 inNormal;
 layout(location = 3) in uint inShapeID;
+layout(location = 4) in vec2 inTexCoord;
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
@@ -30,5 +31,5 @@ void main() {
     // 用于 shadow map 的位置（light space 下）
     fragPosLightSpace = ubo.lightSpaceMatrix  * vec4(inPosition, 1.0);
     gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
-    //fragTexCoord = inTexCoord;
+    fragTexCoord = inTexCoord;
 }
\ No newline at end of file
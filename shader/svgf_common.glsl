@@ -0,0 +1,85 @@
+// svgf_common.glsl
+// SVGF 时域累积、方差估计、à-trous 三类 pass 共享的资源声明与辅助函数
+#ifndef SVGF_COMMON_GLSL
+#define SVGF_COMMON_GLSL
+
+// 颜色类中间图像的格式由 C++ 侧按存储精度传入，需与图像视图一致
+#ifndef OUTPUT_IMAGE_FORMAT
+#define OUTPUT_IMAGE_FORMAT rgba32f
+#endif
+
+layout(binding = 0) uniform sampler2D pathTracedColor; // 上采样后的全分辨率结果
+layout(binding = 1) uniform sampler2D gbufferNormal;   // n * 0.5 + 0.5
+layout(binding = 2) uniform sampler2D gbufferDepth;
+layout(binding = 3, OUTPUT_IMAGE_FORMAT) uniform writeonly image2D outputImage; // 本次 dispatch 的输出
+layout(binding = 4) uniform sampler2D gbufferPosition; // 世界空间位置
+layout(binding = 5, OUTPUT_IMAGE_FORMAT) uniform readonly image2D inputImage; // 本次 dispatch 的输入，alpha 为方差
+// 按帧交替的两份：xy = 亮度一阶 / 二阶矩，zw = 八面体编码的法线
+layout(binding = 6, rgba32f) uniform readonly image2D prevMoments;
+layout(binding = 7, rgba32f) uniform image2D currentMoments;
+// 按帧交替的两份：xyz = 世界空间位置，w = 历史长度 (0 表示背景或没有历史)
+layout(binding = 8, rgba32f) uniform readonly image2D prevSurface;
+layout(binding = 9, rgba32f) uniform image2D currentSurface;
+layout(binding = 10) uniform sampler2D gbufferMotion; // 本帧 uv - 上一帧 uv
+
+layout(push_constant) uniform SVGFParams {
+    int stepSize;      // à-trous 采样间隔 (1 << 迭代序号)
+    int lastIteration; // 最后一次迭代写入显示用的降噪输出，alpha 写 1
+};
+
+#define SVGF_EPSILON 0.0001
+#define SVGF_PHI_NORMAL 128.0 // 法线边缘停止的指数
+#define SVGF_PHI_DEPTH 1.0    // 深度边缘停止相对于局部深度梯度的容差
+
+bool isInsideImage(ivec2 pix, ivec2 size) {
+    return all(greaterThanEqual(pix, ivec2(0))) && all(lessThan(pix, size));
+}
+
+bool isBackground(ivec2 pix) {
+    return texelFetch(gbufferDepth, pix, 0).r >= 1.0;
+}
+
+float luminance(vec3 c) {
+    return dot(c, vec3(0.2126, 0.7152, 0.0722));
+}
+
+vec3 loadNormal(ivec2 pix) {
+    return normalize(texelFetch(gbufferNormal, pix, 0).xyz * 2.0 - 1.0);
+}
+
+// 中心差分估计深度的屏幕空间梯度 (计算着色器中没有 dFdx / dFdy)
+vec2 depthGradient(ivec2 pix, ivec2 size) {
+    ivec2 right = min(pix + ivec2(1, 0), size - 1);
+    ivec2 left = max(pix - ivec2(1, 0), ivec2(0));
+    ivec2 down = min(pix + ivec2(0, 1), size - 1);
+    ivec2 up = max(pix - ivec2(0, 1), ivec2(0));
+    float dx = texelFetch(gbufferDepth, right, 0).r - texelFetch(gbufferDepth, left, 0).r;
+    float dy = texelFetch(gbufferDepth, down, 0).r - texelFetch(gbufferDepth, up, 0).r;
+    return vec2(dx / float(max(right.x - left.x, 1)), dy / float(max(down.y - up.y, 1)));
+}
+
+// 法线与深度的边缘停止权重；深度差按沿偏移方向外推的梯度归一化，斜面上不会被误判为边缘
+float geometryWeight(vec3 N, float depth, vec2 gradient, vec3 sampleN, float sampleDepth, ivec2 offset) {
+    float depthDistance = abs(sampleDepth - depth) / (SVGF_PHI_DEPTH * abs(dot(gradient, vec2(offset))) + SVGF_EPSILON);
+    return pow(max(dot(N, sampleN), 0.0), SVGF_PHI_NORMAL) * exp(-depthDistance);
+}
+
+// 八面体编码，把单位法线压进两个通道
+vec2 encodeNormal(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.xy;
+    if (n.z < 0.0) {
+        e = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return e;
+}
+
+vec3 decodeNormal(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+#endif
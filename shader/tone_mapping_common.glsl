@@ -0,0 +1,33 @@
+// tone_mapping_common.glsl
+// 自动曝光与色调映射三个 pass 共享的资源声明
+#ifndef TONE_MAPPING_COMMON_GLSL
+#define TONE_MAPPING_COMMON_GLSL
+
+#define HISTOGRAM_BIN_COUNT 256 // bin 0 收集接近全黑的像素，不参与平均
+
+layout(binding = 0) uniform sampler2D hdrColor; // 降噪输出，线性 HDR
+layout(std430, binding = 1) buffer LuminanceHistogram {
+    uint bins[HISTOGRAM_BIN_COUNT];
+};
+layout(std430, binding = 2) buffer ExposureData {
+    float averageLuminance; // 随时间适应后的场景平均亮度，0 表示还没有统计过
+    float exposure;         // 色调映射前乘到颜色上的系数
+};
+layout(binding = 3, rgba8) uniform writeonly image2D displayImage; // 已做 sRGB 编码的 8 位结果
+
+layout(push_constant) uniform ToneMappingParams {
+    float minLogLuminance;      // 直方图覆盖的 log2 亮度范围
+    float logLuminanceRange;
+    float adaptationRate;       // 本帧向目标亮度靠近的比例
+    float exposureCompensation; // EV
+    uint sampleCount;           // 参与统计的样本数 (降采样后)
+    int autoExposure;
+    float manualExposure;       // EV，关闭自动曝光时使用
+    int toneMapper;             // 0: Reinhard, 1: ACES
+};
+
+float luminance(vec3 c) {
+    return dot(c, vec3(0.2126, 0.7152, 0.0722));
+}
+
+#endif
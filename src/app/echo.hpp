@@ -12,10 +12,13 @@
 #include "path_tracing_resource_manager.hpp"
 #include "render_pipeline.hpp"
 #include "render_target.hpp"
+#include "restir_di_pass.hpp"
 #include "shadow_mapping.hpp"
 #include "svg_filter_pass.hpp"
 #include "swap_chain_manager.hpp"
+#include "temporal_upscale_pass.hpp"
 #include "texture_resource_manager.hpp"
+#include "tone_mapping_pass.hpp"
 #include "vertex_resource_manager.hpp"
 #include "vulkan_context.hpp"
 #include "vulkan_utils.hpp"
@@ -80,6 +83,11 @@ class ECHO
     GBufferResourceManager gbufferResourceManager;
     SVGFilterPass svgFilterPass;
     SVGFilterResourceManager svgFilterResourceManager;
+    ReSTIRDIPass restirDIPass;
+    TemporalUpscalePass temporalUpscalePass;
+    TemporalUpscaleResourceManager temporalUpscaleResourceManager;
+    ToneMappingPass toneMappingPass;
+    ToneMappingResourceManager toneMappingResourceManager;
 
     Camera camera;
     VkExtent2D contentSize;
@@ -105,11 +113,14 @@ class ECHO
 
         textureResourceManager.init(device, physicalDevice, graphicsQueue, commandManager);
         textureResourceManager.loadHDRTexture(TEXTURE_PATH);
+        textureResourceManager.initMaterialTextures(vertexResourceManager);
 
         pathTracingResourceManager.init(device, physicalDevice, graphicsQueue, swapChainManager, commandManager,
                                         vertexResourceManager);
-        pathTracingPipeline.init(device, physicalDevice, pathTracingResourceManager,
-                                 commandManager.allocateCommandBuffers(MAX_FRAMES_IN_FLIGHT));
+        pathTracingResourceManager.logStorageFootprint();
+        pathTracingPipeline.init(
+            device, physicalDevice, pathTracingResourceManager, textureResourceManager,
+            commandManager.allocateCommandBuffers(MAX_FRAMES_IN_FLIGHT * MAX_PATH_TRACING_SUBMITS));
 
         iblRenderer.init(device, graphicsQueue, commandManager, textureResourceManager);
 
@@ -120,6 +131,7 @@ class ECHO
         renderPipeline.init(device, physicalDevice, swapChainManager, vertexResourceManager, textureResourceManager,
                             commandManager.allocateCommandBuffers(MAX_FRAMES_IN_FLIGHT));
         imguiManager.init(windowManager.getWindow(), vulkanContext, swapChainManager, vertexResourceManager,
+                          pathTracingResourceManager, svgFilterResourceManager, toneMappingResourceManager,
                           commandManager);
         renderTarget.init(device, physicalDevice, swapChainManager, renderPipeline.getRenderPass(),
                           imguiManager.getRenderPass());
@@ -129,10 +141,24 @@ class ECHO
         gbufferPass.init(device, physicalDevice, swapChainManager, vertexResourceManager,
                          commandManager.allocateCommandBuffers(MAX_FRAMES_IN_FLIGHT));
         gbufferResourceManager.init(device, physicalDevice, gbufferPass.getGBufferRenderPass(), swapChainManager);
+        restirDIPass.init(device, physicalDevice, swapChainManager, gbufferResourceManager, pathTracingResourceManager,
+                          commandManager.allocateCommandBuffers(MAX_FRAMES_IN_FLIGHT));
+
+        temporalUpscaleResourceManager.setStoragePrecision(pathTracingResourceManager.getStoragePrecision());
+        temporalUpscaleResourceManager.init(device, physicalDevice, graphicsQueue, swapChainManager, commandManager);
+        temporalUpscalePass.init(device, physicalDevice, swapChainManager, gbufferResourceManager,
+                                 pathTracingResourceManager, temporalUpscaleResourceManager,
+                                 commandManager.allocateCommandBuffers(MAX_FRAMES_IN_FLIGHT));
 
+        svgFilterResourceManager.setStoragePrecision(pathTracingResourceManager.getStoragePrecision());
         svgFilterResourceManager.init(device, physicalDevice, graphicsQueue, swapChainManager, commandManager);
         svgFilterPass.init(device, physicalDevice, swapChainManager, gbufferResourceManager, pathTracingResourceManager,
-                           svgFilterResourceManager, commandManager.allocateCommandBuffers(MAX_FRAMES_IN_FLIGHT));
+                           temporalUpscaleResourceManager, svgFilterResourceManager,
+                           commandManager.allocateCommandBuffers(MAX_FRAMES_IN_FLIGHT));
+
+        toneMappingResourceManager.init(device, physicalDevice, graphicsQueue, swapChainManager, commandManager);
+        toneMappingPass.init(device, physicalDevice, swapChainManager, svgFilterResourceManager,
+                             toneMappingResourceManager, commandManager.allocateCommandBuffers(MAX_FRAMES_IN_FLIGHT));
         camera.init();
         createSyncObjects();
         contentSize = swapChainManager.getSwapChainExtent();
@@ -180,7 +206,12 @@ class ECHO
         gbufferPass.cleanup();
         gbufferResourceManager.cleanup();
         svgFilterPass.cleanup();
+        restirDIPass.cleanup();
+        temporalUpscalePass.cleanup();
+        temporalUpscaleResourceManager.cleanup();
         svgFilterResourceManager.cleanup();
+        toneMappingPass.cleanup();
+        toneMappingResourceManager.cleanup();
 
         imguiManager.cleanup();
         vulkanContext.cleanup();
@@ -226,7 +257,9 @@ class ECHO
             imguiManager.recreatWindow();
             pathTracingResourceManager.recreatePathTracingOutputImages(contentSize);
             gbufferResourceManager.recreateGBuffer(imguiManager.getContentExtent());
+            temporalUpscaleResourceManager.recreateUpscaledImages(imguiManager.getContentExtent());
             svgFilterResourceManager.recreateDenoisedOutputImages(imguiManager.getContentExtent());
+            toneMappingResourceManager.recreateDisplayImages(imguiManager.getContentExtent());
             return;
         }
         else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
@@ -238,57 +271,108 @@ class ECHO
         // renderTarget.getOffScreenSampler(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
         // imguiManager.addTexture(&renderTarget.getOffScreenImageView()[imageIndex],
         // renderTarget.getOffScreenSampler(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-        imguiManager.addTexture(&svgFilterResourceManager.getDenoisedOutputImageView()[imageIndex],
+        pathTracingResourceManager.collectPathStatistics(currentFrame); // 该帧的 fence 已经等待过
+        pathTracingResourceManager.updateSampleBudget(currentFrame,
+                                                      pathTracingPipeline.collectDispatchTime(currentFrame));
+
+        imguiManager.addTexture(&toneMappingResourceManager.getDisplayImageViews()[imageIndex],
                                 renderTarget.getOffScreenSampler(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
         contentSize = imguiManager.renderImGuiInterface();
+        if (pathTracingResourceManager.isRenderScaleOutdated())
+        {
+            // 渲染比例变化：按当前视口重新创建降分辨率的输出图像
+            pathTracingResourceManager.recreatePathTracingOutputImages(pathTracingResourceManager.getViewportExtent());
+        }
+        if (pathTracingResourceManager.isStoragePrecisionOutdated())
+        {
+            // 存储精度变化：路径追踪、上采样与降噪图像按新格式重新创建，各 pass 在回调中重新编译着色器
+            StoragePrecision precision = pathTracingResourceManager.getPathTracingSettings().storagePrecision;
+            temporalUpscaleResourceManager.setStoragePrecision(precision);
+            temporalUpscaleResourceManager.recreateUpscaledImages(temporalUpscaleResourceManager.getOutputExtent());
+            svgFilterResourceManager.setStoragePrecision(precision);
+            svgFilterResourceManager.recreateDenoisedOutputImages(svgFilterResourceManager.getOutputExtent());
+            pathTracingResourceManager.recreatePathTracingOutputImages(pathTracingResourceManager.getViewportExtent());
+            pathTracingResourceManager.logStorageFootprint();
+        }
+        if (pathTracingResourceManager.isPathSpaceCacheSizeOutdated())
+        {
+            pathTracingResourceManager.recreatePathSpaceCache(); // 缓存大小变化，重新创建哈希网格
+        }
 
         shadowMapping.updateShadowUniformBuffer(currentFrame); // update lightSpaceMatrix
+        textureResourceManager.updateMaterialTextureStreaming(currentFrame);
         vertexResourceManager.updateUniformBuffer(currentFrame, contentSize, camera);
         pathTracingResourceManager.updateCameraDataBuffer(currentFrame, contentSize, camera);
+        pathTracingResourceManager.updateTileQueue(currentFrame);
 
         vkResetFences(device, 1, &inFlightFences[currentFrame]);
 
         vkResetCommandBuffer(renderPipeline.getCommandBuffer(currentFrame), /*VkCommandBufferResetFlagBits*/ 0);
         vkResetCommandBuffer(shadowMapping.getCommandBuffer(currentFrame), /*VkCommandBufferResetFlagBits*/ 0);
         vkResetCommandBuffer(imguiManager.getCommandBuffer(currentFrame), /*VkCommandBufferResetFlagBits*/ 0);
-        vkResetCommandBuffer(pathTracingPipeline.getCommandBuffer(currentFrame), /*VkCommandBufferResetFlagBits*/ 0);
+        pathTracingPipeline.resetCommandBuffers(currentFrame);
 
         auto shadowcommandBuffer = shadowMapping.recordShadowCommandBuffer(currentFrame);
         auto commandBuffer = renderPipeline.recordCommandBuffer(
             currentFrame, renderTarget.getOffScreenFramebuffers()[imageIndex], renderTarget.getOffScreenExtent());
-        auto pathTracingCommandBuffer = pathTracingPipeline.recordCommandBuffer(currentFrame, imageIndex);
-        auto gbufferCommandBuffer = gbufferPass.recordCommandBuffer(
-            currentFrame, gbufferResourceManager.getFramebuffer(imageIndex), gbufferResourceManager.getOutputExtent());
-        auto svgFilterCommandBuffer = svgFilterPass.recordCommandBuffer(currentFrame, imageIndex);
-
-        VkCommandBuffer imguiCommandBuffer =
-            imguiManager.recordCommandbuffer(currentFrame, renderTarget.getFramebuffers()[imageIndex]);
-
-        // std::array<VkCommandBuffer, 4> commandBuffers = { pathTracingCommandBuffer, gbufferCommandBuffer,
-        // svgFilterCommandBuffer, imguiCommandBuffer };
-        std::array<VkCommandBuffer, 6> commandBuffers = {shadowcommandBuffer,    pathTracingCommandBuffer,
-                                                         commandBuffer,          gbufferCommandBuffer,
-                                                         svgFilterCommandBuffer, imguiCommandBuffer};
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        // ReSTIR DI 依赖本帧的 G-buffer，路径追踪依赖 ReSTIR DI 的蓄水池，上采样之后再降噪
+        // 已收敛时跳过整条路径追踪链，ImGui 继续显示缓存的降噪结果
+        // 路径追踪的每个命令缓冲结束一次提交，提交之间 GPU 可以切换到其他工作；
+        // 第一次提交等待交换链图像，最后一次 signal 呈现信号量与 fence，fence 同时覆盖之前按顺序提交的命令
+        bool converged = pathTracingResourceManager.isConverged();
+        std::vector<std::vector<VkCommandBuffer>> submitBatches = {{shadowcommandBuffer}};
+        if (!converged)
+        {
+            VkFramebuffer gbufferFramebuffer = gbufferResourceManager.getFramebuffer(imageIndex);
+            VkExtent2D gbufferExtent = gbufferResourceManager.getOutputExtent();
+            submitBatches.back().push_back(
+                gbufferPass.recordCommandBuffer(currentFrame, gbufferFramebuffer, gbufferExtent));
+            submitBatches.back().push_back(restirDIPass.recordCommandBuffer(currentFrame, imageIndex));
+            for (VkCommandBuffer pathTracingCommandBuffer :
+                 pathTracingPipeline.recordCommandBuffers(currentFrame, imageIndex))
+            {
+                submitBatches.back().push_back(pathTracingCommandBuffer);
+                submitBatches.emplace_back();
+            }
+            submitBatches.back().push_back(temporalUpscalePass.recordCommandBuffer(currentFrame, imageIndex));
+        }
+        std::vector<VkCommandBuffer>& commandBuffers = submitBatches.back();
+        commandBuffers.push_back(commandBuffer);
+        if (!converged)
+        {
+            commandBuffers.push_back(svgFilterPass.recordCommandBuffer(currentFrame, imageIndex));
+        }
+        // 收敛后也要色调映射，曝光仍会向缓存结果的亮度适应
+        commandBuffers.push_back(toneMappingPass.recordCommandBuffer(currentFrame, imageIndex));
+        commandBuffers.push_back(
+            imguiManager.recordCommandbuffer(currentFrame, renderTarget.getFramebuffers()[imageIndex]));
 
         VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
         VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-        submitInfo.waitSemaphoreCount = 1;
-        submitInfo.pWaitSemaphores = waitSemaphores;
-        submitInfo.pWaitDstStageMask = waitStages;
+        VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
+        for (size_t i = 0; i < submitBatches.size(); ++i)
+        {
+            bool lastBatch = i + 1 == submitBatches.size();
 
-        submitInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
-        submitInfo.pCommandBuffers = commandBuffers.data();
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-        VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = signalSemaphores;
+            submitInfo.waitSemaphoreCount = i == 0 ? 1 : 0;
+            submitInfo.pWaitSemaphores = waitSemaphores;
+            submitInfo.pWaitDstStageMask = waitStages;
 
-        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS)
-        {
-            throw std::runtime_error("failed to submit draw command buffer!");
+            submitInfo.commandBufferCount = static_cast<uint32_t>(submitBatches[i].size());
+            submitInfo.pCommandBuffers = submitBatches[i].data();
+
+            submitInfo.signalSemaphoreCount = lastBatch ? 1 : 0;
+            submitInfo.pSignalSemaphores = signalSemaphores;
+
+            VkFence fence = lastBatch ? inFlightFences[currentFrame] : VK_NULL_HANDLE;
+            if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, fence) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to submit draw command buffer!");
+            }
         }
 
         VkPresentInfoKHR presentInfo{};
@@ -313,7 +397,9 @@ class ECHO
             imguiManager.recreatWindow();
             pathTracingResourceManager.recreatePathTracingOutputImages(contentSize);
             gbufferResourceManager.recreateGBuffer(contentSize);
+            temporalUpscaleResourceManager.recreateUpscaledImages(contentSize);
             svgFilterResourceManager.recreateDenoisedOutputImages(contentSize);
+            toneMappingResourceManager.recreateDisplayImages(contentSize);
         }
         if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || windowManager.isFramebufferResized())
         {
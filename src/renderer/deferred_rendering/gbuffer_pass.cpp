@@ -101,11 +101,12 @@ VkCommandBuffer GBufferPass::recordCommandBuffer(uint32_t frameIndex, VkFramebuf
     renderPassInfo.renderArea.extent = imageExtent;
 
     // 清除值（颜色和深度）
-    std::vector<VkClearValue> clearValues(4);
+    std::vector<VkClearValue> clearValues(5);
     clearValues[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}}; // 清除颜色附件
     clearValues[1].color = {{0.0f, 0.0f, 0.0f, 1.0f}}; // 清除法线附件
     clearValues[2].color = {{0.0f, 0.0f, 0.0f, 1.0f}}; // 清除位置附件
-    clearValues[3].depthStencil = {1.0f, 0};           // 清除深度附件
+    clearValues[3].color = {{0.0f, 0.0f, 0.0f, 0.0f}}; // 清除运动向量附件 (背景没有运动)
+    clearValues[4].depthStencil = {1.0f, 0};           // 清除深度附件
 
     renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
     renderPassInfo.pClearValues = clearValues.data();
@@ -192,6 +193,17 @@ void GBufferPass::createRenderPass()
     positionAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     positionAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
+    // 定义运动向量附件
+    VkAttachmentDescription motionVectorAttachment = {};
+    motionVectorAttachment.format = VK_FORMAT_R16G16_SFLOAT; // 屏幕空间 uv 差
+    motionVectorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    motionVectorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    motionVectorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    motionVectorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    motionVectorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    motionVectorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    motionVectorAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
     // 定义深度附件
     VkAttachmentDescription depthAttachment = {};
     depthAttachment.format = VK_FORMAT_D32_SFLOAT; // 深度格式
@@ -216,15 +228,20 @@ void GBufferPass::createRenderPass()
     positionAttachmentRef.attachment = 2; // 第三个附件
     positionAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+    VkAttachmentReference motionVectorAttachmentRef = {};
+    motionVectorAttachmentRef.attachment = 3; // 第四个附件
+    motionVectorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
     VkAttachmentReference depthAttachmentRef = {};
-    depthAttachmentRef.attachment = 3; // 第四个附件
+    depthAttachmentRef.attachment = 4; // 第五个附件
     depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
     // 定义子通道
     VkSubpassDescription subpass = {};
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 3; // 三个颜色附件
-    VkAttachmentReference colorAttachments[] = {colorAttachmentRef, normalAttachmentRef, positionAttachmentRef};
+    subpass.colorAttachmentCount = 4; // 四个颜色附件
+    VkAttachmentReference colorAttachments[] = {colorAttachmentRef, normalAttachmentRef, positionAttachmentRef,
+                                                motionVectorAttachmentRef};
     subpass.pColorAttachments = colorAttachments;
     subpass.pDepthStencilAttachment = &depthAttachmentRef;
 
@@ -240,8 +257,8 @@ void GBufferPass::createRenderPass()
     dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
     // 定义 Render Pass 信息
-    std::array<VkAttachmentDescription, 4> attachments = {colorAttachment, normalAttachment, positionAttachment,
-                                                          depthAttachment};
+    std::array<VkAttachmentDescription, 5> attachments = {colorAttachment, normalAttachment, positionAttachment,
+                                                          motionVectorAttachment, depthAttachment};
     VkRenderPassCreateInfo renderPassInfo = {};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
@@ -385,7 +402,7 @@ void GBufferPass::createPipeline()
     depthStencil.stencilTestEnable = VK_FALSE;
 
     // 颜色混合
-    std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments(3);
+    std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments(4);
     for (auto& attachment : colorBlendAttachments)
     {
         attachment.colorWriteMask =
@@ -18,6 +18,8 @@ void GBufferResourceManager::init(VkDevice device, VkPhysicalDevice physicalDevi
                      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
     createAttachment(positionAttachments, VK_FORMAT_R16G16B16A16_SFLOAT,
                      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+    createAttachment(motionVectorAttachments, VK_FORMAT_R16G16_SFLOAT,
+                     VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
     createAttachment(depthAttachments, VK_FORMAT_D32_SFLOAT,
                      VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
                      VK_IMAGE_ASPECT_DEPTH_BIT);
@@ -45,6 +47,7 @@ void GBufferResourceManager::cleanup()
         destroyAttachment(positionAttachments[index]);
         destroyAttachment(colorAttachments[index]);
         destroyAttachment(normalAttachments[index]);
+        destroyAttachment(motionVectorAttachments[index]);
         destroyAttachment(depthAttachments[index]);
     }
 }
@@ -65,6 +68,8 @@ void GBufferResourceManager::recreateGBuffer(VkExtent2D imageExtent)
                      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
     createAttachment(positionAttachments, VK_FORMAT_R16G16B16A16_SFLOAT,
                      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+    createAttachment(motionVectorAttachments, VK_FORMAT_R16G16_SFLOAT,
+                     VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
     createAttachment(depthAttachments, VK_FORMAT_D32_SFLOAT,
                      VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
                      VK_IMAGE_ASPECT_DEPTH_BIT);
@@ -98,8 +103,10 @@ void GBufferResourceManager::createFramebuffer(VkRenderPass renderPass)
     framebuffers.resize(imageCount);
     for (uint32_t i = 0; i < imageCount; ++i)
     {
+        // 顺序与 GBufferPass::createRenderPass 中的附件描述一致
         std::vector<VkImageView> attachments = {colorAttachments[i].view, normalAttachments[i].view,
-                                                positionAttachments[i].view, depthAttachments[i].view};
+                                                positionAttachments[i].view, motionVectorAttachments[i].view,
+                                                depthAttachments[i].view};
 
         VkFramebufferCreateInfo framebufferInfo = {};
         framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
@@ -51,6 +51,10 @@ class GBufferResourceManager
     {
         return positionAttachments[index];
     }
+    const GBufferAttachment& getMotionVectorAttachment(uint32_t index) const
+    {
+        return motionVectorAttachments[index];
+    }
 
     VkFramebuffer getFramebuffer(uint32_t index) const
     {
@@ -71,10 +75,11 @@ class GBufferResourceManager
     VkExtent2D outPutExtent;
     uint32_t imageCount;
 
-    std::vector<GBufferAttachment> positionAttachments; // 世界空间位置
-    std::vector<GBufferAttachment> colorAttachments;    // 漫反射颜色
-    std::vector<GBufferAttachment> normalAttachments;   // 法线
-    std::vector<GBufferAttachment> depthAttachments;    // 深度
+    std::vector<GBufferAttachment> positionAttachments;     // 世界空间位置
+    std::vector<GBufferAttachment> colorAttachments;        // 漫反射颜色
+    std::vector<GBufferAttachment> normalAttachments;       // 法线
+    std::vector<GBufferAttachment> motionVectorAttachments; // 屏幕空间运动向量 (本帧 uv - 上一帧 uv)
+    std::vector<GBufferAttachment> depthAttachments;        // 深度
 
     std::vector<VkFramebuffer> framebuffers;
 
@@ -168,7 +168,7 @@ void RenderPipeline::createDescriptorSetLayout()
     VkDescriptorSetLayoutBinding materialBinding{};
     materialBinding.binding = 2;
     materialBinding.descriptorCount = 1;
-    materialBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    materialBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
     materialBinding.pImmutableSamplers = nullptr;
     materialBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
@@ -200,9 +200,24 @@ void RenderPipeline::createDescriptorSetLayout()
     brdfLUBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
     brdfLUBinding.pImmutableSamplers = nullptr;
 
-    std::array<VkDescriptorSetLayoutBinding, 7> bindings = {
+    VkDescriptorSetLayoutBinding materialTexturesBinding{};
+    materialTexturesBinding.binding = 7;
+    materialTexturesBinding.descriptorCount = MAX_MATERIAL_TEXTURES; // 空位绑定默认贴图
+    materialTexturesBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    materialTexturesBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    materialTexturesBinding.pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutBinding materialTextureStreamingBinding{};
+    materialTextureStreamingBinding.binding = 8;
+    materialTextureStreamingBinding.descriptorCount = 1;
+    materialTextureStreamingBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER; // mip 需求与驻留信息
+    materialTextureStreamingBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    materialTextureStreamingBinding.pImmutableSamplers = nullptr;
+
+    std::array<VkDescriptorSetLayoutBinding, 9> bindings = {
         uboLayoutBinding,     shadowMapBinding,      materialBinding, skyBoxBinding,
-        irradianceMapBinding, prefilteredMapBinding, brdfLUBinding};
+        irradianceMapBinding, prefilteredMapBinding, brdfLUBinding,   materialTexturesBinding,
+        materialTextureStreamingBinding};
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
@@ -464,11 +479,14 @@ VkCommandBuffer RenderPipeline::recordCommandBuffer(uint32_t imageIndex, VkFrame
 
 void RenderPipeline::createDescriptorPool(size_t MAX_FRAMES_IN_FLIGHT)
 {
-    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    std::array<VkDescriptorPoolSize, 3> poolSizes{};
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * 2 + 3 * 2;
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * 2 + 3 * 2;
+    poolSizes[1].descriptorCount =
+        static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * (2 + MAX_MATERIAL_TEXTURES) + 3 * 2; // 含材质贴图数组
+    poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER; // 材质与 mip 驻留信息
+    poolSizes[2].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * 2;
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -505,9 +523,9 @@ void RenderPipeline::createDescriptorSets(size_t MAX_FRAMES_IN_FLIGHT, ShadowMap
         bufferInfo.range = sizeof(UniformBufferObject);
 
         VkDescriptorBufferInfo materialBufferInfo{};
-        materialBufferInfo.buffer = vertexResourceManager->getMaterialUniformBuffers()[i];
+        materialBufferInfo.buffer = vertexResourceManager->getMaterialBuffers()[i];
         materialBufferInfo.offset = 0;
-        materialBufferInfo.range = sizeof(MaterialUniformBufferObject) * vertexResourceManager->getShapeNames().size();
+        materialBufferInfo.range = VK_WHOLE_SIZE; // 材质数量不定
         // VkDescriptorImageInfo imageInfo{};
         // imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         // imageInfo.imageView = textureImageView;
@@ -560,7 +578,7 @@ void RenderPipeline::createDescriptorSets(size_t MAX_FRAMES_IN_FLIGHT, ShadowMap
         descriptorWrites[2].dstSet = descriptorSets[i];
         descriptorWrites[2].dstBinding = 2;
         descriptorWrites[2].dstArrayElement = 0;
-        descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         descriptorWrites[2].descriptorCount = 1;
         descriptorWrites[2].pBufferInfo = &materialBufferInfo;
 
@@ -599,6 +617,7 @@ void RenderPipeline::createDescriptorSets(size_t MAX_FRAMES_IN_FLIGHT, ShadowMap
         vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
                                nullptr);
     }
+    updateMaterialDescriptorSets();
 }
 
 void RenderPipeline::updateMaterialDescriptorSets()
@@ -611,11 +630,19 @@ void RenderPipeline::updateMaterialDescriptorSets()
         bufferInfo.range = sizeof(UniformBufferObject);
 
         VkDescriptorBufferInfo materialBufferInfo{};
-        materialBufferInfo.buffer = vertexResourceManager->getMaterialUniformBuffers()[i];
+        materialBufferInfo.buffer = vertexResourceManager->getMaterialBuffers()[i];
         materialBufferInfo.offset = 0;
-        materialBufferInfo.range = sizeof(MaterialUniformBufferObject) * vertexResourceManager->getShapeNames().size();
+        materialBufferInfo.range = VK_WHOLE_SIZE; // 材质数量不定
 
-        std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+        // 材质贴图随模型重新加载重建
+        std::vector<VkDescriptorImageInfo> materialTextureInfos = textureResourceManager->getMaterialTextureImageInfos();
+
+        VkDescriptorBufferInfo streamingBufferInfo{};
+        streamingBufferInfo.buffer = textureResourceManager->getMaterialTextureStreamingBuffers()[i];
+        streamingBufferInfo.offset = 0;
+        streamingBufferInfo.range = sizeof(MaterialTextureStreaming);
+
+        std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
 
         descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         descriptorWrites[0].dstSet = descriptorSets[i];
@@ -629,10 +656,26 @@ void RenderPipeline::updateMaterialDescriptorSets()
         descriptorWrites[1].dstSet = descriptorSets[i];
         descriptorWrites[1].dstBinding = 2;
         descriptorWrites[1].dstArrayElement = 0;
-        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         descriptorWrites[1].descriptorCount = 1;
         descriptorWrites[1].pBufferInfo = &materialBufferInfo;
 
+        descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[2].dstSet = descriptorSets[i];
+        descriptorWrites[2].dstBinding = 7;
+        descriptorWrites[2].dstArrayElement = 0;
+        descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[2].descriptorCount = static_cast<uint32_t>(materialTextureInfos.size());
+        descriptorWrites[2].pImageInfo = materialTextureInfos.data();
+
+        descriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[3].dstSet = descriptorSets[i];
+        descriptorWrites[3].dstBinding = 8;
+        descriptorWrites[3].dstArrayElement = 0;
+        descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[3].descriptorCount = 1;
+        descriptorWrites[3].pBufferInfo = &streamingBufferInfo;
+
         vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
                                nullptr);
     }
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 降噪链中可用的 stage，数值即 getDenoiserStageInfo 的下标
+enum class DenoiserStageType
+{
+    SVGF = 0,           // 时域累积 + 方差估计 + à-trous
+    SigmaClip = 1,      // 3x3 邻域均值 ± 标准差截断离群点
+    JointBilateral = 2, // 离群点截断后的 3x3 联合双边
+    Bilateral = 3,      // 5x5 颜色 / 法线 / 深度双边
+};
+
+// stage 读写的资源，在描述符集中的绑定点固定 (见 shader/svgf_common.glsl)
+enum DenoiserResource : uint32_t
+{
+    DENOISER_RESOURCE_COLOR = 1 << 0,    // 上一个 stage 的输出，首个 stage 为上采样后的路径追踪结果
+    DENOISER_RESOURCE_NORMAL = 1 << 1,   // G-buffer 法线
+    DENOISER_RESOURCE_DEPTH = 1 << 2,    // G-buffer 深度
+    DENOISER_RESOURCE_POSITION = 1 << 3, // G-buffer 世界空间位置
+    DENOISER_RESOURCE_MOTION = 1 << 4,   // G-buffer 运动向量
+    DENOISER_RESOURCE_ALBEDO = 1 << 5,   // 路径追踪的首次命中反照率，用于链前后的解调
+    DENOISER_RESOURCE_HISTORY = 1 << 6,  // 跨帧保留的历史，stage 顺序变化后需要清空
+};
+
+struct DenoiserStageInfo
+{
+    const char* name;
+    const char* shaderPath; // 单 dispatch 的 stage 使用；SVGF 由 SVGFilterPass 展开为三类 pass
+    uint32_t inputs;
+    uint32_t outputs;
+    uint32_t dispatchCount;
+};
+
+inline constexpr std::array<DenoiserStageInfo, 4> DENOISER_STAGE_INFOS = {{
+    {"SVGF", nullptr,
+     DENOISER_RESOURCE_COLOR | DENOISER_RESOURCE_NORMAL | DENOISER_RESOURCE_DEPTH | DENOISER_RESOURCE_POSITION |
+         DENOISER_RESOURCE_MOTION | DENOISER_RESOURCE_HISTORY,
+     DENOISER_RESOURCE_COLOR | DENOISER_RESOURCE_HISTORY, 7},
+    {"Sigma Clip", "../shader/sigma_clip_denoise.comp", DENOISER_RESOURCE_COLOR, DENOISER_RESOURCE_COLOR, 1},
+    {"Joint Bilateral", "../shader/joint_bilateral_denoise.comp",
+     DENOISER_RESOURCE_COLOR | DENOISER_RESOURCE_NORMAL | DENOISER_RESOURCE_DEPTH, DENOISER_RESOURCE_COLOR, 1},
+    {"Bilateral", "../shader/svg_filter.comp",
+     DENOISER_RESOURCE_COLOR | DENOISER_RESOURCE_NORMAL | DENOISER_RESOURCE_DEPTH, DENOISER_RESOURCE_COLOR, 1},
+}};
+
+// 共享内存版本 à-trous 支持的最大步长：(16 + 8)^2 的分块约 13.5 KB，低于 Vulkan 保证的 16 KB；
+// 更大的步长必须使用不带 SHARED_MEMORY_TILE 的管线，分块之外的邻居不在共享内存中
+inline constexpr uint32_t SVGF_SHARED_TILE_MAX_STEP = 2;
+
+inline const DenoiserStageInfo& getDenoiserStageInfo(DenoiserStageType type)
+{
+    return DENOISER_STAGE_INFOS[static_cast<size_t>(type)];
+}
+
+// 所有 stage 都启用时的 dispatch 总数，决定每帧需要的描述符集数量
+inline constexpr uint32_t getMaxDenoiserDispatchCount()
+{
+    uint32_t count = 0;
+    for (const DenoiserStageInfo& info : DENOISER_STAGE_INFOS)
+    {
+        count += info.dispatchCount;
+    }
+    return count;
+}
+
+// 资源名称，供 UI 列出每个 stage 的输入
+inline const char* getDenoiserResourceName(DenoiserResource resource)
+{
+    switch (resource)
+    {
+    case DENOISER_RESOURCE_COLOR:
+        return "Color";
+    case DENOISER_RESOURCE_NORMAL:
+        return "Normal";
+    case DENOISER_RESOURCE_DEPTH:
+        return "Depth";
+    case DENOISER_RESOURCE_POSITION:
+        return "Position";
+    case DENOISER_RESOURCE_MOTION:
+        return "Motion";
+    case DENOISER_RESOURCE_ALBEDO:
+        return "Albedo";
+    case DENOISER_RESOURCE_HISTORY:
+        return "History";
+    default:
+        return "";
+    }
+}
+
+struct DenoiserStageSettings
+{
+    DenoiserStageType type;
+    bool enabled;
+
+    bool operator==(const DenoiserStageSettings&) const = default;
+};
+
+// 降噪链的顺序与开关，由 ImGui 修改；变化后 SVGFilterPass 在下一次录制前重建 dispatch 序列
+// 全部禁用时直接把上采样结果复制到降噪输出
+struct DenoiserChainSettings
+{
+    std::vector<DenoiserStageSettings> stages = {
+        {DenoiserStageType::SVGF, true},
+        {DenoiserStageType::SigmaClip, false},
+        {DenoiserStageType::JointBilateral, false},
+        {DenoiserStageType::Bilateral, false},
+    };
+    bool albedoDemodulation = true; // 链前除以反照率，链后乘回
+
+    bool operator==(const DenoiserChainSettings&) const = default;
+};
@@ -1,28 +1,46 @@
 // path_tracing_pipeline.cpp
 #include "path_tracing_pipeline.hpp"
+#include "shader_includer.hpp"
 #include "vulkan_utils.hpp"
+#include <algorithm>
+#include <array>
 #include <fstream>
 #include <shaderc/shaderc.hpp>
 #include <span>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 void PathTracingPipeline::init(VkDevice device, VkPhysicalDevice physicalDevice,
                                PathTracingResourceManager& pathTracingResourceManager,
+                               TextureResourceManager& textureResourceManager,
                                std::vector<VkCommandBuffer>&& commandBuffers)
 {
     this->device = device;
     this->physicalDevice = physicalDevice;
     this->pathTracingResourceManager = &pathTracingResourceManager;
+    this->textureResourceManager = &textureResourceManager;
     this->pathTracingCommandBuffers = std::move(commandBuffers);
+    // 每个 in-flight 帧占 MAX_PATH_TRACING_SUBMITS 个连续的命令缓冲
+    timestampsWritten.assign(pathTracingCommandBuffers.size() / MAX_PATH_TRACING_SUBMITS, false);
 
     createDescriptorSetLayout();
     createPathTracingPipeline();
     createDescriptorPool();
     createDescriptorSets();
+    createTimestampQueryPool();
+
+    // 常驻工作组数默认取设备能同时驻留的数量：更少会让部分计算单元空闲，更多的工作组只是排队等待
+    uint32_t residentWorkgroups = queryResidentWorkgroupCount();
+    if (persistentThreadsPipeline != VK_NULL_HANDLE && residentWorkgroups > 0)
+    {
+        pathTracingResourceManager.getTileDispatchSettings().persistentWorkgroups =
+            static_cast<int>(std::min(residentWorkgroups, 1024u));
+    }
 
     pathTracingPipelineObserver = std::make_unique<PathTracingPipelineObserver>(this);
     pathTracingResourceManager.addPathTracingResourceReloadObserver(pathTracingPipelineObserver.get());
+    pathTracingResourceManager.addPathSpaceCacheRecreateObserver(pathTracingPipelineObserver.get());
 }
 
 void PathTracingPipeline::cleanup()
@@ -31,6 +49,16 @@ void PathTracingPipeline::cleanup()
     {
         vkDestroyPipeline(device, pathTracingPipeline, nullptr);
     }
+    if (persistentThreadsPipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(device, persistentThreadsPipeline, nullptr);
+        persistentThreadsPipeline = VK_NULL_HANDLE;
+    }
+    if (pathSpaceResolvePipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(device, pathSpaceResolvePipeline, nullptr);
+        pathSpaceResolvePipeline = VK_NULL_HANDLE;
+    }
     if (pathTracingPipelineLayout != VK_NULL_HANDLE)
     {
         vkDestroyPipelineLayout(device, pathTracingPipelineLayout, nullptr);
@@ -47,6 +75,50 @@ void PathTracingPipeline::cleanup()
     {
         vkDestroyDescriptorPool(device, descriptorPool, nullptr);
     }
+    if (timestampQueryPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(device, timestampQueryPool, nullptr);
+        timestampQueryPool = VK_NULL_HANDLE;
+    }
+}
+
+void PathTracingPipeline::createTimestampQueryPool()
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    if (!properties.limits.timestampComputeAndGraphics)
+    {
+        return; // 不支持时帧时间预算退化为固定 SPP
+    }
+    timestampPeriod = properties.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = static_cast<uint32_t>(timestampsWritten.size()) * 2;
+
+    if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &timestampQueryPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create path tracing timestamp query pool!");
+    }
+}
+
+float PathTracingPipeline::collectDispatchTime(uint32_t frameIndex)
+{
+    if (timestampQueryPool == VK_NULL_HANDLE || !timestampsWritten[frameIndex])
+    {
+        return -1.0f;
+    }
+    timestampsWritten[frameIndex] = false;
+
+    std::array<uint64_t, 2> timestamps{};
+    if (vkGetQueryPoolResults(device, timestampQueryPool, frameIndex * 2, 2, sizeof(timestamps), timestamps.data(),
+                              sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS ||
+        timestamps[1] < timestamps[0])
+    {
+        return -1.0f;
+    }
+    return static_cast<float>(timestamps[1] - timestamps[0]) * timestampPeriod * 1e-6f;
 }
 
 void PathTracingPipeline::updateOutputImageDescriptorSet()
@@ -81,7 +153,80 @@ void PathTracingPipeline::updateOutputImageDescriptorSet()
         accumulationImageWrite.descriptorCount = 1;
         accumulationImageWrite.pImageInfo = &accumulationImageInfo;
 
-        std::vector<VkWriteDescriptorSet> descriptorWrites = {outputimageWrite, accumulationImageWrite};
+        VkDescriptorBufferInfo reservoirBufferInfo{};
+        reservoirBufferInfo.buffer = pathTracingResourceManager->getReservoirBuffer();
+        reservoirBufferInfo.offset = 0;
+        reservoirBufferInfo.range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet reservoirWrite{};
+        reservoirWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        reservoirWrite.dstSet = imageDescriptorSets[i];
+        reservoirWrite.dstBinding = 2; // ReSTIR 蓄水池绑定点
+        reservoirWrite.dstArrayElement = 0;
+        reservoirWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        reservoirWrite.descriptorCount = 1;
+        reservoirWrite.pBufferInfo = &reservoirBufferInfo;
+
+        // Kahan 累积的总和与补偿图像，所有交换链图像共用一份
+        VkDescriptorImageInfo accumulationSumInfo{};
+        accumulationSumInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        accumulationSumInfo.imageView = pathTracingResourceManager->getAccumulationSumImageView();
+        accumulationSumInfo.sampler = VK_NULL_HANDLE;
+
+        VkDescriptorImageInfo accumulationCompensationInfo{};
+        accumulationCompensationInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        accumulationCompensationInfo.imageView = pathTracingResourceManager->getAccumulationCompensationImageView();
+        accumulationCompensationInfo.sampler = VK_NULL_HANDLE;
+
+        VkWriteDescriptorSet accumulationSumWrite{};
+        accumulationSumWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        accumulationSumWrite.dstSet = imageDescriptorSets[i];
+        accumulationSumWrite.dstBinding = 3;
+        accumulationSumWrite.dstArrayElement = 0;
+        accumulationSumWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        accumulationSumWrite.descriptorCount = 1;
+        accumulationSumWrite.pImageInfo = &accumulationSumInfo;
+
+        VkWriteDescriptorSet accumulationCompensationWrite{};
+        accumulationCompensationWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        accumulationCompensationWrite.dstSet = imageDescriptorSets[i];
+        accumulationCompensationWrite.dstBinding = 4;
+        accumulationCompensationWrite.dstArrayElement = 0;
+        accumulationCompensationWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        accumulationCompensationWrite.descriptorCount = 1;
+        accumulationCompensationWrite.pImageInfo = &accumulationCompensationInfo;
+
+        VkDescriptorImageInfo albedoImageInfo{};
+        albedoImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        albedoImageInfo.imageView = pathTracingResourceManager->getAlbedoImageViews()[i];
+        albedoImageInfo.sampler = VK_NULL_HANDLE;
+
+        VkWriteDescriptorSet albedoImageWrite{};
+        albedoImageWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        albedoImageWrite.dstSet = imageDescriptorSets[i];
+        albedoImageWrite.dstBinding = 5;
+        albedoImageWrite.dstArrayElement = 0;
+        albedoImageWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        albedoImageWrite.descriptorCount = 1;
+        albedoImageWrite.pImageInfo = &albedoImageInfo;
+
+        VkDescriptorImageInfo albedoSumInfo{};
+        albedoSumInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        albedoSumInfo.imageView = pathTracingResourceManager->getAccumulationAlbedoSumImageView();
+        albedoSumInfo.sampler = VK_NULL_HANDLE;
+
+        VkWriteDescriptorSet albedoSumWrite{};
+        albedoSumWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        albedoSumWrite.dstSet = imageDescriptorSets[i];
+        albedoSumWrite.dstBinding = 6;
+        albedoSumWrite.dstArrayElement = 0;
+        albedoSumWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        albedoSumWrite.descriptorCount = 1;
+        albedoSumWrite.pImageInfo = &albedoSumInfo;
+
+        std::vector<VkWriteDescriptorSet> descriptorWrites = {outputimageWrite, accumulationImageWrite, reservoirWrite,
+                                                              accumulationSumWrite, accumulationCompensationWrite,
+                                                              albedoImageWrite, albedoSumWrite};
         vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
                                nullptr);
     }
@@ -102,10 +247,9 @@ void PathTracingPipeline::updateStorageBufferDescriptorSet()
         bvhBufferInfo.range = VK_WHOLE_SIZE;
 
         VkDescriptorBufferInfo materialBufferInfo{};
-        materialBufferInfo.buffer = pathTracingResourceManager->getMaterialUniformBuffers()[i];
+        materialBufferInfo.buffer = pathTracingResourceManager->getMaterialBuffers()[i];
         materialBufferInfo.offset = 0;
-        materialBufferInfo.range =
-            sizeof(MaterialUniformBufferObject) * pathTracingResourceManager->getShapeNames().size();
+        materialBufferInfo.range = VK_WHOLE_SIZE; // 材质数量不定
 
         VkDescriptorBufferInfo emissiveTrianglesBufferInfo{};
         emissiveTrianglesBufferInfo.buffer = pathTracingResourceManager->getEmissiveTrianglesBuffer();
@@ -135,7 +279,7 @@ void PathTracingPipeline::updateStorageBufferDescriptorSet()
         materialsWrite.dstSet = frameDescriptorSets[i];
         materialsWrite.dstBinding = 2; // Materials 绑定点
         materialsWrite.dstArrayElement = 0;
-        materialsWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        materialsWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         materialsWrite.descriptorCount = 1;
         materialsWrite.pBufferInfo = &materialBufferInfo;
 
@@ -152,20 +296,166 @@ void PathTracingPipeline::updateStorageBufferDescriptorSet()
                                                               emissiveTrianglesWrite};
         vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
                                nullptr);
+    }    updateMaterialTextureDescriptorSet();
+}
+
+void PathTracingPipeline::updateTileBufferDescriptorSet()
+{
+    // tile 缓冲区随输出尺寸重建，需要重新绑定
+    for (size_t i = 0; i < frameDescriptorSets.size(); i++)
+    {
+        VkDescriptorBufferInfo tileQueueBufferInfo{};
+        tileQueueBufferInfo.buffer = pathTracingResourceManager->getTileQueueBuffers()[i];
+        tileQueueBufferInfo.offset = 0;
+        tileQueueBufferInfo.range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet tileQueueWrite{};
+        tileQueueWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        tileQueueWrite.dstSet = frameDescriptorSets[i];
+        tileQueueWrite.dstBinding = 8; // tile 队列绑定点
+        tileQueueWrite.dstArrayElement = 0;
+        tileQueueWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        tileQueueWrite.descriptorCount = 1;
+        tileQueueWrite.pBufferInfo = &tileQueueBufferInfo;
+
+        vkUpdateDescriptorSets(device, 1, &tileQueueWrite, 0, nullptr);
     }
 }
 
-VkCommandBuffer PathTracingPipeline::recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex)
+void PathTracingPipeline::updateMaterialTextureDescriptorSet()
 {
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    // 贴图数组随模型重新加载重建
+    std::vector<VkDescriptorImageInfo> materialTextureInfos = textureResourceManager->getMaterialTextureImageInfos();
+    for (size_t i = 0; i < frameDescriptorSets.size(); i++)
+    {
+        VkWriteDescriptorSet materialTexturesWrite{};
+        materialTexturesWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        materialTexturesWrite.dstSet = frameDescriptorSets[i];
+        materialTexturesWrite.dstBinding = 10; // 材质贴图数组绑定点
+        materialTexturesWrite.dstArrayElement = 0;
+        materialTexturesWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        materialTexturesWrite.descriptorCount = static_cast<uint32_t>(materialTextureInfos.size());
+        materialTexturesWrite.pImageInfo = materialTextureInfos.data();
+
+        VkDescriptorBufferInfo streamingBufferInfo{};
+        streamingBufferInfo.buffer = textureResourceManager->getMaterialTextureStreamingBuffers()[i];
+        streamingBufferInfo.offset = 0;
+        streamingBufferInfo.range = sizeof(MaterialTextureStreaming);
+
+        VkWriteDescriptorSet streamingWrite{};
+        streamingWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        streamingWrite.dstSet = frameDescriptorSets[i];
+        streamingWrite.dstBinding = 11; // mip 驻留信息绑定点
+        streamingWrite.dstArrayElement = 0;
+        streamingWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        streamingWrite.descriptorCount = 1;
+        streamingWrite.pBufferInfo = &streamingBufferInfo;
+
+        std::array<VkWriteDescriptorSet, 2> descriptorWrites = {materialTexturesWrite, streamingWrite};
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
+                               nullptr);
+    }
+}
+
+std::vector<VkCommandBuffer> PathTracingPipeline::recordCommandBuffers(uint32_t frameIndex, uint32_t imageIndex)
+{
+    const TileDispatchSettings& tileSettings = pathTracingResourceManager->getTileDispatchSettings();
+    bool persistentThreads = tileSettings.kernel == PathTracingKernel::PersistentThreads &&
+                             persistentThreadsPipeline != VK_NULL_HANDLE;
+
+    // tile 队列按 tilesPerDispatch 切成若干段，每段一次短 dispatch，常驻工作组在段内原子地领取 tile
+    uint32_t tileCount = pathTracingResourceManager->getTileCount();
+    uint32_t tilesPerDispatch = pathTracingResourceManager->getTilesPerDispatch();
+    uint32_t chunkCount = (tileCount + tilesPerDispatch - 1) / tilesPerDispatch;
+    uint32_t persistentWorkgroups = static_cast<uint32_t>(std::max(tileSettings.persistentWorkgroups, 1));
+    // 常驻线程内核按像素领取工作，一个 tile 可以分给多个工作组
+    uint32_t tileSize = pathTracingResourceManager->getTileSize();
+    uint32_t workgroupsPerTile = persistentThreads ? (tileSize * tileSize + 255) / 256 : 1;
+
+    // 每次提交只包含若干段 dispatch，提交之间 GPU 可以切换到其他工作 (例如窗口合成)，
+    // 一帧的路径追踪不会长时间独占队列
+    uint32_t chunksPerSubmit = getChunksPerSubmit(chunkCount);
+    uint32_t submitCount = std::max((chunkCount + chunksPerSubmit - 1) / chunksPerSubmit, 1u);
+
+    std::vector<VkCommandBuffer> commandBuffers;
+    for (uint32_t submit = 0; submit < submitCount; submit++)
+    {
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+        VkCommandBuffer commandBuffer = pathTracingCommandBuffers[frameIndex * MAX_PATH_TRACING_SUBMITS + submit];
+        if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to begin recording command buffer!");
+        }
+
+        if (submit == 0)
+        {
+            recordFrameBeginCommands(commandBuffer, frameIndex, imageIndex);
+        }
+
+        // 管线与描述符集的绑定不跨命令缓冲，每个命令缓冲都要重新绑定
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                          persistentThreads ? persistentThreadsPipeline : pathTracingPipeline);
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pathTracingPipelineLayout,
+                                0, // Set 0
+                                1, &imageDescriptorSets[imageIndex], 0, nullptr);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pathTracingPipelineLayout,
+                                1, // Set 1
+                                1, &frameDescriptorSets[frameIndex], 0, nullptr);
+
+        uint32_t chunkEnd = std::min((submit + 1) * chunksPerSubmit, chunkCount);
+        for (uint32_t chunk = submit * chunksPerSubmit; chunk < chunkEnd; chunk++)
+        {
+            std::array<uint32_t, 3> tileRange = {chunk * tilesPerDispatch,
+                                                 std::min((chunk + 1) * tilesPerDispatch, tileCount), chunk};
+            vkCmdPushConstants(commandBuffer, pathTracingPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                               sizeof(tileRange), tileRange.data());
+            // 工作组数不超过段内的工作量，多出的工作组会立即退出
+            vkCmdDispatch(commandBuffer,
+                          std::min((tileRange[1] - tileRange[0]) * workgroupsPerTile, persistentWorkgroups), 1, 1);
+        }
+
+        if (submit + 1 == submitCount)
+        {
+            recordFrameEndCommands(commandBuffer, frameIndex, imageIndex);
+        }
+
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to record command buffer!");
+        }
+        commandBuffers.push_back(commandBuffer);
+    }
+    return commandBuffers;
+}
+
+uint32_t PathTracingPipeline::getChunksPerSubmit(uint32_t chunkCount) const
+{
+    if (chunkCount == 0)
+    {
+        return 1;
+    }
+    // 每帧的命令缓冲数量固定，段数多时每次提交至少要装下这么多段
+    uint32_t minChunksPerSubmit = (chunkCount + MAX_PATH_TRACING_SUBMITS - 1) / MAX_PATH_TRACING_SUBMITS;
 
-    VkCommandBuffer commandBuffer = pathTracingCommandBuffers[frameIndex];
-    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+    // 用上一次测得的路径追踪耗时估计单段耗时；还没有测量时每段单独提交
+    uint32_t chunksPerSubmit = 1;
+    float dispatchMilliseconds = pathTracingResourceManager->getDispatchMilliseconds();
+    if (dispatchMilliseconds > 0.0f)
     {
-        throw std::runtime_error("failed to begin recording command buffer!");
+        float millisecondsPerChunk = dispatchMilliseconds / static_cast<float>(chunkCount);
+        float submitMilliseconds = pathTracingResourceManager->getTileDispatchSettings().submitMilliseconds;
+        chunksPerSubmit = static_cast<uint32_t>(
+            std::clamp(submitMilliseconds / millisecondsPerChunk, 1.0f, static_cast<float>(chunkCount)));
     }
+    return std::clamp(chunksPerSubmit, minChunksPerSubmit, chunkCount);
+}
 
+void PathTracingPipeline::recordFrameBeginCommands(VkCommandBuffer commandBuffer, uint32_t frameIndex,
+                                                   uint32_t imageIndex)
+{
     // 添加布局转换：从 SHADER_READ_ONLY_OPTIMAL 到 GENERAL
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -195,27 +485,74 @@ VkCommandBuffer PathTracingPipeline::recordCommandBuffer(uint32_t frameIndex, ui
                          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, // 源阶段
                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,  // 目标阶段
                          0, 0, nullptr, 0, nullptr, 1, &barrier);
+    // 反照率由降噪的计算着色器采样
+    barrier.image = pathTracingResourceManager->getAlbedoImages()[imageIndex];
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, // 源阶段
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, // 目标阶段
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pathTracingPipeline);
+    // Kahan 累积图像跨帧共享，需等待上一帧路径追踪的写入
+    VkMemoryBarrier accumulationBarrier{};
+    accumulationBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    accumulationBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    accumulationBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         1, &accumulationBarrier, 0, nullptr, 0, nullptr);
+
+    // 哈希网格失效后在本帧使用前清空，所有帧共用同一个缓冲区
+    VkBuffer pathSpaceCacheBuffer = pathTracingResourceManager->getPathSpaceCacheBuffer();
+    if (pathTracingResourceManager->consumePathSpaceCacheReset())
+    {
+        vkCmdFillBuffer(commandBuffer, pathSpaceCacheBuffer, 0, VK_WHOLE_SIZE, 0);
+        VkBufferMemoryBarrier cacheBarrier{};
+        cacheBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        cacheBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        cacheBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        cacheBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        cacheBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        cacheBarrier.buffer = pathSpaceCacheBuffer;
+        cacheBarrier.offset = 0;
+        cacheBarrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0,
+                             nullptr, 1, &cacheBarrier, 0, nullptr);
+    }
 
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pathTracingPipelineLayout,
-                            0, // Set 0
-                            1, &imageDescriptorSets[imageIndex], 0, nullptr);
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pathTracingPipelineLayout,
-                            1, // Set 1
-                            1, &frameDescriptorSets[frameIndex], 0, nullptr);
+    if (timestampQueryPool != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(commandBuffer, timestampQueryPool, frameIndex * 2, 2);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, frameIndex * 2);
+    }
+}
 
-    // 假设你根据输出图像尺寸来决定工作组数：
-    VkExtent2D imageExtent = pathTracingResourceManager->getOutputExtent();
-    uint32_t localSizeX = 16; // 计算着色器中定义的工作组大小
-    uint32_t localSizeY = 16; // 计算着色器中定义的工作组大小
-    uint32_t groupCountX = (imageExtent.width + localSizeX - 1) / localSizeX;
-    uint32_t groupCountY = (imageExtent.height + localSizeY - 1) / localSizeY;
+void PathTracingPipeline::recordFrameEndCommands(VkCommandBuffer commandBuffer, uint32_t frameIndex,
+                                                 uint32_t imageIndex)
+{
+    // 路径空间滤波 / 辐亮度缓存：所有路径写完本帧样本后，把每个格子的样本并入跨帧均值；
+    // 之后的屏障同时覆盖下一帧路径追踪对缓存的读取
+    if (pathTracingResourceManager->isPathSpaceCacheActive())
+    {
+        VkMemoryBarrier cacheBarrier{};
+        cacheBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        cacheBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        cacheBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &cacheBarrier, 0, nullptr, 0, nullptr);
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pathSpaceResolvePipeline);
+        vkCmdDispatch(commandBuffer, (pathTracingResourceManager->getPathSpaceCacheCellCount() + 255) / 256, 1, 1);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &cacheBarrier, 0, nullptr, 0, nullptr);
+    }
 
-    vkCmdDispatch(commandBuffer, groupCountX, groupCountY, 1);
+    if (timestampQueryPool != VK_NULL_HANDLE)
+    {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampQueryPool,
+                            frameIndex * 2 + 1);
+        timestampsWritten[frameIndex] = true;
+    }
 
     // 添加布局转换：从 GENERAL 到 SHADER_READ_ONLY_OPTIMAL
-    // VkImageMemoryBarrier barrier{};
+    VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
     barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -240,25 +577,156 @@ VkCommandBuffer PathTracingPipeline::recordCommandBuffer(uint32_t frameIndex, ui
                          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, // 源阶段
                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,  // 目标阶段
                          0, 0, nullptr, 0, nullptr, 1, &barrier);
+    barrier.image = pathTracingResourceManager->getAlbedoImages()[imageIndex];
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, // 源阶段
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, // 目标阶段
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
 
-    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+void PathTracingPipeline::createPathTracingPipeline()
+{
+    std::vector<VkDescriptorSetLayout> descriptorSetLayout = {imageDescriptorSetLayout, frameDescriptorSetLayout};
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayout.size());
+    pipelineLayoutInfo.pSetLayouts = descriptorSetLayout.data();
+
+    // 本次 dispatch 负责的 tile 区间与计数器序号
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(uint32_t) * 3;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pathTracingPipelineLayout) != VK_SUCCESS)
     {
-        throw std::runtime_error("failed to record command buffer!");
+        throw std::runtime_error("failed to create compute pipeline layout");
+    }
+
+    pathTracingPipeline = createPathTracingKernel(false);
+    // 常驻线程内核依赖子组 ballot，不支持时只保留 tile 内核
+    if (isPersistentThreadsSupported())
+    {
+        persistentThreadsPipeline = createPathTracingKernel(true);
     }
+    kernelStoragePrecision = pathTracingResourceManager->getStoragePrecision();
 
-    return commandBuffer;
+    shaderc::CompileOptions resolveOptions;
+    resolveOptions.SetIncluder(std::make_unique<ShaderIncluder>());
+    pathSpaceResolvePipeline = createComputePipeline("../shader/path_space_filter_resolve.comp", resolveOptions);
 }
 
-void PathTracingPipeline::createPathTracingPipeline()
+void PathTracingPipeline::updateStoragePrecision()
+{
+    if (pathTracingResourceManager->getStoragePrecision() == kernelStoragePrecision)
+    {
+        return;
+    }
+    // 重建输出图像前已 vkDeviceWaitIdle，旧管线不再被使用
+    vkDestroyPipeline(device, pathTracingPipeline, nullptr);
+    pathTracingPipeline = createPathTracingKernel(false);
+    if (persistentThreadsPipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(device, persistentThreadsPipeline, nullptr);
+        persistentThreadsPipeline = createPathTracingKernel(true);
+    }
+    kernelStoragePrecision = pathTracingResourceManager->getStoragePrecision();
+}
+
+bool PathTracingPipeline::isPersistentThreadsSupported() const
+{
+    VkPhysicalDeviceSubgroupProperties subgroupProperties{};
+    subgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &subgroupProperties;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    VkSubgroupFeatureFlags requiredOperations = VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_BALLOT_BIT;
+    return (subgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) &&
+           (subgroupProperties.supportedOperations & requiredOperations) == requiredOperations;
+}
+
+uint32_t PathTracingPipeline::queryResidentWorkgroupCount() const
+{
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data());
+    auto hasExtension = [&extensions](const char* name) {
+        return std::any_of(extensions.begin(), extensions.end(), [name](const VkExtensionProperties& extension) {
+            return std::string(extension.extensionName) == name;
+        });
+    };
+
+    constexpr uint32_t workgroupThreads = 16 * 16; // 与着色器的 local_size 一致
+    if (hasExtension(VK_NV_SHADER_SM_BUILTINS_EXTENSION_NAME))
+    {
+        VkPhysicalDeviceShaderSMBuiltinsPropertiesNV smProperties{};
+        smProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_SM_BUILTINS_PROPERTIES_NV;
+        VkPhysicalDeviceSubgroupProperties subgroupProperties{};
+        subgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+        subgroupProperties.pNext = &smProperties;
+        VkPhysicalDeviceProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &subgroupProperties;
+        vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+        return smProperties.shaderSMCount * smProperties.shaderWarpsPerSM * subgroupProperties.subgroupSize /
+               workgroupThreads;
+    }
+    if (hasExtension(VK_AMD_SHADER_CORE_PROPERTIES_EXTENSION_NAME))
+    {
+        VkPhysicalDeviceShaderCorePropertiesAMD coreProperties{};
+        coreProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_CORE_PROPERTIES_AMD;
+        VkPhysicalDeviceProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &coreProperties;
+        vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+        uint32_t computeUnits = coreProperties.shaderEngineCount * coreProperties.shaderArraysPerEngineCount *
+                                coreProperties.computeUnitsPerShaderArray;
+        return computeUnits * coreProperties.simdPerComputeUnit * coreProperties.wavefrontsPerSimd *
+               coreProperties.wavefrontSize / workgroupThreads;
+    }
+    return 0;
+}
+
+VkPipeline PathTracingPipeline::createPathTracingKernel(bool persistentThreads)
 {
-    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
     std::string compute_shader_code_path = "../shader/pathtracer_cook_torrance_mis.comp";
     // std::string compute_shader_code_path = "../shader/pathTracer_lambertian.comp";
 
+    shaderc::CompileOptions options;
+    options.SetIncluder(std::make_unique<ShaderIncluder>()); // 支持 #include "sampler.glsl"
+    options.AddMacroDefinition("OUTPUT_IMAGE_FORMAT",
+                               getStorageFormatQualifier(pathTracingResourceManager->getOutputImageFormat()));
+    options.AddMacroDefinition("SAMPLE_IMAGE_FORMAT",
+                               getStorageFormatQualifier(pathTracingResourceManager->getSampleImageFormat()));
+    if (pathTracingResourceManager->getStoragePrecision() == StoragePrecision::Half)
+    {
+        options.AddMacroDefinition("HALF_PRECISION_STORAGE");
+    }
+    if (persistentThreads)
+    {
+        // 子组操作需要 SPIR-V 1.3
+        options.AddMacroDefinition("PERSISTENT_THREADS");
+        options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_1);
+    }
+    return createComputePipeline(compute_shader_code_path, options);
+}
+
+VkPipeline PathTracingPipeline::createComputePipeline(const std::string& compute_shader_code_path,
+                                                      const shaderc::CompileOptions& options)
+{
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
     std::string cs = vulkanUtils.readFileToString(compute_shader_code_path);
     shaderc::Compiler compiler;
     // 编译顶点着色器，参数分别是着色器代码字符串，着色器类型，文件名
-    auto computeResult = compiler.CompileGlslToSpv(cs, shaderc_glsl_compute_shader, compute_shader_code_path.c_str());
+    auto computeResult =
+        compiler.CompileGlslToSpv(cs, shaderc_glsl_compute_shader, compute_shader_code_path.c_str(), options);
     auto errorInfo_vert = computeResult.GetErrorMessage();
     if (!errorInfo_vert.empty())
     {
@@ -283,29 +751,19 @@ void PathTracingPipeline::createPathTracingPipeline()
     shaderStageInfo.module = computeShaderModule;
     shaderStageInfo.pName = "main";
 
-    std::vector<VkDescriptorSetLayout> descriptorSetLayout = {imageDescriptorSetLayout, frameDescriptorSetLayout};
-
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayout.size());
-    pipelineLayoutInfo.pSetLayouts = descriptorSetLayout.data();
-
-    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pathTracingPipelineLayout) != VK_SUCCESS)
-    {
-        throw std::runtime_error("failed to create compute pipeline layout");
-    }
-
     VkComputePipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
     pipelineInfo.stage = shaderStageInfo;
     pipelineInfo.layout = pathTracingPipelineLayout;
 
-    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pathTracingPipeline) != VK_SUCCESS)
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to create compute pipeline");
     }
 
     vkDestroyShaderModule(device, computeShaderModule, nullptr);
+    return pipeline;
 }
 
 void PathTracingPipeline::createDescriptorSetLayout()
@@ -325,7 +783,37 @@ void PathTracingPipeline::createDescriptorSetLayout()
     accumulationImagesBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT; // 仅在计算着色器中使用
     accumulationImagesBinding.pImmutableSamplers = nullptr;             // 不使用采样器
 
-    std::array<VkDescriptorSetLayoutBinding, 2> imageBindings = {storageImageBinding, accumulationImagesBinding};
+    // ReSTIR DI 空间复用后的蓄水池，与输出图像同尺寸
+    VkDescriptorSetLayoutBinding reservoirBinding{};
+    reservoirBinding.binding = 2;
+    reservoirBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    reservoirBinding.descriptorCount = 1;
+    reservoirBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    reservoirBinding.pImmutableSamplers = nullptr;
+
+    // Kahan 补偿累积：未归一化的总和与补偿项
+    VkDescriptorSetLayoutBinding accumulationSumBinding{};
+    accumulationSumBinding.binding = 3;
+    accumulationSumBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    accumulationSumBinding.descriptorCount = 1;
+    accumulationSumBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    accumulationSumBinding.pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutBinding accumulationCompensationBinding = accumulationSumBinding;
+    accumulationCompensationBinding.binding = 4;
+
+    // 首次命中反照率，供降噪解调
+    VkDescriptorSetLayoutBinding albedoImageBinding = accumulationSumBinding;
+    albedoImageBinding.binding = 5;
+
+    // 反照率总和，补偿求和累积时使用
+    VkDescriptorSetLayoutBinding albedoSumBinding = accumulationSumBinding;
+    albedoSumBinding.binding = 6;
+
+    std::array<VkDescriptorSetLayoutBinding, 7> imageBindings = {storageImageBinding, accumulationImagesBinding,
+                                                                 reservoirBinding, accumulationSumBinding,
+                                                                 accumulationCompensationBinding, albedoImageBinding,
+                                                                 albedoSumBinding};
 
     VkDescriptorSetLayoutCreateInfo set0LayoutInfo{};
     set0LayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -355,7 +843,7 @@ void PathTracingPipeline::createDescriptorSetLayout()
     // Materials 缓冲区绑定
     VkDescriptorSetLayoutBinding materialBinding{};
     materialBinding.binding = 2;
-    materialBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    materialBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
     materialBinding.descriptorCount = 1;
     materialBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
     materialBinding.pImmutableSamplers = nullptr;
@@ -374,8 +862,67 @@ void PathTracingPipeline::createDescriptorSetLayout()
     emissiveTrianglesBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
     emissiveTrianglesBinding.pImmutableSamplers = nullptr;
 
-    std::array<VkDescriptorSetLayoutBinding, 5> bindings = {triangleBinding, bvhBufferBinding, materialBinding,
-                                                            cameraDataBinding, emissiveTrianglesBinding};
+    // 环境贴图 (equirect HDR) 与其重要性采样分布
+    VkDescriptorSetLayoutBinding environmentMapBinding{};
+    environmentMapBinding.binding = 5;
+    environmentMapBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    environmentMapBinding.descriptorCount = 1;
+    environmentMapBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    environmentMapBinding.pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutBinding environmentDistributionBinding{};
+    environmentDistributionBinding.binding = 6;
+    environmentDistributionBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    environmentDistributionBinding.descriptorCount = 1;
+    environmentDistributionBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    environmentDistributionBinding.pImmutableSamplers = nullptr;
+
+    // 路径统计 (平均路径长度)，CPU 可见
+    VkDescriptorSetLayoutBinding pathStatisticsBinding{};
+    pathStatisticsBinding.binding = 7;
+    pathStatisticsBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pathStatisticsBinding.descriptorCount = 1;
+    pathStatisticsBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pathStatisticsBinding.pImmutableSamplers = nullptr;
+
+    // tile 队列 (头部 + 原子计数器 + tile 顺序)，CPU 每帧写入
+    VkDescriptorSetLayoutBinding tileQueueBinding{};
+    tileQueueBinding.binding = 8;
+    tileQueueBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    tileQueueBinding.descriptorCount = 1;
+    tileQueueBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    tileQueueBinding.pImmutableSamplers = nullptr;
+
+    // 材质贴图数组，着色器中以 nonuniformEXT 下标访问
+    VkDescriptorSetLayoutBinding materialTexturesBinding{};
+    materialTexturesBinding.binding = 10;
+    materialTexturesBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    materialTexturesBinding.descriptorCount = MAX_MATERIAL_TEXTURES;
+    materialTexturesBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    materialTexturesBinding.pImmutableSamplers = nullptr;
+
+    // 材质贴图的 mip 驻留信息
+    VkDescriptorSetLayoutBinding materialTextureStreamingBinding{};
+    materialTextureStreamingBinding.binding = 11;
+    materialTextureStreamingBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    materialTextureStreamingBinding.descriptorCount = 1;
+    materialTextureStreamingBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    materialTextureStreamingBinding.pImmutableSamplers = nullptr;
+
+    // 路径空间滤波的哈希网格
+    VkDescriptorSetLayoutBinding pathSpaceCacheBinding{};
+    pathSpaceCacheBinding.binding = 12;
+    pathSpaceCacheBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pathSpaceCacheBinding.descriptorCount = 1;
+    pathSpaceCacheBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pathSpaceCacheBinding.pImmutableSamplers = nullptr;
+
+    std::array<VkDescriptorSetLayoutBinding, 12> bindings = {triangleBinding,          bvhBufferBinding,
+                                                             materialBinding,          cameraDataBinding,
+                                                             emissiveTrianglesBinding, environmentMapBinding,
+                                                             environmentDistributionBinding, pathStatisticsBinding,
+                                                             tileQueueBinding,         materialTexturesBinding,
+                                                             materialTextureStreamingBinding, pathSpaceCacheBinding};
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
@@ -391,16 +938,19 @@ void PathTracingPipeline::createDescriptorPool()
 {
     int imageCount = pathTracingResourceManager->getPathTracingOutputImages().size();
     int frameCount = MAX_FRAMES_IN_FLIGHT;
-    std::array<VkDescriptorPoolSize, 3> poolSizes{};
+    std::array<VkDescriptorPoolSize, 4> poolSizes{};
     // VkDescriptorPoolSize poolSize{};
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    poolSizes[0].descriptorCount = 3 * static_cast<uint32_t>(frameCount);
+    poolSizes[0].descriptorCount = 10 * static_cast<uint32_t>(frameCount) + static_cast<uint32_t>(imageCount);
 
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSizes[1].descriptorCount = 2 * static_cast<uint32_t>(frameCount);
+    poolSizes[1].descriptorCount = static_cast<uint32_t>(frameCount);
 
     poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; // 类型为存储缓冲区
-    poolSizes[2].descriptorCount = 2 * static_cast<uint32_t>(imageCount);
+    poolSizes[2].descriptorCount = 6 * static_cast<uint32_t>(imageCount);
+
+    poolSizes[3].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[3].descriptorCount = (1 + MAX_MATERIAL_TEXTURES) * static_cast<uint32_t>(frameCount);
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -476,7 +1026,80 @@ void PathTracingPipeline::createDescriptorSets()
         accumulationImageWrite.descriptorCount = 1;
         accumulationImageWrite.pImageInfo = &accumulationImageInfo;
 
-        std::vector<VkWriteDescriptorSet> descriptorWrites = {imageWrite, accumulationImageWrite};
+        VkDescriptorBufferInfo reservoirBufferInfo{};
+        reservoirBufferInfo.buffer = pathTracingResourceManager->getReservoirBuffer();
+        reservoirBufferInfo.offset = 0;
+        reservoirBufferInfo.range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet reservoirWrite{};
+        reservoirWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        reservoirWrite.dstSet = imageDescriptorSets[i];
+        reservoirWrite.dstBinding = 2; // ReSTIR 蓄水池绑定点
+        reservoirWrite.dstArrayElement = 0;
+        reservoirWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        reservoirWrite.descriptorCount = 1;
+        reservoirWrite.pBufferInfo = &reservoirBufferInfo;
+
+        // Kahan 累积的总和与补偿图像，所有交换链图像共用一份
+        VkDescriptorImageInfo accumulationSumInfo{};
+        accumulationSumInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        accumulationSumInfo.imageView = pathTracingResourceManager->getAccumulationSumImageView();
+        accumulationSumInfo.sampler = VK_NULL_HANDLE;
+
+        VkDescriptorImageInfo accumulationCompensationInfo{};
+        accumulationCompensationInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        accumulationCompensationInfo.imageView = pathTracingResourceManager->getAccumulationCompensationImageView();
+        accumulationCompensationInfo.sampler = VK_NULL_HANDLE;
+
+        VkWriteDescriptorSet accumulationSumWrite{};
+        accumulationSumWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        accumulationSumWrite.dstSet = imageDescriptorSets[i];
+        accumulationSumWrite.dstBinding = 3;
+        accumulationSumWrite.dstArrayElement = 0;
+        accumulationSumWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        accumulationSumWrite.descriptorCount = 1;
+        accumulationSumWrite.pImageInfo = &accumulationSumInfo;
+
+        VkWriteDescriptorSet accumulationCompensationWrite{};
+        accumulationCompensationWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        accumulationCompensationWrite.dstSet = imageDescriptorSets[i];
+        accumulationCompensationWrite.dstBinding = 4;
+        accumulationCompensationWrite.dstArrayElement = 0;
+        accumulationCompensationWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        accumulationCompensationWrite.descriptorCount = 1;
+        accumulationCompensationWrite.pImageInfo = &accumulationCompensationInfo;
+
+        VkDescriptorImageInfo albedoImageInfo{};
+        albedoImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        albedoImageInfo.imageView = pathTracingResourceManager->getAlbedoImageViews()[i];
+        albedoImageInfo.sampler = VK_NULL_HANDLE;
+
+        VkWriteDescriptorSet albedoImageWrite{};
+        albedoImageWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        albedoImageWrite.dstSet = imageDescriptorSets[i];
+        albedoImageWrite.dstBinding = 5;
+        albedoImageWrite.dstArrayElement = 0;
+        albedoImageWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        albedoImageWrite.descriptorCount = 1;
+        albedoImageWrite.pImageInfo = &albedoImageInfo;
+
+        VkDescriptorImageInfo albedoSumInfo{};
+        albedoSumInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        albedoSumInfo.imageView = pathTracingResourceManager->getAccumulationAlbedoSumImageView();
+        albedoSumInfo.sampler = VK_NULL_HANDLE;
+
+        VkWriteDescriptorSet albedoSumWrite{};
+        albedoSumWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        albedoSumWrite.dstSet = imageDescriptorSets[i];
+        albedoSumWrite.dstBinding = 6;
+        albedoSumWrite.dstArrayElement = 0;
+        albedoSumWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        albedoSumWrite.descriptorCount = 1;
+        albedoSumWrite.pImageInfo = &albedoSumInfo;
+
+        std::vector<VkWriteDescriptorSet> descriptorWrites = {imageWrite, accumulationImageWrite, reservoirWrite,
+                                                              accumulationSumWrite, accumulationCompensationWrite,
+                                                              albedoImageWrite, albedoSumWrite};
         vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
                                nullptr);
     }
@@ -494,10 +1117,9 @@ void PathTracingPipeline::createDescriptorSets()
         bvhBufferInfo.range = VK_WHOLE_SIZE;
 
         VkDescriptorBufferInfo materialBufferInfo{};
-        materialBufferInfo.buffer = pathTracingResourceManager->getMaterialUniformBuffers()[i];
+        materialBufferInfo.buffer = pathTracingResourceManager->getMaterialBuffers()[i];
         materialBufferInfo.offset = 0;
-        materialBufferInfo.range =
-            sizeof(MaterialUniformBufferObject) * pathTracingResourceManager->getShapeNames().size();
+        materialBufferInfo.range = VK_WHOLE_SIZE; // 材质数量不定
 
         VkDescriptorBufferInfo cameraDataBufferInfo{};
         cameraDataBufferInfo.buffer = pathTracingResourceManager->getCameraDataBuffer()[i];
@@ -509,6 +1131,16 @@ void PathTracingPipeline::createDescriptorSets()
         emissiveTrianglesBufferInfo.offset = 0;
         emissiveTrianglesBufferInfo.range = VK_WHOLE_SIZE; // 假设整个缓冲区都需要
 
+        VkDescriptorImageInfo environmentMapInfo{};
+        environmentMapInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        environmentMapInfo.imageView = textureResourceManager->getSourceHDRImageView();
+        environmentMapInfo.sampler = textureResourceManager->getSourceHDRSampler();
+
+        VkDescriptorBufferInfo environmentDistributionBufferInfo{};
+        environmentDistributionBufferInfo.buffer = textureResourceManager->getEnvironmentDistributionBuffer();
+        environmentDistributionBufferInfo.offset = 0;
+        environmentDistributionBufferInfo.range = VK_WHOLE_SIZE;
+
         VkWriteDescriptorSet trianglesWrite{};
         trianglesWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         trianglesWrite.dstSet = frameDescriptorSets[i];
@@ -532,10 +1164,42 @@ void PathTracingPipeline::createDescriptorSets()
         materialsWrite.dstSet = frameDescriptorSets[i];
         materialsWrite.dstBinding = 2; // Materials 绑定点
         materialsWrite.dstArrayElement = 0;
-        materialsWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        materialsWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         materialsWrite.descriptorCount = 1;
         materialsWrite.pBufferInfo = &materialBufferInfo;
 
+        VkWriteDescriptorSet environmentMapWrite{};
+        environmentMapWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        environmentMapWrite.dstSet = frameDescriptorSets[i];
+        environmentMapWrite.dstBinding = 5; // 环境贴图绑定点
+        environmentMapWrite.dstArrayElement = 0;
+        environmentMapWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        environmentMapWrite.descriptorCount = 1;
+        environmentMapWrite.pImageInfo = &environmentMapInfo;
+
+        VkWriteDescriptorSet environmentDistributionWrite{};
+        environmentDistributionWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        environmentDistributionWrite.dstSet = frameDescriptorSets[i];
+        environmentDistributionWrite.dstBinding = 6; // 环境光采样分布绑定点
+        environmentDistributionWrite.dstArrayElement = 0;
+        environmentDistributionWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        environmentDistributionWrite.descriptorCount = 1;
+        environmentDistributionWrite.pBufferInfo = &environmentDistributionBufferInfo;
+
+        VkDescriptorBufferInfo pathStatisticsBufferInfo{};
+        pathStatisticsBufferInfo.buffer = pathTracingResourceManager->getPathStatisticsBuffers()[i];
+        pathStatisticsBufferInfo.offset = 0;
+        pathStatisticsBufferInfo.range = sizeof(PathStatistics);
+
+        VkWriteDescriptorSet pathStatisticsWrite{};
+        pathStatisticsWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        pathStatisticsWrite.dstSet = frameDescriptorSets[i];
+        pathStatisticsWrite.dstBinding = 7; // 路径统计绑定点
+        pathStatisticsWrite.dstArrayElement = 0;
+        pathStatisticsWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        pathStatisticsWrite.descriptorCount = 1;
+        pathStatisticsWrite.pBufferInfo = &pathStatisticsBufferInfo;
+
         VkWriteDescriptorSet cameraDataWrite{};
         cameraDataWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         cameraDataWrite.dstSet = frameDescriptorSets[i];
@@ -554,9 +1218,35 @@ void PathTracingPipeline::createDescriptorSets()
         emissiveTrianglesWrite.descriptorCount = 1;
         emissiveTrianglesWrite.pBufferInfo = &emissiveTrianglesBufferInfo;
 
-        std::vector<VkWriteDescriptorSet> descriptorWrites = {trianglesWrite, bvhBufferWrite, materialsWrite,
-                                                              cameraDataWrite, emissiveTrianglesWrite};
+        std::vector<VkWriteDescriptorSet> descriptorWrites = {trianglesWrite,         bvhBufferWrite,
+                                                              materialsWrite,         cameraDataWrite,
+                                                              emissiveTrianglesWrite, environmentMapWrite,
+                                                              environmentDistributionWrite, pathStatisticsWrite};
         vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
                                nullptr);
     }
+    updateTileBufferDescriptorSet();
+    updateMaterialTextureDescriptorSet();
+    updatePathSpaceCacheDescriptorSet();
+}
+
+void PathTracingPipeline::updatePathSpaceCacheDescriptorSet()
+{
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        VkDescriptorBufferInfo cacheBufferInfo{};
+        cacheBufferInfo.buffer = pathTracingResourceManager->getPathSpaceCacheBuffer();
+        cacheBufferInfo.offset = 0;
+        cacheBufferInfo.range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet cacheWrite{};
+        cacheWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        cacheWrite.dstSet = frameDescriptorSets[i];
+        cacheWrite.dstBinding = 12; // 哈希网格绑定点
+        cacheWrite.dstArrayElement = 0;
+        cacheWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        cacheWrite.descriptorCount = 1;
+        cacheWrite.pBufferInfo = &cacheBufferInfo;
+        vkUpdateDescriptorSets(device, 1, &cacheWrite, 0, nullptr);
+    }
 }
\ No newline at end of file
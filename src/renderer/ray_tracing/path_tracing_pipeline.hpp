@@ -1,38 +1,71 @@
 #pragma once
 
 #include "path_tracing_resource_manager.hpp"
+#include "texture_resource_manager.hpp"
+#include <shaderc/shaderc.hpp>
 #include <string>
 #include <vector>
 #include <vulkan/vulkan.h>
 
 class PathTracingPipelineObserver;
 
+// 每个 in-flight 帧路径追踪最多拆成的提交次数，init 需要 MAX_FRAMES_IN_FLIGHT * MAX_PATH_TRACING_SUBMITS 个命令缓冲
+const uint32_t MAX_PATH_TRACING_SUBMITS = 8;
+
 class PathTracingPipeline
 {
   public:
     void init(VkDevice device, VkPhysicalDevice physicalDevice, PathTracingResourceManager& pathTracingResourceManager,
-              std::vector<VkCommandBuffer>&& commandBuffers);
+              TextureResourceManager& textureResourceManager, std::vector<VkCommandBuffer>&& commandBuffers);
     void cleanup();
 
-    VkCommandBuffer recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex);
+    // 按 TileDispatchSettings::submitMilliseconds 把本帧的 tile 段录制进若干个命令缓冲，
+    // 调用方按顺序把每个命令缓冲单独提交
+    std::vector<VkCommandBuffer> recordCommandBuffers(uint32_t frameIndex, uint32_t imageIndex);
 
     void updateOutputImageDescriptorSet();
 
+    // 输出图像按新的存储精度重建后，重新编译带格式限定符的路径追踪内核；精度未变时不做任何事
+    void updateStoragePrecision();
+
     void updateStorageBufferDescriptorSet();
 
-    VkCommandBuffer getCommandBuffer(size_t index) const
+    void updateTileBufferDescriptorSet();
+
+    void updateMaterialTextureDescriptorSet();
+
+    void updatePathSpaceCacheDescriptorSet();
+
+    void resetCommandBuffers(uint32_t frameIndex)
     {
-        return pathTracingCommandBuffers[index];
+        for (uint32_t i = 0; i < MAX_PATH_TRACING_SUBMITS; ++i)
+        {
+            vkResetCommandBuffer(pathTracingCommandBuffers[frameIndex * MAX_PATH_TRACING_SUBMITS + i], 0);
+        }
     }
 
+    // 读取 frameIndex 上一次 dispatch 的 GPU 耗时 (毫秒)，需在该帧的 fence 等待之后调用；没有结果时返回 -1
+    float collectDispatchTime(uint32_t frameIndex);
+
+    // 设备是否支持常驻线程内核所需的子组操作
+    bool isPersistentThreadsSupported() const;
+
+    // 设备上能同时驻留的 256 线程工作组数的上限 (不计寄存器压力)，
+    // 由 VK_NV_shader_sm_builtins 或 VK_AMD_shader_core_properties 的计算单元数推出；两者都不支持时返回 0
+    uint32_t queryResidentWorkgroupCount() const;
+
   private:
     VkDevice device = VK_NULL_HANDLE;
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
     PathTracingResourceManager* pathTracingResourceManager = nullptr;
+    TextureResourceManager* textureResourceManager = nullptr;
     std::vector<VkCommandBuffer> pathTracingCommandBuffers;
 
     VkPipeline pathTracingPipeline = VK_NULL_HANDLE;
+    VkPipeline persistentThreadsPipeline = VK_NULL_HANDLE; // 设备不支持子组 ballot 时为 VK_NULL_HANDLE
     VkPipelineLayout pathTracingPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline pathSpaceResolvePipeline = VK_NULL_HANDLE; // 与路径追踪共用管线布局和描述符集
+    StoragePrecision kernelStoragePrecision = StoragePrecision::Full; // 编译路径追踪内核时的存储精度
 
     VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
 
@@ -46,13 +79,24 @@ class PathTracingPipeline
 
     std::unique_ptr<PathTracingPipelineObserver> pathTracingPipelineObserver;
 
+    // 每个 in-flight 帧两个时间戳 (dispatch 前后)，设备不支持时为 VK_NULL_HANDLE
+    VkQueryPool timestampQueryPool = VK_NULL_HANDLE;
+    float timestampPeriod = 0.0f; // 每个时间戳单位对应的纳秒数
+    std::vector<bool> timestampsWritten;
+
+    void createTimestampQueryPool();
+    uint32_t getChunksPerSubmit(uint32_t chunkCount) const;
+    void recordFrameBeginCommands(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t imageIndex);
+    void recordFrameEndCommands(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t imageIndex);
     void createPathTracingPipeline();
+    VkPipeline createPathTracingKernel(bool persistentThreads);
+    VkPipeline createComputePipeline(const std::string& shaderPath, const shaderc::CompileOptions& options);
     void createDescriptorSetLayout();
     void createDescriptorPool();
     void createDescriptorSets();
 };
 
-class PathTracingPipelineObserver : public PathTracingResourceReloadObserver
+class PathTracingPipelineObserver : public PathTracingResourceReloadObserver, public PathSpaceCacheRecreateObserver
 {
   public:
     PathTracingPipelineObserver(PathTracingPipeline* pathTracingPipeline) // 使用指向 RenderPipeline 的指针
@@ -74,7 +118,17 @@ class PathTracingPipelineObserver : public PathTracingResourceReloadObserver
         // 当路径追踪输出图像重新创建时，更新 RenderPipeline 的描述符集
         if (pathTracingPipeline)
         {
+            pathTracingPipeline->updateStoragePrecision();
             pathTracingPipeline->updateOutputImageDescriptorSet();
+            pathTracingPipeline->updateTileBufferDescriptorSet();
+        }
+    }
+
+    void onPathSpaceCacheRecreated() override
+    {
+        if (pathTracingPipeline)
+        {
+            pathTracingPipeline->updatePathSpaceCacheDescriptorSet();
         }
     }
 
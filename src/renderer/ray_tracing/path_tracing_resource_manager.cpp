@@ -4,8 +4,43 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #endif
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <numeric>
 #include <glm/gtc/matrix_transform.hpp>
 
+namespace
+{
+float halton(uint32_t index, uint32_t base)
+{
+    float result = 0.0f;
+    float fraction = 1.0f;
+    while (index > 0)
+    {
+        fraction /= base;
+        result += fraction * (index % base);
+        index /= base;
+    }
+    return result;
+}
+
+// 过早的统计方差估计不可靠，至少累积这么多帧才做收敛判定
+constexpr uint32_t MIN_SAMPLES_FOR_CONVERGENCE = 16;
+
+// 哈希网格槽位数的范围：64K (3 MB) 到 4M (192 MB)
+constexpr int MIN_PATH_SPACE_CACHE_SIZE_LOG2 = 16;
+constexpr int MAX_PATH_SPACE_CACHE_SIZE_LOG2 = 22;
+
+// 缓存关闭期间解析 pass 不运行，缓存内容不再更新；格子大小变化后键也不再对应
+bool isPathSpaceCacheInvalidated(const PathTracingSettings& settings, const PathTracingSettings& lastSettings)
+{
+    bool active = settings.pathSpaceFiltering || settings.radianceCache;
+    bool lastActive = lastSettings.pathSpaceFiltering || lastSettings.radianceCache;
+    return active != lastActive || settings.pathSpaceCellSize != lastSettings.pathSpaceCellSize;
+}
+} // namespace
+
 void PathTracingResourceManager::init(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue,
                                       SwapChainManager& swapChainManager, CommandManager& commandManager,
                                       VertexResourceManager& vertexResourceManager)
@@ -14,20 +49,30 @@ void PathTracingResourceManager::init(VkDevice device, VkPhysicalDevice physical
     this->physicalDevice = physicalDevice;
     this->graphicsQueue = graphicsQueue;
     this->swapChainManager = &swapChainManager;
-    this->outPutExtent = swapChainManager.getSwapChainExtent();
+    this->viewportExtent = swapChainManager.getSwapChainExtent();
+    this->appliedRenderScale = settings.renderScale;
+    this->outPutExtent = scaleExtent(viewportExtent);
     this->commandManager = &commandManager;
     this->vertexResourceManager = &vertexResourceManager;
-    this->materialUniformBuffers = &vertexResourceManager.getMaterialUniformBuffers();
+    this->materialBuffers = &vertexResourceManager.getMaterialBuffers();
     // 用于rebuild相关资源时双帧或多帧同步
     this->maxFramesInFlight = MAX_FRAMES_IN_FLIGHT + 1;
     this->framesToForceZero = maxFramesInFlight;
+    this->storagePrecision = settings.storagePrecision;
+    this->sampleImageFormat = chooseSampleImageFormat();
 
     buildTrianglesFromMesh(vertexResourceManager.getVertices(), vertexResourceManager.getIndices());
     buildBVH();
     createTriangleStorageBuffer();
     createPathTracingOutputImages();
     createAccumulationImages();
+    createAlbedoImages();
     createCameraDataBuffer();
+    createPathStatisticsBuffers();
+    createReservoirBuffers();
+    createAccumulationSumImages();
+    createTileBuffers();
+    createPathSpaceCacheBuffer();
 
     pathTracingResourceManagerModelObserver =
         std::make_unique<PathTracingResourceManagerModelObserver>(this); // 创建模型重新加载观察者
@@ -59,11 +104,26 @@ void PathTracingResourceManager::cleanup()
         vkDestroyImage(device, accumulationImages[i], nullptr);
         vkFreeMemory(device, accumulationImageMemories[i], nullptr);
     }
+    for (size_t i = 0; i < albedoImages.size(); i++)
+    {
+        vkDestroyImageView(device, albedoImageViews[i], nullptr);
+        vkDestroyImage(device, albedoImages[i], nullptr);
+        vkFreeMemory(device, albedoImageMemories[i], nullptr);
+    }
     for (size_t i = 0; i < cameraDataBuffer.size(); i++)
     {
         vkDestroyBuffer(device, cameraDataBuffer[i], nullptr);
         vkFreeMemory(device, cameraDataBufferMemory[i], nullptr);
     }
+    for (size_t i = 0; i < pathStatisticsBuffers.size(); i++)
+    {
+        vkDestroyBuffer(device, pathStatisticsBuffers[i], nullptr);
+        vkFreeMemory(device, pathStatisticsBufferMemory[i], nullptr);
+    }
+    destroyReservoirBuffers();
+    destroyAccumulationSumImages();
+    destroyTileBuffers();
+    destroyPathSpaceCacheBuffer();
 }
 
 void PathTracingResourceManager::recreatePathTracingOutputImages(VkExtent2D imageExtent)
@@ -81,16 +141,40 @@ void PathTracingResourceManager::recreatePathTracingOutputImages(VkExtent2D imag
         vkDestroyImage(device, accumulationImages[i], nullptr);
         vkFreeMemory(device, accumulationImageMemories[i], nullptr);
     }
-    outPutExtent = imageExtent; // 更新输出图像的尺寸
+    for (size_t i = 0; i < albedoImages.size(); i++)
+    {
+        vkDestroyImageView(device, albedoImageViews[i], nullptr);
+        vkDestroyImage(device, albedoImages[i], nullptr);
+        vkFreeMemory(device, albedoImageMemories[i], nullptr);
+    }
+    destroyReservoirBuffers();
+    destroyAccumulationSumImages();
+    destroyTileBuffers();
+    viewportExtent = imageExtent;
+    appliedRenderScale = settings.renderScale;
+    outPutExtent = scaleExtent(imageExtent); // 更新输出图像的尺寸
+    storagePrecision = settings.storagePrecision;
+    sampleImageFormat = chooseSampleImageFormat();
     createPathTracingOutputImages();
     createAccumulationImages();
-    totalSampleCount = 0;
+    createAlbedoImages();
+    createReservoirBuffers();
+    createAccumulationSumImages();
+    createTileBuffers();
+    resetTotalSampleCount();
     for (auto observer : pathTracingResourceReloadObservers)
     {
         observer->onPathTracingOutputImagesRecreated();
     }
 }
 
+VkExtent2D PathTracingResourceManager::scaleExtent(VkExtent2D extent) const
+{
+    float scale = std::clamp(appliedRenderScale, 0.25f, 1.0f);
+    return {std::max(1u, static_cast<uint32_t>(extent.width * scale)),
+            std::max(1u, static_cast<uint32_t>(extent.height * scale))};
+}
+
 void PathTracingResourceManager::recreteTriangleData()
 {
     triangles.clear();
@@ -105,8 +189,8 @@ void PathTracingResourceManager::recreteTriangleData()
     buildBVH();
     createTriangleStorageBuffer();
     vkDeviceWaitIdle(device);
-    totalSampleCount = 0;
-    framesToForceZero = maxFramesInFlight;
+    resetTotalSampleCount();
+    requestPathSpaceCacheReset(); // 旧场景的格子不再对应任何表面
     for (auto observer : pathTracingResourceReloadObservers)
     {
         observer->onModelReloaded();
@@ -139,6 +223,9 @@ void PathTracingResourceManager::buildTrianglesFromMesh(const std::vector<Vertex
         tri.n2 = v2.normal;
         tri.normal = faceNormal;        // 或者用 v0.normal，依据你想用哪种法线
         tri.materialID = v0.materialID; // 默认 v0 的材质 ID，一般 OBJ 同面材质一致
+        tri.uv0 = v0.texCoord;
+        tri.uv1 = v1.texCoord;
+        tri.uv2 = v2.texCoord;
 
         triangles.push_back(tri);
         if (vertexResourceManager->getShapeNames()[tri.materialID] == "light")
@@ -361,6 +448,25 @@ void PathTracingResourceManager::createTriangleStorageBuffer()
     vkFreeMemory(device, stagingBufferMemory, nullptr);
 }
 
+VkFormat PathTracingResourceManager::chooseSampleImageFormat() const
+{
+    if (storagePrecision == StoragePrecision::Full)
+    {
+        return VK_FORMAT_R32G32B32A32_SFLOAT;
+    }
+    // R11G11B10 作为存储图像需要 shaderStorageImageExtendedFormats，不支持时退回 RGBA16F
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_B10G11R11_UFLOAT_PACK32, &formatProperties);
+    if (features.shaderStorageImageExtendedFormats &&
+        (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT))
+    {
+        return VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+    }
+    return VK_FORMAT_R16G16B16A16_SFLOAT;
+}
+
 void PathTracingResourceManager::createPathTracingOutputImages()
 {
     VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
@@ -370,7 +476,7 @@ void PathTracingResourceManager::createPathTracingOutputImages()
 
     for (size_t i = 0; i < storageImages.size(); i++)
     {
-        VkFormat format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        VkFormat format = getOutputImageFormat();
         // VkFormat format = swapChainManager->getSwapChainImageFormat();
         vulkanUtils.createImage(
             device, physicalDevice, outPutExtent.width, outPutExtent.height, format, VK_IMAGE_TILING_OPTIMAL,
@@ -391,7 +497,7 @@ void PathTracingResourceManager::createAccumulationImages()
 
     for (size_t i = 0; i < accumulationImages.size(); i++)
     {
-        VkFormat format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        VkFormat format = sampleImageFormat;
         // VkFormat format = VK_FORMAT_R32G32B32A32_SFLOAT;
         vulkanUtils.createImage(device, physicalDevice, outPutExtent.width, outPutExtent.height, format,
                                 VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
@@ -405,6 +511,25 @@ void PathTracingResourceManager::createAccumulationImages()
     }
 }
 
+void PathTracingResourceManager::createAlbedoImages()
+{
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+    albedoImages.resize(swapChainManager->getSwapChainImageViews().size());
+    albedoImageMemories.resize(albedoImages.size());
+    albedoImageViews.resize(albedoImages.size());
+
+    for (size_t i = 0; i < albedoImages.size(); i++)
+    {
+        VkFormat format = getOutputImageFormat();
+        vulkanUtils.createImage(device, physicalDevice, outPutExtent.width, outPutExtent.height, format,
+                                VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, albedoImages[i], albedoImageMemories[i]);
+        vulkanUtils.transitionImageLayout(device, commandManager->getCommandPool(), graphicsQueue, albedoImages[i],
+                                          format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        albedoImageViews[i] = vulkanUtils.createImageView(device, albedoImages[i], format, VK_IMAGE_ASPECT_COLOR_BIT);
+    }
+}
+
 void PathTracingResourceManager::createCameraDataBuffer()
 {
     VkDeviceSize bufferSize = sizeof(CameraData);
@@ -427,31 +552,410 @@ void PathTracingResourceManager::createCameraDataBuffer()
 void PathTracingResourceManager::updateCameraDataBuffer(uint32_t currentFrame, VkExtent2D swapChainExtent,
                                                         Camera& camera)
 {
-    CameraData cameraData;
+    CameraData cameraData{};
     glm::mat4 proj =
         glm::perspective(glm::radians(45.0f), swapChainExtent.width / (float)swapChainExtent.height, 0.1f, 10.0f);
     proj[1][1] *= -1; // flip Y axis for Vulkan
-    cameraData.invViewProj = glm::inverse(proj * camera.getViewMatrix());
+    glm::mat4 viewProj = proj * camera.getViewMatrix();
+    cameraData.invViewProj = glm::inverse(viewProj);
     cameraData.cameraPos = camera.getPosition();
+    // 第一帧或窗口尺寸变化后没有对应的上一帧矩阵，沿用本帧矩阵
+    bool hasLastViewProj = lastViewProjExtent.width == swapChainExtent.width &&
+                           lastViewProjExtent.height == swapChainExtent.height;
+    cameraData.prevViewProj = hasLastViewProj ? lastViewProj : viewProj;
+    cameraData.frameCounter = frameCounter++;
+    cameraData.useReSTIR = settings.enableReSTIR ? 1 : 0;
+    cameraData.maxBounces = settings.unboundedDepth ? 0 : std::max(settings.maxBounces, 1);
+    cameraData.rouletteMinDepth = std::max(settings.rouletteMinDepth, 0);
+    cameraData.renderScale = appliedRenderScale;
+    cameraData.fireflyMode = static_cast<int>(settings.fireflyMode);
+    cameraData.fireflyClampFactor = std::max(settings.fireflyClampFactor, 1.0f);
+    cameraData.regularizationStrength = std::max(settings.regularizationStrength, 0.0f);
+    cameraData.collectRayStatistics = rayStatisticsEnabled ? 1 : 0;
+    cameraData.compensatedAccumulation = isCompensatedAccumulationActive() ? 1 : 0;
+    cameraData.pathSpaceFiltering = settings.pathSpaceFiltering ? 1 : 0;
+    cameraData.pathSpaceCellSize = std::max(settings.pathSpaceCellSize, 0.001f);
+    cameraData.radianceCache = settings.radianceCache ? 1 : 0;
+    cameraData.radianceCacheBounce = std::clamp(settings.radianceCacheBounce, 1, 2);
+    cameraData.radianceCacheUpdateRate = std::clamp(settings.radianceCacheUpdateRate, 0.0f, 1.0f);
+    // 16 帧一个周期的 Halton(2, 3) 抖动，上采样 pass 据此知道每个低分辨率样本落在哪个全分辨率像素
+    uint32_t jitterIndex = (cameraData.frameCounter % 16) + 1;
+    cameraData.pixelJitter = glm::vec2(halton(jitterIndex, 2), halton(jitterIndex, 3));
+    lastViewProj = viewProj;
+    lastViewProjExtent = swapChainExtent;
+
+    if (!(settings == lastSettings))
+    {
+        // 渲染设置变化后之前的累积结果不再有效
+        resetTotalSampleCount();
+        if (isPathSpaceCacheInvalidated(settings, lastSettings))
+        {
+            requestPathSpaceCacheReset();
+        }
+        lastSettings = settings;
+    }
 
     if (cameraData.invViewProj != lastInvViewProj)
     {
-        // 摄像机参数发生变化，重置采样计数
-        totalSampleCount = 0;
-        framesToForceZero = maxFramesInFlight;
+        // 摄像机参数发生变化，重置采样计数；时域历史保留，由上采样 pass 重投影
+        resetAccumulation();
 
         lastInvViewProj = cameraData.invViewProj;
     }
 
+    // frame 为之前已累积的样本数，每帧 SPP 可变时累积权重仍然正确
+    uint32_t samples = sampleBudgetSettings.enabled ? samplesPerPixel : 1;
     if (framesToForceZero > 0)
     {
         cameraData.frame = 0;
         framesToForceZero--; // 消耗一个“强制为零”的帧机会
     }
+    else if (converged)
+    {
+        cameraData.frame = totalSampleCount; // 已收敛，本帧不派发
+    }
     else
     {
-        cameraData.frame = totalSampleCount++;
+        cameraData.frame = totalSampleCount;
+        totalSampleCount += samples;
     }
+    historyDiscarded = historyDiscardPending;
+    historyDiscardPending = false;
+    cameraData.samplesPerPixel = samples;
+    cameraData.noiseTarget = convergenceSettings.noiseTarget;
+    pathStatisticsSampleCounts[currentFrame] = converged ? 0 : cameraData.frame + samples;
+    dispatchSamplesPerPixel[currentFrame] = samples;
 
     memcpy(cameraDataBuffersMapped[currentFrame], &cameraData, sizeof(CameraData));
-}
\ No newline at end of file
+    currentCameraData = cameraData;
+}
+
+void PathTracingResourceManager::createPathStatisticsBuffers()
+{
+    VkDeviceSize bufferSize = sizeof(PathStatistics);
+
+    pathStatisticsBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    pathStatisticsBufferMemory.resize(MAX_FRAMES_IN_FLIGHT);
+    pathStatisticsBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+    pathStatisticsSampleCounts.assign(MAX_FRAMES_IN_FLIGHT, 0);
+    dispatchSamplesPerPixel.assign(MAX_FRAMES_IN_FLIGHT, 1);
+
+    for (size_t i = 0; i < pathStatisticsBuffers.size(); i++)
+    {
+        VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+        vulkanUtils.createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                 pathStatisticsBuffers[i], pathStatisticsBufferMemory[i]);
+        vkMapMemory(device, pathStatisticsBufferMemory[i], 0, bufferSize, 0, &pathStatisticsBuffersMapped[i]);
+        memset(pathStatisticsBuffersMapped[i], 0, sizeof(PathStatistics));
+    }
+}
+
+void PathTracingResourceManager::createTileBuffers()
+{
+    constexpr uint32_t minTileSize = 16;
+    maxTileCount = ((outPutExtent.width + minTileSize - 1) / minTileSize) *
+                   ((outPutExtent.height + minTileSize - 1) / minTileSize);
+    // 计数器最多与 tile 一样多 (每次 dispatch 至少一个 tile)
+    VkDeviceSize queueSize = sizeof(TileQueueHeader) + sizeof(uint32_t) * 2 * maxTileCount;
+
+    tileQueueBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    tileQueueBufferMemory.resize(MAX_FRAMES_IN_FLIGHT);
+    tileQueueBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        vulkanUtils.createBuffer(device, physicalDevice, queueSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                 tileQueueBuffers[i], tileQueueBufferMemory[i]);
+        vkMapMemory(device, tileQueueBufferMemory[i], 0, queueSize, 0, &tileQueueBuffersMapped[i]);
+        memset(tileQueueBuffersMapped[i], 0, queueSize);
+    }
+}
+
+void PathTracingResourceManager::destroyTileBuffers()
+{
+    for (size_t i = 0; i < tileQueueBuffers.size(); i++)
+    {
+        vkDestroyBuffer(device, tileQueueBuffers[i], nullptr);
+        vkFreeMemory(device, tileQueueBufferMemory[i], nullptr);
+    }
+    tileQueueBuffers.clear();
+    tileQueueBufferMemory.clear();
+    tileQueueBuffersMapped.clear();
+}
+
+void PathTracingResourceManager::updateTileQueue(uint32_t currentFrame)
+{
+    // tile 边长取 16 的整数倍，与着色器的工作组大小对齐
+    tileSize = static_cast<uint32_t>(std::clamp(tileDispatchSettings.tileSize, 16, 256)) / 16 * 16;
+    uint32_t tilesX = (outPutExtent.width + tileSize - 1) / tileSize;
+    uint32_t tilesY = (outPutExtent.height + tileSize - 1) / tileSize;
+    tileCount = tilesX * tilesY;
+    tilesPerDispatch = std::clamp(static_cast<uint32_t>(std::max(tileDispatchSettings.tilesPerDispatch, 1)), 1u,
+                                  tileCount);
+    uint32_t chunkCount = (tileCount + tilesPerDispatch - 1) / tilesPerDispatch;
+
+    tileOrder.resize(tileCount);
+    // 按行优先顺序排列：同一帧内所有 tile 的样本数相同，顺序只影响缓存局部性
+    std::iota(tileOrder.begin(), tileOrder.end(), 0u);
+
+    TileQueueHeader header{tileSize, tilesX, tileCount, chunkCount};
+    auto* queue = static_cast<uint8_t*>(tileQueueBuffersMapped[currentFrame]);
+    memcpy(queue, &header, sizeof(TileQueueHeader));
+    auto* tileData = reinterpret_cast<uint32_t*>(queue + sizeof(TileQueueHeader));
+    memset(tileData, 0, sizeof(uint32_t) * chunkCount); // 原子计数器清零
+    memcpy(tileData + chunkCount, tileOrder.data(), sizeof(uint32_t) * tileCount);
+}
+
+void PathTracingResourceManager::collectPathStatistics(uint32_t currentFrame)
+{
+    // fence 已保证该帧的 GPU 工作完成，这里直接读取映射内存，不会阻塞
+    PathStatistics statistics;
+    memcpy(&statistics, pathStatisticsBuffersMapped[currentFrame], sizeof(PathStatistics));
+    if (statistics.pathCount > 0)
+    {
+        averagePathLength = static_cast<float>(statistics.totalPathLength) / statistics.pathCount;
+    }
+    // 收敛后不再派发，保留最后一次有效的统计
+    if (statistics.primaryRays > 0)
+    {
+        rayStatistics.primaryRays = statistics.primaryRays;
+        rayStatistics.bounceRays = statistics.bounceRays;
+        rayStatistics.shadowRays = statistics.shadowRays;
+        rayStatistics.nodeVisits = statistics.nodeVisits;
+        rayStatistics.triangleTests = statistics.triangleTests;
+        rayStatistics.dispatchMilliseconds = -1.0f; // 由 updateSampleBudget 填入同一帧的耗时
+    }
+    memset(pathStatisticsBuffersMapped[currentFrame], 0, sizeof(PathStatistics));
+
+    if (!(convergenceSettings == lastConvergenceSettings))
+    {
+        // 判定条件变化后重新评估，但保留已有的累积结果
+        converged = false;
+        lastConvergenceSettings = convergenceSettings;
+    }
+    if (!convergenceSettings.stopWhenConverged || converged)
+    {
+        return;
+    }
+
+    if (statistics.measuredPixelCount > 0 &&
+        pathStatisticsSampleCounts[currentFrame] >= MIN_SAMPLES_FOR_CONVERGENCE)
+    {
+        convergedPixelRatio = static_cast<float>(statistics.convergedPixelCount) / statistics.measuredPixelCount;
+        converged = convergedPixelRatio >= convergenceSettings.convergedFraction;
+    }
+    if (convergenceSettings.maxSamples > 0 && totalSampleCount >= static_cast<uint32_t>(convergenceSettings.maxSamples))
+    {
+        converged = true;
+    }
+}
+
+void PathTracingResourceManager::updateSampleBudget(uint32_t currentFrame, float dispatchMilliseconds)
+{
+    if (!sampleBudgetSettings.enabled)
+    {
+        samplesPerPixel = 1;
+    }
+    if (dispatchMilliseconds <= 0.0f)
+    {
+        return;
+    }
+    this->dispatchMilliseconds = dispatchMilliseconds;
+    if (rayStatistics.dispatchMilliseconds < 0.0f)
+    {
+        rayStatistics.dispatchMilliseconds = dispatchMilliseconds;
+    }
+    if (!sampleBudgetSettings.enabled)
+    {
+        return;
+    }
+
+    // 按单样本耗时估算能放进预算的 SPP，每次最多翻倍或减半，避免测量抖动引起振荡
+    float millisecondsPerSample = dispatchMilliseconds / std::max(dispatchSamplesPerPixel[currentFrame], 1u);
+    float idealSamples = sampleBudgetSettings.targetMilliseconds / millisecondsPerSample;
+    idealSamples = std::clamp(idealSamples, samplesPerPixel * 0.5f, samplesPerPixel * 2.0f);
+    uint32_t maxSamples = static_cast<uint32_t>(std::max(sampleBudgetSettings.maxSamplesPerFrame, 1));
+    samplesPerPixel = std::clamp(static_cast<uint32_t>(idealSamples), 1u, maxSamples);
+}
+
+double PathTracingResourceManager::getRaysPerSecond() const
+{
+    if (rayStatistics.dispatchMilliseconds <= 0.0f)
+    {
+        return 0.0;
+    }
+    uint64_t rays = rayStatistics.primaryRays + rayStatistics.bounceRays + rayStatistics.shadowRays;
+    return static_cast<double>(rays) / (rayStatistics.dispatchMilliseconds * 1e-3);
+}
+
+void PathTracingResourceManager::logRayStatistics() const
+{
+    const RayStatistics& stats = rayStatistics;
+    uint64_t rays = stats.primaryRays + stats.bounceRays + stats.shadowRays;
+    if (rays == 0)
+    {
+        std::cout << "Ray statistics: no data (enable ray statistics first)" << std::endl;
+        return;
+    }
+    std::cout << "Ray statistics: " << getRaysPerSecond() * 1e-6 << " Mrays/s, "
+              << stats.dispatchMilliseconds << " ms, primary " << stats.primaryRays << ", bounce " << stats.bounceRays
+              << ", shadow " << stats.shadowRays << ", avg bounces "
+              << static_cast<double>(stats.bounceRays) / std::max<uint64_t>(stats.primaryRays, 1)
+              << ", nodes/ray " << static_cast<double>(stats.nodeVisits) / rays << ", tris/ray "
+              << static_cast<double>(stats.triangleTests) / rays << std::endl;
+}
+
+void PathTracingResourceManager::logStorageFootprint() const
+{
+    uint32_t imageCount = static_cast<uint32_t>(storageImages.size());
+    VkExtent2D extent4K = {3840, 2160};
+    constexpr double megabyte = 1024.0 * 1024.0;
+    uint64_t current = estimateStorageImageBytes(storagePrecision, sampleImageFormat, outPutExtent, viewportExtent,
+                                                 imageCount);
+    uint64_t current4K = estimateStorageImageBytes(storagePrecision, sampleImageFormat, extent4K, extent4K, imageCount);
+    uint64_t full4K = estimateStorageImageBytes(StoragePrecision::Full, VK_FORMAT_R32G32B32A32_SFLOAT, extent4K,
+                                                extent4K, imageCount);
+    std::cout << "Path tracing image storage (" << (storagePrecision == StoragePrecision::Half ? "half" : "full")
+              << " precision, " << imageCount << " swapchain images): " << current / megabyte << " MB, at 4K "
+              << current4K / megabyte << " MB, saved " << (full4K - current4K) / megabyte << " MB" << std::endl;
+}
+
+void PathTracingResourceManager::resetTotalSampleCount()
+{
+    resetAccumulation();
+    historyDiscardPending = true;
+}
+
+void PathTracingResourceManager::resetAccumulation()
+{
+    totalSampleCount = 0;
+    framesToForceZero = maxFramesInFlight;
+    // 在途的统计来自重置前的累积结果，不能用于收敛判定
+    converged = false;
+    convergedPixelRatio = 0.0f;
+    std::fill(pathStatisticsSampleCounts.begin(), pathStatisticsSampleCounts.end(), 0);
+}
+
+void PathTracingResourceManager::createReservoirBuffers()
+{
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+    VkDeviceSize pixelCount = static_cast<VkDeviceSize>(outPutExtent.width) * outPutExtent.height;
+    VkDeviceSize bufferSize = std::max<VkDeviceSize>(sizeof(Reservoir) * pixelCount, sizeof(Reservoir));
+
+    vulkanUtils.createBuffer(device, physicalDevice, bufferSize,
+                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, reservoirBuffer, reservoirBufferMemory);
+    vulkanUtils.createBuffer(device, physicalDevice, bufferSize,
+                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, intermediateReservoirBuffer,
+                             intermediateReservoirBufferMemory);
+
+    // 清零，保证第一帧的历史蓄水池 M = 0
+    VkCommandBuffer commandBuffer = commandManager->beginSingleTimeCommands();
+    vkCmdFillBuffer(commandBuffer, reservoirBuffer, 0, VK_WHOLE_SIZE, 0);
+    vkCmdFillBuffer(commandBuffer, intermediateReservoirBuffer, 0, VK_WHOLE_SIZE, 0);
+    commandManager->endSingleTimeCommands(commandBuffer);
+}
+
+uint32_t PathTracingResourceManager::getRequestedPathSpaceCacheCellCount() const
+{
+    return 1u << std::clamp(settings.pathSpaceCacheSizeLog2, MIN_PATH_SPACE_CACHE_SIZE_LOG2,
+                            MAX_PATH_SPACE_CACHE_SIZE_LOG2);
+}
+
+void PathTracingResourceManager::recreatePathSpaceCache()
+{
+    vkDeviceWaitIdle(device);
+    destroyPathSpaceCacheBuffer();
+    createPathSpaceCacheBuffer();
+    pathSpaceCacheResetPending = false; // 新的缓冲区已清零
+    for (auto observer : pathSpaceCacheRecreateObservers)
+    {
+        observer->onPathSpaceCacheRecreated();
+    }
+}
+
+void PathTracingResourceManager::createPathSpaceCacheBuffer()
+{
+    pathSpaceCacheCellCount = getRequestedPathSpaceCacheCellCount();
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+    vulkanUtils.createBuffer(device, physicalDevice, sizeof(PathSpaceCacheCell) * pathSpaceCacheCellCount,
+                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pathSpaceCacheBuffer, pathSpaceCacheBufferMemory);
+
+    // key 为 0 表示空槽
+    VkCommandBuffer commandBuffer = commandManager->beginSingleTimeCommands();
+    vkCmdFillBuffer(commandBuffer, pathSpaceCacheBuffer, 0, VK_WHOLE_SIZE, 0);
+    commandManager->endSingleTimeCommands(commandBuffer);
+}
+
+void PathTracingResourceManager::destroyPathSpaceCacheBuffer()
+{
+    vkDestroyBuffer(device, pathSpaceCacheBuffer, nullptr);
+    vkFreeMemory(device, pathSpaceCacheBufferMemory, nullptr);
+}
+
+void PathTracingResourceManager::createAccumulationSumImages()
+{
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+    VkFormat format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    vulkanUtils.createImage(device, physicalDevice, outPutExtent.width, outPutExtent.height, format,
+                            VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                            accumulationSumImage, accumulationSumImageMemory);
+    vulkanUtils.createImage(device, physicalDevice, outPutExtent.width, outPutExtent.height, format,
+                            VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                            accumulationCompensationImage, accumulationCompensationImageMemory);
+    vulkanUtils.createImage(device, physicalDevice, outPutExtent.width, outPutExtent.height, format,
+                            VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                            accumulationAlbedoSumImage, accumulationAlbedoSumImageMemory);
+    accumulationSumImageView =
+        vulkanUtils.createImageView(device, accumulationSumImage, format, VK_IMAGE_ASPECT_COLOR_BIT);
+    accumulationCompensationImageView =
+        vulkanUtils.createImageView(device, accumulationCompensationImage, format, VK_IMAGE_ASPECT_COLOR_BIT);
+    accumulationAlbedoSumImageView =
+        vulkanUtils.createImageView(device, accumulationAlbedoSumImage, format, VK_IMAGE_ASPECT_COLOR_BIT);
+
+    // 这些图像只被路径追踪读写，始终保持 GENERAL 布局；frame 为 0 时着色器不读取旧内容
+    VkCommandBuffer commandBuffer = vulkanUtils.beginSingleTimeCommands(device, commandManager->getCommandPool());
+    std::array<VkImage, 3> images = {accumulationSumImage, accumulationCompensationImage, accumulationAlbedoSumImage};
+    std::array<VkImageMemoryBarrier, 3> barriers{};
+    for (size_t i = 0; i < barriers.size(); i++)
+    {
+        barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[i].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[i].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].image = images[i];
+        barriers[i].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        barriers[i].srcAccessMask = 0;
+        barriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0,
+                         nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+    vulkanUtils.endSingleTimeCommands(device, commandManager->getCommandPool(), graphicsQueue, commandBuffer);
+}
+
+void PathTracingResourceManager::destroyAccumulationSumImages()
+{
+    vkDestroyImageView(device, accumulationSumImageView, nullptr);
+    vkDestroyImage(device, accumulationSumImage, nullptr);
+    vkFreeMemory(device, accumulationSumImageMemory, nullptr);
+    vkDestroyImageView(device, accumulationCompensationImageView, nullptr);
+    vkDestroyImage(device, accumulationCompensationImage, nullptr);
+    vkFreeMemory(device, accumulationCompensationImageMemory, nullptr);
+    vkDestroyImageView(device, accumulationAlbedoSumImageView, nullptr);
+    vkDestroyImage(device, accumulationAlbedoSumImage, nullptr);
+    vkFreeMemory(device, accumulationAlbedoSumImageMemory, nullptr);
+}
+
+void PathTracingResourceManager::destroyReservoirBuffers()
+{
+    vkDestroyBuffer(device, reservoirBuffer, nullptr);
+    vkFreeMemory(device, reservoirBufferMemory, nullptr);
+    vkDestroyBuffer(device, intermediateReservoirBuffer, nullptr);
+    vkFreeMemory(device, intermediateReservoirBufferMemory, nullptr);
+}
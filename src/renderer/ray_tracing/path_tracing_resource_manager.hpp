@@ -1,6 +1,7 @@
 #pragma once
 
 #include "command_manager.hpp"
+#include "storage_precision.hpp"
 #include "swap_chain_manager.hpp"
 #include "vertex.hpp"
 #include "vertex_resource_manager.hpp"
@@ -13,6 +14,7 @@ struct Triangle
     alignas(16) glm::vec3 n0, n1, n2; // 三角形的三个顶点法线
     alignas(16) glm::vec3 normal;     // 三角形的法线
     alignas(4) uint32_t materialID;   // 三角形的材质 ID
+    alignas(8) glm::vec2 uv0, uv1, uv2; // 三角形的三个顶点纹理坐标
 };
 
 struct EmissiveTriangle
@@ -20,11 +22,156 @@ struct EmissiveTriangle
     alignas(16) uint32_t triangleIndex; // 三角形索引
 };
 
+// 萤火虫处理方式，数值与 shader 中的 FIREFLY_* 一致
+enum class FireflyMode
+{
+    Unbiased = 0,      // 不截断，结果可与参考图对比
+    Regularize = 1,    // 路径正则化：粗糙反弹之后提高后续顶点的粗糙度
+    RelativeClamp = 2, // 单个样本亮度不超过累积均值的若干倍
+};
+
+// 路径追踪的可调参数，由 ImGui 修改，每帧写入 CameraData
+struct PathTracingSettings
+{
+    bool enableReSTIR = false;   // 使用 ReSTIR DI 代替均匀选择光源的 NEE
+    bool unboundedDepth = false; // 不限制反弹次数，仅由俄罗斯轮盘赌终止路径
+    int maxBounces = 4;          // 有界模式下的最大反弹次数
+    int rouletteMinDepth = 2;    // 从第几次反弹开始俄罗斯轮盘赌
+    float renderScale = 1.0f;    // 路径追踪分辨率相对视口的比例，小于 1 时由时域上采样重建全分辨率
+    FireflyMode fireflyMode = FireflyMode::RelativeClamp;
+    float fireflyClampFactor = 10.0f;    // 相对截断的倍数
+    float regularizationStrength = 1.0f; // 后续顶点粗糙度下限 = 之前最大粗糙度 * strength
+    bool compensatedAccumulation = false; // 以 Kahan 补偿求和保存样本和，长时间离线渲染不受 float 精度影响
+    bool pathSpaceFiltering = false;      // 主顶点的间接光取自次级顶点所在哈希格子的跨帧均值 (有偏)
+    float pathSpaceCellSize = 0.02f;      // 哈希格子边长相对到相机距离的比例
+    bool radianceCache = false;           // 缓存顶点命中已学习的格子时直接取缓存值并终止路径
+    int radianceCacheBounce = 1;          // 缓存顶点：第 1 或第 2 次反弹之后
+    float radianceCacheUpdateRate = 0.1f; // 命中缓存时仍完整追踪、用于更新缓存的路径比例
+    int pathSpaceCacheSizeLog2 = 18;      // 哈希表槽位数的 log2，修改后重新创建缓存
+    // 输出、上采样与降噪图像的存储精度，修改后重新创建这些图像并重新编译相关着色器
+    StoragePrecision storagePrecision = StoragePrecision::Full;
+
+    bool operator==(const PathTracingSettings&) const = default;
+};
+
+// 收敛判定参数，修改后不会清空累积结果
+struct ConvergenceSettings
+{
+    bool stopWhenConverged = true;   // 收敛后停止派发路径追踪，直接显示缓存的降噪结果
+    float noiseTarget = 0.01f;       // 像素均值的相对标准误差阈值
+    float convergedFraction = 0.99f; // 达到阈值的像素比例
+    int maxSamples = 4096;           // 采样预算，0 表示不限制
+
+    bool operator==(const ConvergenceSettings&) const = default;
+};
+
+// 帧时间预算：根据时间戳测得的路径追踪耗时调整每帧 SPP，累积权重由 CameraData::frame (已累积样本数) 保证正确
+struct SampleBudgetSettings
+{
+    bool enabled = false;
+    float targetMilliseconds = 16.0f; // 路径追踪 dispatch 的目标耗时
+    int maxSamplesPerFrame = 64;      // 单次 dispatch 的 SPP 上限，避免 GPU 超时
+};
+
 struct CameraData
 {
-    glm::mat4 invViewProj; // 逆投影矩阵
-    glm::vec3 cameraPos;   // 摄像机位置
-    int frame;             // 当前帧编号
+    glm::mat4 invViewProj;  // 逆投影矩阵
+    glm::vec3 cameraPos;    // 摄像机位置
+    int frame;              // 之前已累积的样本数
+    glm::mat4 prevViewProj; // 上一帧的视图投影矩阵，用于时域重投影
+    uint32_t frameCounter;  // 单调递增的帧计数，不随累积重置
+    int useReSTIR;          // 是否使用 ReSTIR DI
+    int maxBounces;         // 最大反弹次数，0 表示无上限
+    int rouletteMinDepth;   // 俄罗斯轮盘赌起始深度
+    glm::vec2 pixelJitter;  // 降分辨率时所有像素共用的子像素抖动 (Halton 2,3)，[0, 1)
+    float renderScale;      // 路径追踪分辨率比例
+    float noiseTarget;      // 收敛判定的相对标准误差阈值
+    int samplesPerPixel;    // 本帧每像素采样数
+    int fireflyMode;        // FireflyMode
+    float fireflyClampFactor;
+    float regularizationStrength;
+    int collectRayStatistics; // 是否归约光线统计
+    int compensatedAccumulation; // 是否使用补偿求和累积
+    int pathSpaceFiltering;      // 是否使用路径空间滤波
+    float pathSpaceCellSize;     // 哈希格子的相对边长
+    int radianceCache;           // 是否使用辐亮度缓存终止路径
+    int radianceCacheBounce;     // 缓存顶点的反弹次数
+    float radianceCacheUpdateRate; // 训练路径比例
+};
+
+// 路径追踪内核，两者共用 tile 队列与描述符
+enum class PathTracingKernel
+{
+    TiledWorkgroups = 0,   // 每个工作组领取整个 tile，一个线程负责一个像素
+    PersistentThreads = 1, // 每个子组的空闲 lane 按像素领取工作，路径终止后立即补充 (需要子组 ballot)
+};
+
+// 分块派发：路径追踪按 tile 拆成多次短 dispatch，常驻工作组通过原子计数器从队列中取 tile
+struct TileDispatchSettings
+{
+    PathTracingKernel kernel = PathTracingKernel::TiledWorkgroups;
+    int tileSize = 32;                // tile 边长 (16 的整数倍)
+    int tilesPerDispatch = 256;       // 每次 dispatch 处理的 tile 数，越小越容易被抢占
+    int persistentWorkgroups = 128;   // 每次 dispatch 的常驻工作组数，设备能报告计算单元数时由管线改为驻留上限
+    float submitMilliseconds = 4.0f;  // 单次提交的目标耗时，按测得的耗时把一帧的 tile 段拆成多次提交
+};
+
+// tile 队列缓冲区的头部，布局与 shader 中的 TileQueue 一致 (std430)
+struct TileQueueHeader
+{
+    uint32_t tileSize;
+    uint32_t tilesX;
+    uint32_t tileCount;
+    uint32_t chunkCount; // 之后依次是 chunkCount 个原子计数器和 tileCount 个 tile 序号
+};
+
+// 路径追踪统计，着色器中按工作组归约后原子累加，CPU 在该帧的 fence 之后读取
+struct PathStatistics
+{
+    uint32_t totalPathLength;     // 所有路径追踪的射线段数之和
+    uint32_t pathCount;           // 路径条数
+    uint32_t convergedPixelCount; // 相对误差低于 noiseTarget 的像素数
+    uint32_t measuredPixelCount;  // 参与收敛统计的像素数
+    // 可选的光线统计，着色器中每个 64 位计数以 lo/hi 两个 uint 存储
+    uint64_t primaryRays;   // 相机射线
+    uint64_t bounceRays;    // 反弹射线
+    uint64_t shadowRays;    // NEE / ReSTIR 的阴影射线
+    uint64_t nodeVisits;    // BVH 节点访问次数
+    uint64_t triangleTests; // 射线-三角形求交次数
+};
+
+// 最近一次读回的光线统计，对应同一帧的 dispatch 耗时
+struct RayStatistics
+{
+    uint64_t primaryRays = 0;
+    uint64_t bounceRays = 0;
+    uint64_t shadowRays = 0;
+    uint64_t nodeVisits = 0;
+    uint64_t triangleTests = 0;
+    float dispatchMilliseconds = 0.0f;
+};
+
+// ReSTIR DI 的蓄水池，布局与 shader/reservoir.glsl 一致 (std430)
+struct Reservoir
+{
+    alignas(16) glm::vec3 lightPosition;   // 选中的光源采样点
+    float weightSum;                       // 候选权重之和
+    alignas(16) glm::vec3 lightNormal;     // 光源采样点法线
+    float sampleCount;                     // M
+    alignas(16) glm::vec3 surfacePosition; // 蓄水池所在像素的着色点，用于复用时的几何校验
+    float W;                               // 无偏贡献权重
+    alignas(16) glm::vec3 surfaceNormal;   // 着色点法线
+    uint32_t lightIndex;                   // 光源三角形索引
+};
+
+// 路径空间滤波哈希网格的一个格子，布局与 shader/path_space_hash_grid.glsl 一致 (std430)
+struct PathSpaceCacheCell
+{
+    glm::vec4 radiance;         // 出射辐亮度的跨帧均值，a 为历史样本数
+    uint32_t accumulated[4];    // 本帧累加的定点辐亮度 rgb 与样本数
+    uint32_t key;               // 量化位置与法线的哈希，0 表示空槽，0xFFFFFFFF 表示已删除 (墓碑)
+    uint32_t age;               // 连续没有新样本的帧数
+    uint32_t padding[2];
 };
 
 struct BVHNode
@@ -44,6 +191,13 @@ class PathTracingResourceReloadObserver
     virtual ~PathTracingResourceReloadObserver() = default;
 };
 
+class PathSpaceCacheRecreateObserver
+{
+  public:
+    virtual void onPathSpaceCacheRecreated() = 0; // 哈希网格缓冲区按新的大小重新创建后的回调
+    virtual ~PathSpaceCacheRecreateObserver() = default;
+};
+
 class PathTracingResourceManagerModelObserver; // 前向声明
 
 class PathTracingResourceManager
@@ -55,18 +209,174 @@ class PathTracingResourceManager
 
     void cleanup();
 
+    // 当前输出图像使用的存储精度，决定图像格式以及着色器中的格式限定符
+    StoragePrecision getStoragePrecision() const
+    {
+        return storagePrecision;
+    }
+
+    // 累积输出 (rgb 均值，a 亮度二阶矩)
+    VkFormat getOutputImageFormat() const
+    {
+        return getColorStorageFormat(storagePrecision);
+    }
+
+    // 本帧样本，不需要 alpha
+    VkFormat getSampleImageFormat() const
+    {
+        return sampleImageFormat;
+    }
+
+    // 半精度输出无法承载长期累积，总是改用 RGBA32F 的补偿求和图像
+    bool isCompensatedAccumulationActive() const
+    {
+        return settings.compensatedAccumulation || storagePrecision == StoragePrecision::Half;
+    }
+
     void updateCameraDataBuffer(uint32_t currentFrame, VkExtent2D swapChainExtent, Camera& camera);
 
+    // 读取并清零 currentFrame 的统计缓冲区，需在该帧的 fence 等待之后调用，同时更新收敛状态
+    void collectPathStatistics(uint32_t currentFrame);
+
+    // 用上一次使用 currentFrame 时测得的 dispatch 耗时更新下一帧的 SPP，dispatchMilliseconds < 0 表示没有测量
+    void updateSampleBudget(uint32_t currentFrame, float dispatchMilliseconds);
+
+    // 按上一次该帧的 tile 误差生成本帧的 tile 队列，需在该帧的 fence 等待之后、录制命令之前调用
+    void updateTileQueue(uint32_t currentFrame);
+
+    // 已收敛时不再派发路径追踪相关的 pass
+    bool isConverged() const
+    {
+        return converged;
+    }
+
+    // imageExtent 为视口尺寸，实际输出尺寸按 renderScale 缩放
     void recreatePathTracingOutputImages(VkExtent2D imageExtent);
 
+    // renderScale 被修改后需要重新创建输出图像
+    bool isRenderScaleOutdated() const
+    {
+        return settings.renderScale != appliedRenderScale;
+    }
+
+    // 存储精度被修改后需要重新创建输出图像，上采样与降噪图像也随之切换
+    bool isStoragePrecisionOutdated() const
+    {
+        return settings.storagePrecision != storagePrecision;
+    }
+
+    VkExtent2D getViewportExtent() const
+    {
+        return viewportExtent;
+    }
+
+    // 最近一次写入的相机数据，供上采样等后续 pass 使用相同的抖动和矩阵
+    const CameraData& getCurrentCameraData() const
+    {
+        return currentCameraData;
+    }
+
     void recreteTriangleData();
 
-    void resetTotalSampleCount()
+    // 设置、场景、材质或图像变化导致的重置：累积结果与时域上采样的历史都不再有效
+    void resetTotalSampleCount();
+
+    // 本帧的累积重置是否要求丢弃时域历史；相机移动引起的重置保留历史，由上采样 pass 重投影
+    bool isHistoryDiscarded() const
+    {
+        return historyDiscarded;
+    }
+
+    uint32_t getTotalSampleCount() const
+    {
+        return totalSampleCount;
+    }
+
+    PathTracingSettings& getPathTracingSettings()
+    {
+        return settings;
+    }
+
+    ConvergenceSettings& getConvergenceSettings()
+    {
+        return convergenceSettings;
+    }
+
+    float getConvergedPixelRatio() const
+    {
+        return convergedPixelRatio;
+    }
+
+    TileDispatchSettings& getTileDispatchSettings()
+    {
+        return tileDispatchSettings;
+    }
+
+    // 本帧 tile 队列中的 tile 数与每次 dispatch 的 tile 数
+    uint32_t getTileCount() const
+    {
+        return tileCount;
+    }
+
+    uint32_t getTilesPerDispatch() const
+    {
+        return tilesPerDispatch;
+    }
+
+    uint32_t getTileSize() const
+    {
+        return tileSize;
+    }
+
+    std::vector<VkBuffer> getTileQueueBuffers() const
     {
-        totalSampleCount = 0;
-        framesToForceZero = maxFramesInFlight;
+        return tileQueueBuffers;
     }
 
+    SampleBudgetSettings& getSampleBudgetSettings()
+    {
+        return sampleBudgetSettings;
+    }
+
+    uint32_t getSamplesPerPixel() const
+    {
+        return samplesPerPixel;
+    }
+
+    float getDispatchMilliseconds() const
+    {
+        return dispatchMilliseconds;
+    }
+
+    float getAveragePathLength() const
+    {
+        return averagePathLength;
+    }
+
+    // 光线统计需要额外的原子归约，默认关闭；结果在该帧的 fence 之后读回，不会阻塞
+    bool isRayStatisticsEnabled() const
+    {
+        return rayStatisticsEnabled;
+    }
+
+    void setRayStatisticsEnabled(bool enabled)
+    {
+        rayStatisticsEnabled = enabled;
+    }
+
+    const RayStatistics& getRayStatistics() const
+    {
+        return rayStatistics;
+    }
+
+    // 每秒射线数 (相机 + 反弹 + 阴影)，没有耗时测量时返回 0
+    double getRaysPerSecond() const;
+
+    void logRayStatistics() const;
+
+    // 输出路径追踪链路图像在当前视口与 4K 下的显存估计，以及相对全精度节省的量
+    void logStorageFootprint() const;
+
     std::vector<VkImage> getPathTracingOutputImages() const
     {
         return storageImages;
@@ -87,6 +397,17 @@ class PathTracingResourceManager
         return accumulationImageViews;
     }
 
+    // 主光线首次命中的累积反照率，格式与输出图像相同，供降噪前解调
+    std::vector<VkImage> getAlbedoImages() const
+    {
+        return albedoImages;
+    }
+
+    std::vector<VkImageView> getAlbedoImageViews() const
+    {
+        return albedoImageViews;
+    }
+
     VkBuffer getTriangleStorageBuffer() const
     {
         return triangleStorageBuffer;
@@ -107,9 +428,9 @@ class PathTracingResourceManager
         return outPutExtent;
     }
 
-    std::vector<VkBuffer> getMaterialUniformBuffers() const
+    std::vector<VkBuffer> getMaterialBuffers() const
     {
-        return *materialUniformBuffers;
+        return *materialBuffers;
     }
 
     const std::vector<std::string>& getShapeNames() const
@@ -122,24 +443,105 @@ class PathTracingResourceManager
         return cameraDataBuffer;
     }
 
+    std::vector<VkBuffer> getPathStatisticsBuffers() const
+    {
+        return pathStatisticsBuffers;
+    }
+
+    // 时空复用后的最终蓄水池，同时作为下一帧的历史
+    VkBuffer getReservoirBuffer() const
+    {
+        return reservoirBuffer;
+    }
+
+    // 初始候选 + 时域复用的中间结果，供空间复用读取
+    VkBuffer getIntermediateReservoirBuffer() const
+    {
+        return intermediateReservoirBuffer;
+    }
+
+    // 补偿求和累积：rgb 为颜色和、a 为亮度平方和，所有帧共用，只在写出输出图像时归一化
+    VkImageView getAccumulationSumImageView() const
+    {
+        return accumulationSumImageView;
+    }
+
+    // 与样本和对应的 Kahan 补偿项
+    VkImageView getAccumulationCompensationImageView() const
+    {
+        return accumulationCompensationImageView;
+    }
+
+    // 首次命中反照率的总和 (RGBA32F)，补偿求和累积时代替反照率图像中的均值 * 帧数
+    VkImageView getAccumulationAlbedoSumImageView() const
+    {
+        return accumulationAlbedoSumImageView;
+    }
+
+    // 所有帧共用，由路径追踪写入、解析 pass 跨帧合并
+    VkBuffer getPathSpaceCacheBuffer() const
+    {
+        return pathSpaceCacheBuffer;
+    }
+
+    uint32_t getPathSpaceCacheCellCount() const
+    {
+        return pathSpaceCacheCellCount;
+    }
+
+    // 路径空间滤波或辐亮度缓存开启时，每帧都需要解析哈希网格
+    bool isPathSpaceCacheActive() const
+    {
+        return settings.pathSpaceFiltering || settings.radianceCache;
+    }
+
+    // 缓存大小被修改后需要重新创建哈希网格
+    bool isPathSpaceCacheSizeOutdated() const
+    {
+        return getRequestedPathSpaceCacheCellCount() != pathSpaceCacheCellCount;
+    }
+
+    void recreatePathSpaceCache();
+
+    // 缓存内容失效 (模型重载、材质编辑、缓存参数变化) 后，由路径追踪管线在下一次录制时清空
+    void requestPathSpaceCacheReset()
+    {
+        pathSpaceCacheResetPending = true;
+    }
+
+    bool consumePathSpaceCacheReset()
+    {
+        bool pending = pathSpaceCacheResetPending;
+        pathSpaceCacheResetPending = false;
+        return pending;
+    }
+
     void addPathTracingResourceReloadObserver(PathTracingResourceReloadObserver* observer)
     {
         pathTracingResourceReloadObservers.push_back(observer);
     }
 
+    void addPathSpaceCacheRecreateObserver(PathSpaceCacheRecreateObserver* observer)
+    {
+        pathSpaceCacheRecreateObservers.push_back(observer);
+    }
+
   private:
     VkDevice device = VK_NULL_HANDLE;
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
     VkQueue graphicsQueue = VK_NULL_HANDLE;
     SwapChainManager* swapChainManager = nullptr;
     VkExtent2D outPutExtent;
+    VkExtent2D viewportExtent;
+    float appliedRenderScale = 1.0f;
+    CameraData currentCameraData{};
     CommandManager* commandManager = nullptr;
     VertexResourceManager* vertexResourceManager = nullptr;
 
     std::vector<Triangle> triangles;
     std::vector<EmissiveTriangle> emissiveTriangles;
     std::vector<BVHNode> bvhNodes;
-    std::vector<VkBuffer>* materialUniformBuffers;
+    std::vector<VkBuffer>* materialBuffers;
 
     VkBuffer triangleStorageBuffer;
     VkDeviceMemory triangleStorageBufferMemory;
@@ -158,10 +560,67 @@ class PathTracingResourceManager
     std::vector<VkDeviceMemory> accumulationImageMemories;
     std::vector<VkImageView> accumulationImageViews;
 
+    std::vector<VkImage> albedoImages;
+    std::vector<VkDeviceMemory> albedoImageMemories;
+    std::vector<VkImageView> albedoImageViews;
+
     std::vector<VkBuffer> cameraDataBuffer;
     std::vector<VkDeviceMemory> cameraDataBufferMemory;
     std::vector<void*> cameraDataBuffersMapped;
 
+    std::vector<VkBuffer> pathStatisticsBuffers;
+    std::vector<VkDeviceMemory> pathStatisticsBufferMemory;
+    std::vector<void*> pathStatisticsBuffersMapped;
+    float averagePathLength = 0.0f;
+    bool rayStatisticsEnabled = false;
+    RayStatistics rayStatistics;
+    // 每个统计缓冲区对应 dispatch 的累积样本数，0 表示重置前的旧数据
+    std::vector<uint32_t> pathStatisticsSampleCounts;
+
+    bool converged = false;
+    float convergedPixelRatio = 0.0f;
+    ConvergenceSettings convergenceSettings;
+    ConvergenceSettings lastConvergenceSettings;
+
+    SampleBudgetSettings sampleBudgetSettings;
+    uint32_t samplesPerPixel = 1;
+    float dispatchMilliseconds = 0.0f;
+    std::vector<uint32_t> dispatchSamplesPerPixel; // 每个 in-flight 帧派发时使用的 SPP
+
+    TileDispatchSettings tileDispatchSettings;
+    std::vector<VkBuffer> tileQueueBuffers;
+    std::vector<VkDeviceMemory> tileQueueBufferMemory;
+    std::vector<void*> tileQueueBuffersMapped;
+    std::vector<uint32_t> tileOrder;
+    uint32_t maxTileCount = 0; // 按最小 tile 边长 (16) 计算的容量
+    uint32_t tileCount = 0;
+    uint32_t tilesPerDispatch = 1;
+    uint32_t tileSize = 16;
+
+    StoragePrecision storagePrecision = StoragePrecision::Full; // 当前图像使用的精度，与 settings 不同时待重建
+    VkFormat sampleImageFormat = VK_FORMAT_R32G32B32A32_SFLOAT;
+
+    VkBuffer reservoirBuffer;
+    VkDeviceMemory reservoirBufferMemory;
+    VkBuffer intermediateReservoirBuffer;
+    VkDeviceMemory intermediateReservoirBufferMemory;
+
+    VkBuffer pathSpaceCacheBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory pathSpaceCacheBufferMemory = VK_NULL_HANDLE;
+    uint32_t pathSpaceCacheCellCount = 0;
+    bool pathSpaceCacheResetPending = false;
+    std::vector<PathSpaceCacheRecreateObserver*> pathSpaceCacheRecreateObservers;
+
+    VkImage accumulationSumImage;
+    VkDeviceMemory accumulationSumImageMemory;
+    VkImageView accumulationSumImageView;
+    VkImage accumulationCompensationImage;
+    VkDeviceMemory accumulationCompensationImageMemory;
+    VkImageView accumulationCompensationImageView;
+    VkImage accumulationAlbedoSumImage;
+    VkDeviceMemory accumulationAlbedoSumImageMemory;
+    VkImageView accumulationAlbedoSumImageView;
+
     std::unique_ptr<PathTracingResourceManagerModelObserver> pathTracingResourceManagerModelObserver;
 
     std::vector<PathTracingResourceReloadObserver*> pathTracingResourceReloadObservers;
@@ -170,8 +629,18 @@ class PathTracingResourceManager
     // 用于rebuild相关资源时双帧或多帧同步
     uint32_t framesToForceZero = 0;
     uint32_t maxFramesInFlight;
+    bool historyDiscardPending = true; // 下一次写入相机数据时生效
+    bool historyDiscarded = false;
 
     glm::mat4 lastInvViewProj;
+    glm::mat4 lastViewProj = glm::mat4(1.0f);
+    VkExtent2D lastViewProjExtent = {0, 0}; // 写入 lastViewProj 时的窗口尺寸，0 表示还没有上一帧
+    uint32_t frameCounter = 0;
+
+    PathTracingSettings settings;
+    PathTracingSettings lastSettings;
+
+    void resetAccumulation();
 
     void buildTrianglesFromMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
 
@@ -185,9 +654,22 @@ class PathTracingResourceManager
     float computeSurfaceArea(const BVHNode& node);
 
     void createTriangleStorageBuffer();
+    VkExtent2D scaleExtent(VkExtent2D extent) const;
     void createPathTracingOutputImages();
     void createAccumulationImages();
+    void createAlbedoImages();
+    VkFormat chooseSampleImageFormat() const;
     void createCameraDataBuffer();
+    void createPathStatisticsBuffers();
+    void createReservoirBuffers();
+    void destroyReservoirBuffers();
+    uint32_t getRequestedPathSpaceCacheCellCount() const;
+    void createPathSpaceCacheBuffer();
+    void destroyPathSpaceCacheBuffer();
+    void createAccumulationSumImages();
+    void destroyAccumulationSumImages();
+    void createTileBuffers();
+    void destroyTileBuffers();
 };
 
 class PathTracingResourceManagerModelObserver : public ModelReloadObserver, public MaterialIpdateObsever
@@ -214,6 +696,7 @@ class PathTracingResourceManagerModelObserver : public ModelReloadObserver, publ
         if (pathTracingResourceManager)
         {
             pathTracingResourceManager->resetTotalSampleCount();
+            pathTracingResourceManager->requestPathSpaceCacheReset(); // 缓存的辐亮度来自旧材质
         }
     }
 
@@ -0,0 +1,440 @@
+#include "restir_di_pass.hpp"
+#include "shader_includer.hpp"
+#include "vulkan_utils.hpp"
+#include <array>
+#include <shaderc/shaderc.hpp>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+void ReSTIRDIPass::init(VkDevice device, VkPhysicalDevice physicalDevice, SwapChainManager& swapChainManager,
+                        GBufferResourceManager& gbufferResourceManager,
+                        PathTracingResourceManager& pathTracingResourceManager,
+                        std::vector<VkCommandBuffer>&& commandBuffers)
+{
+    this->device = device;
+    this->physicalDevice = physicalDevice;
+    this->swapChainManager = &swapChainManager;
+    this->gbufferResourceManager = &gbufferResourceManager;
+    this->pathTracingResourceManager = &pathTracingResourceManager;
+    this->imageCount = swapChainManager.getSwapChainImages().size();
+    this->commandBuffers = std::move(commandBuffers);
+
+    restirDIPassObserver = std::make_unique<ReSTIRDIPassObserver>(this);
+    gbufferResourceManager.addGBufferResourceRecreateObserver(restirDIPassObserver.get());
+    pathTracingResourceManager.addPathTracingResourceReloadObserver(restirDIPassObserver.get());
+
+    createSampler();
+    createDescriptorSetLayouts();
+    createPipelines();
+    createDescriptorPool();
+    createDescriptorSets();
+}
+
+void ReSTIRDIPass::cleanup()
+{
+    if (temporalPipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(device, temporalPipeline, nullptr);
+        temporalPipeline = VK_NULL_HANDLE;
+    }
+    if (spatialPipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(device, spatialPipeline, nullptr);
+        spatialPipeline = VK_NULL_HANDLE;
+    }
+    if (pipelineLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        pipelineLayout = VK_NULL_HANDLE;
+    }
+    if (imageDescriptorSetLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(device, imageDescriptorSetLayout, nullptr);
+        imageDescriptorSetLayout = VK_NULL_HANDLE;
+    }
+    if (frameDescriptorSetLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(device, frameDescriptorSetLayout, nullptr);
+        frameDescriptorSetLayout = VK_NULL_HANDLE;
+    }
+    if (descriptorPool != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+    }
+    if (gbufferSampler != VK_NULL_HANDLE)
+    {
+        vkDestroySampler(device, gbufferSampler, nullptr);
+        gbufferSampler = VK_NULL_HANDLE;
+    }
+    imageDescriptorSets.clear();
+    frameDescriptorSets.clear();
+}
+
+void ReSTIRDIPass::createSampler()
+{
+    // G-buffer 按像素读取 (texelFetch)，不需要过滤
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.anisotropyEnable = VK_FALSE;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = 0.0f;
+
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &gbufferSampler) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create ReSTIR DI G-buffer sampler!");
+    }
+}
+
+void ReSTIRDIPass::createDescriptorSetLayouts()
+{
+    // set 0: gbufferPosition, gbufferNormal, gbufferDepth (sampler2D), reservoirs, intermediateReservoirs (SSBO)
+    std::array<VkDescriptorSetLayoutBinding, 5> imageBindings = {};
+    for (uint32_t i = 0; i < imageBindings.size(); ++i)
+    {
+        imageBindings[i].binding = i;
+        imageBindings[i].descriptorType =
+            i < 3 ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        imageBindings[i].descriptorCount = 1;
+        imageBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        imageBindings[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo set0LayoutInfo{};
+    set0LayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    set0LayoutInfo.bindingCount = static_cast<uint32_t>(imageBindings.size());
+    set0LayoutInfo.pBindings = imageBindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &set0LayoutInfo, nullptr, &imageDescriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create ReSTIR DI descriptor set layout for set 0!");
+    }
+
+    // set 1: triangles (SSBO), materials (SSBO), cameraData (UBO), emissiveTriangles (SSBO)
+    std::array<VkDescriptorType, 4> frameTypes = {
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+    std::array<VkDescriptorSetLayoutBinding, 4> frameBindings = {};
+    for (uint32_t i = 0; i < frameBindings.size(); ++i)
+    {
+        frameBindings[i].binding = i;
+        frameBindings[i].descriptorType = frameTypes[i];
+        frameBindings[i].descriptorCount = 1;
+        frameBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        frameBindings[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo set1LayoutInfo{};
+    set1LayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    set1LayoutInfo.bindingCount = static_cast<uint32_t>(frameBindings.size());
+    set1LayoutInfo.pBindings = frameBindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &set1LayoutInfo, nullptr, &frameDescriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create ReSTIR DI descriptor set layout for set 1!");
+    }
+}
+
+VkPipeline ReSTIRDIPass::createComputePipeline(const std::string& shaderPath)
+{
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+    std::string cs = vulkanUtils.readFileToString(shaderPath);
+    shaderc::Compiler compiler;
+    shaderc::CompileOptions options;
+    options.SetIncluder(std::make_unique<ShaderIncluder>()); // restir_di_common.glsl / reservoir.glsl
+    auto computeResult = compiler.CompileGlslToSpv(cs, shaderc_glsl_compute_shader, shaderPath.c_str(), options);
+    auto errorInfo = computeResult.GetErrorMessage();
+    if (!errorInfo.empty())
+    {
+        throw std::runtime_error("Compute shader compilation error: " + errorInfo);
+    }
+
+    std::span<const uint32_t> compute_spv = {computeResult.begin(),
+                                             size_t(computeResult.end() - computeResult.begin()) * 4};
+    VkShaderModuleCreateInfo csmoduleCreateInfo; // 准备计算着色器模块创建信息
+    csmoduleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    csmoduleCreateInfo.pNext = nullptr;
+    csmoduleCreateInfo.flags = 0;
+    csmoduleCreateInfo.codeSize = compute_spv.size(); // 计算着色器SPV数据总字节数
+    csmoduleCreateInfo.pCode = compute_spv.data();    // 计算着色器SPV数据
+
+    auto computeShaderModule = vulkanUtils.createShaderModule(device, csmoduleCreateInfo);
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = computeShaderModule;
+    pipelineInfo.stage.pName = "main";
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+    {
+        vkDestroyShaderModule(device, computeShaderModule, nullptr);
+        throw std::runtime_error("failed to create ReSTIR DI compute pipeline!");
+    }
+
+    vkDestroyShaderModule(device, computeShaderModule, nullptr);
+    return pipeline;
+}
+
+void ReSTIRDIPass::createPipelines()
+{
+    // 时域与空间两个 pass 共享同一个管线布局和描述符集
+    std::array<VkDescriptorSetLayout, 2> setLayouts = {imageDescriptorSetLayout, frameDescriptorSetLayout};
+
+    // 蓄水池尺寸 (ivec2)，与 G-buffer 尺寸不同时按比例映射
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(int32_t) * 2;
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create ReSTIR DI pipeline layout!");
+    }
+
+    temporalPipeline = createComputePipeline("../shader/restir_di_temporal.comp");
+    spatialPipeline = createComputePipeline("../shader/restir_di_spatial.comp");
+}
+
+void ReSTIRDIPass::createDescriptorPool()
+{
+    uint32_t frameCount = MAX_FRAMES_IN_FLIGHT;
+    std::array<VkDescriptorPoolSize, 3> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[0].descriptorCount = 3 * imageCount; // G-buffer position / normal / depth
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = 2 * imageCount + 3 * frameCount; // 蓄水池 + 三角形 / 材质 / 发光三角形
+    poolSizes[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[2].descriptorCount = frameCount; // 相机
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = imageCount + frameCount;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create ReSTIR DI descriptor pool!");
+    }
+}
+
+void ReSTIRDIPass::createDescriptorSets()
+{
+    std::vector<VkDescriptorSetLayout> layoutsSet0(imageCount, imageDescriptorSetLayout);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = imageCount;
+    allocInfo.pSetLayouts = layoutsSet0.data();
+
+    imageDescriptorSets.resize(imageCount);
+    if (vkAllocateDescriptorSets(device, &allocInfo, imageDescriptorSets.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate ReSTIR DI descriptor sets!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layoutsSet1(MAX_FRAMES_IN_FLIGHT, frameDescriptorSetLayout);
+    allocInfo.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
+    allocInfo.pSetLayouts = layoutsSet1.data();
+
+    frameDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    if (vkAllocateDescriptorSets(device, &allocInfo, frameDescriptorSets.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate ReSTIR DI descriptor sets!");
+    }
+
+    updateGBufferDescriptorSets();
+    updateReservoirDescriptorSets();
+    updateSceneDescriptorSets();
+}
+
+void ReSTIRDIPass::updateGBufferDescriptorSets()
+{
+    for (size_t imageIndex = 0; imageIndex < imageDescriptorSets.size(); ++imageIndex)
+    {
+        std::array<VkDescriptorImageInfo, 3> imageInfos{};
+        imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfos[0].imageView = gbufferResourceManager->getPositionAttachment(imageIndex).view;
+        imageInfos[0].sampler = gbufferSampler;
+        imageInfos[1].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfos[1].imageView = gbufferResourceManager->getNormalAttachment(imageIndex).view;
+        imageInfos[1].sampler = gbufferSampler;
+        imageInfos[2].imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        imageInfos[2].imageView = gbufferResourceManager->getDepthAttachment(imageIndex).view;
+        imageInfos[2].sampler = gbufferSampler;
+
+        std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+        for (uint32_t i = 0; i < descriptorWrites.size(); ++i)
+        {
+            descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[i].dstSet = imageDescriptorSets[imageIndex];
+            descriptorWrites[i].dstBinding = i; // 绑定点 0 / 1 / 2
+            descriptorWrites[i].dstArrayElement = 0;
+            descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            descriptorWrites[i].descriptorCount = 1;
+            descriptorWrites[i].pImageInfo = &imageInfos[i];
+        }
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
+                               nullptr);
+    }
+}
+
+void ReSTIRDIPass::updateReservoirDescriptorSets()
+{
+    for (size_t imageIndex = 0; imageIndex < imageDescriptorSets.size(); ++imageIndex)
+    {
+        std::array<VkDescriptorBufferInfo, 2> bufferInfos{};
+        bufferInfos[0].buffer = pathTracingResourceManager->getReservoirBuffer();
+        bufferInfos[0].offset = 0;
+        bufferInfos[0].range = VK_WHOLE_SIZE;
+        bufferInfos[1].buffer = pathTracingResourceManager->getIntermediateReservoirBuffer();
+        bufferInfos[1].offset = 0;
+        bufferInfos[1].range = VK_WHOLE_SIZE;
+
+        std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+        for (uint32_t i = 0; i < descriptorWrites.size(); ++i)
+        {
+            descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[i].dstSet = imageDescriptorSets[imageIndex];
+            descriptorWrites[i].dstBinding = 3 + i; // 绑定点 3 / 4
+            descriptorWrites[i].dstArrayElement = 0;
+            descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[i].descriptorCount = 1;
+            descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+        }
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
+                               nullptr);
+    }
+}
+
+void ReSTIRDIPass::updateSceneDescriptorSets()
+{
+    for (size_t i = 0; i < frameDescriptorSets.size(); ++i)
+    {
+        std::array<VkDescriptorBufferInfo, 4> bufferInfos{};
+        bufferInfos[0].buffer = pathTracingResourceManager->getTriangleStorageBuffer();
+        bufferInfos[0].offset = 0;
+        bufferInfos[0].range = VK_WHOLE_SIZE;
+        bufferInfos[1].buffer = pathTracingResourceManager->getMaterialBuffers()[i];
+        bufferInfos[1].offset = 0;
+        bufferInfos[1].range = VK_WHOLE_SIZE;
+        bufferInfos[2].buffer = pathTracingResourceManager->getCameraDataBuffer()[i];
+        bufferInfos[2].offset = 0;
+        bufferInfos[2].range = sizeof(CameraData);
+        bufferInfos[3].buffer = pathTracingResourceManager->getEmissiveTrianglesBuffer();
+        bufferInfos[3].offset = 0;
+        bufferInfos[3].range = VK_WHOLE_SIZE;
+
+        std::array<VkDescriptorType, 4> types = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                                 VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+        std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
+        for (uint32_t binding = 0; binding < descriptorWrites.size(); ++binding)
+        {
+            descriptorWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[binding].dstSet = frameDescriptorSets[i];
+            descriptorWrites[binding].dstBinding = binding;
+            descriptorWrites[binding].dstArrayElement = 0;
+            descriptorWrites[binding].descriptorType = types[binding];
+            descriptorWrites[binding].descriptorCount = 1;
+            descriptorWrites[binding].pBufferInfo = &bufferInfos[binding];
+        }
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
+                               nullptr);
+    }
+}
+
+VkCommandBuffer ReSTIRDIPass::recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex)
+{
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+    VkCommandBuffer commandBuffer = commandBuffers[frameIndex];
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to begin recording command buffer!");
+    }
+
+    // 蓄水池与路径追踪输出同尺寸，G-buffer 在着色器中按比例采样
+    VkExtent2D extent = pathTracingResourceManager->getOutputExtent();
+
+    if (pathTracingResourceManager->getPathTracingSettings().enableReSTIR)
+    {
+        // 等待 G-buffer 写入完成，以及上一帧路径追踪对蓄水池的读取
+        VkMemoryBarrier inputBarrier{};
+        inputBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        inputBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                     VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT |
+                                     VK_ACCESS_SHADER_WRITE_BIT;
+        inputBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                                 VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &inputBarrier, 0, nullptr, 0, nullptr);
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+                                0, // Set 0
+                                1, &imageDescriptorSets[imageIndex], 0, nullptr);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+                                1, // Set 1
+                                1, &frameDescriptorSets[frameIndex], 0, nullptr);
+
+        std::array<int32_t, 2> reservoirExtent = {static_cast<int32_t>(extent.width),
+                                                  static_cast<int32_t>(extent.height)};
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                           sizeof(int32_t) * reservoirExtent.size(), reservoirExtent.data());
+
+        uint32_t localSizeX = 16; // 计算着色器中定义的工作组大小
+        uint32_t localSizeY = 16; // 计算着色器中定义的工作组大小
+        uint32_t groupCountX = (extent.width + localSizeX - 1) / localSizeX;
+        uint32_t groupCountY = (extent.height + localSizeY - 1) / localSizeY;
+
+        // 中间蓄水池写入后才能被空间复用读取；最终蓄水池写入后才能被路径追踪读取
+        VkMemoryBarrier reservoirBarrier{};
+        reservoirBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        reservoirBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        reservoirBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, temporalPipeline);
+        vkCmdDispatch(commandBuffer, groupCountX, groupCountY, 1);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &reservoirBarrier, 0, nullptr, 0, nullptr);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, spatialPipeline);
+        vkCmdDispatch(commandBuffer, groupCountX, groupCountY, 1);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &reservoirBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+
+    return commandBuffer;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "gbuffer_resource_manager.hpp"
+#include "path_tracing_resource_manager.hpp"
+#include "swap_chain_manager.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+class ReSTIRDIPassObserver;
+
+// ReSTIR DI：基于 G-buffer 的主可见点做光源重采样 (时域复用 + 空间复用)，
+// 结果写入 PathTracingResourceManager 的蓄水池，由路径追踪着色器在第一次反弹时使用
+class ReSTIRDIPass
+{
+  public:
+    void init(VkDevice device, VkPhysicalDevice physicalDevice, SwapChainManager& swapChainManager,
+              GBufferResourceManager& gbufferResourceManager, PathTracingResourceManager& pathTracingResourceManager,
+              std::vector<VkCommandBuffer>&& commandBuffers);
+    void cleanup();
+
+    VkCommandBuffer recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex);
+
+    void updateGBufferDescriptorSets();
+
+    void updateReservoirDescriptorSets();
+
+    void updateSceneDescriptorSets();
+
+  private:
+    VkDevice device;
+    VkPhysicalDevice physicalDevice;
+    SwapChainManager* swapChainManager = nullptr;
+
+    GBufferResourceManager* gbufferResourceManager = nullptr;
+    PathTracingResourceManager* pathTracingResourceManager = nullptr;
+    uint32_t imageCount;
+
+    std::vector<VkCommandBuffer> commandBuffers;
+
+    VkPipeline temporalPipeline = VK_NULL_HANDLE;
+    VkPipeline spatialPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+
+    VkSampler gbufferSampler = VK_NULL_HANDLE;
+
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+
+    // 与 Swapchain 图像数量一致：G-buffer 与蓄水池
+    VkDescriptorSetLayout imageDescriptorSetLayout = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> imageDescriptorSets;
+
+    // 与 MAX_FRAMES_IN_FLIGHT 一致：三角形、材质、相机、发光三角形
+    VkDescriptorSetLayout frameDescriptorSetLayout = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> frameDescriptorSets;
+
+    std::unique_ptr<ReSTIRDIPassObserver> restirDIPassObserver;
+
+    VkPipeline createComputePipeline(const std::string& shaderPath);
+    void createPipelines();
+    void createSampler();
+    void createDescriptorSetLayouts();
+    void createDescriptorPool();
+    void createDescriptorSets();
+};
+
+class ReSTIRDIPassObserver : public GBufferResourceRecreateObserver, public PathTracingResourceReloadObserver
+{
+  public:
+    ReSTIRDIPassObserver(ReSTIRDIPass* restirDIPass) : restirDIPass(restirDIPass)
+    {
+    }
+
+    void onGBufferRecreated() override
+    {
+        if (restirDIPass)
+        {
+            restirDIPass->updateGBufferDescriptorSets();
+        }
+    }
+
+    void onPathTracingOutputImagesRecreated() override
+    {
+        // 蓄水池随输出图像尺寸一起重建
+        if (restirDIPass)
+        {
+            restirDIPass->updateReservoirDescriptorSets();
+        }
+    }
+
+    void onModelReloaded() override
+    {
+        if (restirDIPass)
+        {
+            restirDIPass->updateSceneDescriptorSets();
+        }
+    }
+
+  private:
+    ReSTIRDIPass* restirDIPass = nullptr;
+};
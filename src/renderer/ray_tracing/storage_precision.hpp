@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vulkan/vulkan.h>
+
+// 路径追踪链路中显示与降噪中间图像的存储精度；运行时切换会重新创建这些图像并重新编译用到它们的着色器
+enum class StoragePrecision
+{
+    Full = 0, // 全部 RGBA32F
+    Half = 1, // 显示与降噪中间结果用 RGBA16F，不需要 alpha 的本帧样本用 R11G11B10；长期累积的总和仍为 RGBA32F
+};
+
+// 输出、上采样与降噪图像的格式 (alpha 通道有用)
+inline VkFormat getColorStorageFormat(StoragePrecision precision)
+{
+    return precision == StoragePrecision::Half ? VK_FORMAT_R16G16B16A16_SFLOAT : VK_FORMAT_R32G32B32A32_SFLOAT;
+}
+
+inline uint32_t getStorageFormatSize(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_R32G32B32A32_SFLOAT:
+        return 16;
+    case VK_FORMAT_R16G16B16A16_SFLOAT:
+        return 8;
+    case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+// 存储图像在 GLSL 中的格式限定符，着色器在运行时编译，通过宏传入
+inline std::string getStorageFormatQualifier(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_R16G16B16A16_SFLOAT:
+        return "rgba16f";
+    case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+        return "r11f_g11f_b10f";
+    default:
+        return "rgba32f";
+    }
+}
+
+// 路径追踪链路图像的显存占用估计 (字节)，不含对齐与驱动开销
+// renderExtent 为路径追踪分辨率，viewportExtent 为上采样与降噪分辨率
+inline uint64_t estimateStorageImageBytes(StoragePrecision precision, VkFormat sampleFormat, VkExtent2D renderExtent,
+                                          VkExtent2D viewportExtent, uint32_t imageCount)
+{
+    uint64_t renderPixels = static_cast<uint64_t>(renderExtent.width) * renderExtent.height;
+    uint64_t viewportPixels = static_cast<uint64_t>(viewportExtent.width) * viewportExtent.height;
+    uint64_t colorSize = getStorageFormatSize(getColorStorageFormat(precision));
+    uint64_t sumSize = getStorageFormatSize(VK_FORMAT_R32G32B32A32_SFLOAT);
+
+    uint64_t bytes = 0;
+    bytes += renderPixels * (colorSize + getStorageFormatSize(sampleFormat)) * imageCount; // 输出与本帧样本
+    bytes += renderPixels * colorSize * imageCount;                                       // 首次命中反照率
+    bytes += renderPixels * sumSize * 3;                                                  // 颜色与反照率总和、补偿
+    bytes += viewportPixels * colorSize * (imageCount + 1);                               // 上采样输出与历史
+    bytes += viewportPixels * sizeof(float);                                              // 上采样历史的样本数
+    bytes += viewportPixels * colorSize * imageCount;                                     // 降噪输出
+    bytes += viewportPixels * colorSize * 3;                                              // 降噪中间图像 (默认两张) 与颜色历史
+    bytes += viewportPixels * sumSize * 4;                                                // SVGF 矩与位置历史
+    return bytes;
+}
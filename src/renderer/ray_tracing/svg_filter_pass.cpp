@@ -1,14 +1,17 @@
 
 #include "svg_filter_pass.hpp"
+#include "shader_includer.hpp"
 #include "vulkan_utils.hpp"
 #include <array>
 #include <shaderc/shaderc.hpp>
 #include <span>
+#include <stdexcept>
 #include <vector>
 
 void SVGFilterPass::init(VkDevice device, VkPhysicalDevice physicalDevice, SwapChainManager& swapChainManager,
                          GBufferResourceManager& gbufferResourceManager,
                          PathTracingResourceManager& pathTracingResourceManager,
+                         TemporalUpscaleResourceManager& temporalUpscaleResourceManager,
                          SVGFilterResourceManager& svgFilterResourceManager,
                          std::vector<VkCommandBuffer>&& commandBuffers)
 {
@@ -17,6 +20,7 @@ void SVGFilterPass::init(VkDevice device, VkPhysicalDevice physicalDevice, SwapC
     this->swapChainManager = &swapChainManager;
     this->gbufferResourceManager = &gbufferResourceManager;
     this->pathTracingResourceManager = &pathTracingResourceManager;
+    this->temporalUpscaleResourceManager = &temporalUpscaleResourceManager;
     this->svgFilterResourceManager = &svgFilterResourceManager;
     this->imageCount = swapChainManager.getSwapChainImages().size();
     this->commandBuffers = std::move(commandBuffers);
@@ -25,25 +29,17 @@ void SVGFilterPass::init(VkDevice device, VkPhysicalDevice physicalDevice, SwapC
     svgFilterResourceManager.addSVGFilterImageRecreateObserver(svgFilterPassObserver.get());
     gbufferResourceManager.addGBufferResourceRecreateObserver(svgFilterPassObserver.get());
     pathTracingResourceManager.addPathTracingResourceReloadObserver(svgFilterPassObserver.get());
+    temporalUpscaleResourceManager.addUpscaleImageRecreateObserver(svgFilterPassObserver.get());
 
     createDescriptorSetLayout();
-    createPipeline();
+    createPipelines();
     createDescriptorPool();
     createDescriptorSets();
 }
 
 void SVGFilterPass::cleanup()
 {
-    if (pipeline != VK_NULL_HANDLE)
-    {
-        vkDestroyPipeline(device, pipeline, nullptr);
-        pipeline = VK_NULL_HANDLE;
-    }
-    if (pipelineLayout != VK_NULL_HANDLE)
-    {
-        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-        pipelineLayout = VK_NULL_HANDLE;
-    }
+    destroyPipelines();
     if (descriptorSetLayout != VK_NULL_HANDLE)
     {
         vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
@@ -55,39 +51,28 @@ void SVGFilterPass::cleanup()
         descriptorPool = VK_NULL_HANDLE;
     }
     descriptorSets.clear();
+    dispatches.clear();
 }
 
 void SVGFilterPass::createDescriptorSetLayout()
 {
-    std::array<VkDescriptorSetLayoutBinding, 4> bindings = {};
-
-    // binding 0: pathTracedColorBuffer (sampler2D)
-    bindings[0].binding = 0;
-    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    bindings[0].descriptorCount = 1;
-    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-    bindings[0].pImmutableSamplers = nullptr;
-
-    // binding 1: gbufferNormalBuffer (sampler2D)
-    bindings[1].binding = 1;
-    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    bindings[1].descriptorCount = 1;
-    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-    bindings[1].pImmutableSamplers = nullptr;
-
-    // binding 2: gbufferDepthBuffer (sampler2D)
-    bindings[2].binding = 2;
-    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    bindings[2].descriptorCount = 1;
-    bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-    bindings[2].pImmutableSamplers = nullptr;
-
-    // binding 3: denoisedOutputImage (image2D - storage image)
-    bindings[3].binding = 3;
-    bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    bindings[3].descriptorCount = 1;
-    bindings[3].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-    bindings[3].pImmutableSamplers = nullptr;
+    std::array<VkDescriptorSetLayoutBinding, 12> bindings = {};
+
+    // 所有 stage 共用同一布局，单 dispatch 的 stage 只用到其中一部分
+    // binding 0: stage 输入, 1: G-buffer 法线, 2: G-buffer 深度, 4: G-buffer 位置, 10: 运动向量,
+    // 11: 路径追踪的首次命中反照率 (sampler2D)
+    // binding 3: 本次 dispatch 的输出, 5: 本次 dispatch 的输入 (storage image)
+    // binding 6 / 7: 上一帧 / 本帧的亮度矩, 8 / 9: 上一帧 / 本帧的位置与历史长度 (storage image)
+    for (uint32_t i = 0; i < bindings.size(); ++i)
+    {
+        bool sampled = i == 0 || i == 1 || i == 2 || i == 4 || i == 10 || i == 11;
+        bindings[i].binding = i;
+        bindings[i].descriptorType =
+            sampled ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
 
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -100,86 +85,152 @@ void SVGFilterPass::createDescriptorSetLayout()
     }
 }
 
-void SVGFilterPass::createPipeline()
+VkPipeline SVGFilterPass::createComputePipeline(const std::string& shaderPath, uint32_t sharedTileMaxStep,
+                                                const char* define)
 {
     VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
-    std::string compute_shader_code_path = "../shader/sigma_clip_denoise.comp";
-    // std::string compute_shader_code_path = "../shader/svg_filter.comp";
-
-    std::string cs = vulkanUtils.readFileToString(compute_shader_code_path);
+    std::string cs = vulkanUtils.readFileToString(shaderPath);
     shaderc::Compiler compiler;
-    // 编译顶点着色器，参数分别是着色器代码字符串，着色器类型，文件名
-    auto computeResult = compiler.CompileGlslToSpv(cs, shaderc_glsl_compute_shader, compute_shader_code_path.c_str());
-    auto errorInfo_vert = computeResult.GetErrorMessage();
-
-    if (!errorInfo_vert.empty())
+    shaderc::CompileOptions options;
+    options.SetIncluder(std::make_unique<ShaderIncluder>()); // svgf_common.glsl
+    options.AddMacroDefinition("OUTPUT_IMAGE_FORMAT",
+                               getStorageFormatQualifier(svgFilterResourceManager->getOutputImageFormat()));
+    if (sharedTileMaxStep > 0)
+    {
+        options.AddMacroDefinition("SHARED_MEMORY_TILE", std::to_string(sharedTileMaxStep));
+    }
+    if (define != nullptr)
+    {
+        options.AddMacroDefinition(define);
+    }
+    auto computeResult = compiler.CompileGlslToSpv(cs, shaderc_glsl_compute_shader, shaderPath.c_str(), options);
+    auto errorInfo = computeResult.GetErrorMessage();
+    if (!errorInfo.empty())
     {
-        throw std::runtime_error("Vertex shader compilation error: " + errorInfo_vert);
+        throw std::runtime_error("Compute shader compilation error: " + errorInfo);
     }
 
     std::span<const uint32_t> compute_spv = {computeResult.begin(),
                                              size_t(computeResult.end() - computeResult.begin()) * 4};
     VkShaderModuleCreateInfo csmoduleCreateInfo; // 准备计算着色器模块创建信息
     csmoduleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    csmoduleCreateInfo.pNext = nullptr; // 自定义数据的指针
+    csmoduleCreateInfo.pNext = nullptr;
     csmoduleCreateInfo.flags = 0;
     csmoduleCreateInfo.codeSize = compute_spv.size(); // 计算着色器SPV数据总字节数
     csmoduleCreateInfo.pCode = compute_spv.data();    // 计算着色器SPV数据
 
     auto computeShaderModule = vulkanUtils.createShaderModule(device, csmoduleCreateInfo);
 
-    // 2. 创建管线布局
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-    // pipelineLayoutInfo.pushConstantRangeCount = 0; // 如果不用 Push Constants
-
-    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
-    {
-        vkDestroyShaderModule(device, computeShaderModule, nullptr);
-        throw std::runtime_error("Failed to create SVG filter pipeline layout!");
-    }
-
-    // 3. 创建 Compute Pipeline
     VkComputePipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
     pipelineInfo.layout = pipelineLayout;
     pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
     pipelineInfo.stage.module = computeShaderModule;
-    pipelineInfo.stage.pName = "main"; // Shader 入口函数名
-    // pipelineInfo.flags = 0;
-    // pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-    // pipelineInfo.basePipelineIndex = -1;
+    pipelineInfo.stage.pName = "main";
 
+    VkPipeline pipeline = VK_NULL_HANDLE;
     if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
     {
         vkDestroyShaderModule(device, computeShaderModule, nullptr);
         throw std::runtime_error("Failed to create SVG filter compute pipeline!");
     }
 
-    // 创建完管线后，Shader Module 可以销毁
     vkDestroyShaderModule(device, computeShaderModule, nullptr);
+    return pipeline;
+}
+
+void SVGFilterPass::destroyPipelines()
+{
+    for (VkPipeline* pipeline :
+         {&temporalPipeline, &variancePipeline, &atrousPipeline, &atrousTiledPipeline, &copyPipeline,
+          &demodulatePipeline, &remodulatePipeline})
+    {
+        if (*pipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(device, *pipeline, nullptr);
+            *pipeline = VK_NULL_HANDLE;
+        }
+    }
+    for (VkPipeline& pipeline : stagePipelines)
+    {
+        if (pipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(device, pipeline, nullptr);
+            pipeline = VK_NULL_HANDLE;
+        }
+    }
+    if (pipelineLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        pipelineLayout = VK_NULL_HANDLE;
+    }
+}
+
+void SVGFilterPass::updateOutputFormat()
+{
+    if (svgFilterResourceManager->getOutputImageFormat() == pipelineOutputFormat)
+    {
+        return;
+    }
+    // 重建降噪图像前已 vkDeviceWaitIdle，旧管线不再被使用；dispatch 序列保存的是管线句柄，需要一并重建
+    destroyPipelines();
+    createPipelines();
+    buildDispatchPlan();
+}
+
+void SVGFilterPass::createPipelines()
+{
+    // 所有 stage 共享同一个管线布局和描述符集布局
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(SVGFPushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create SVG filter pipeline layout!");
+    }
+    pipelineOutputFormat = svgFilterResourceManager->getOutputImageFormat();
+
+    temporalPipeline = createComputePipeline("../shader/svgf_temporal.comp");
+    variancePipeline = createComputePipeline("../shader/svgf_variance.comp");
+    atrousPipeline = createComputePipeline("../shader/svgf_atrous.comp");
+    atrousTiledPipeline = createComputePipeline("../shader/svgf_atrous.comp", SVGF_SHARED_TILE_MAX_STEP);
+    // 全部预先编译，运行时切换降噪链不需要重新编译着色器
+    for (size_t i = 0; i < DENOISER_STAGE_INFOS.size(); ++i)
+    {
+        if (DENOISER_STAGE_INFOS[i].shaderPath != nullptr)
+        {
+            stagePipelines[i] = createComputePipeline(DENOISER_STAGE_INFOS[i].shaderPath);
+        }
+    }
+    copyPipeline = createComputePipeline("../shader/denoise_copy.comp");
+    demodulatePipeline = createComputePipeline("../shader/albedo_modulate.comp");
+    remodulatePipeline = createComputePipeline("../shader/albedo_modulate.comp", 0, "REMODULATE");
 }
 
 void SVGFilterPass::createDescriptorPool()
 {
-    uint32_t numFrames = imageCount;
+    uint32_t setCount = imageCount * 2 * MAX_DISPATCH_COUNT;
     std::array<VkDescriptorPoolSize, 2> poolSizes{};
-    // Sampler2D (Combined Image Sampler)
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[0].descriptorCount = 3 * numFrames; // 3 samplers per frame
-    // Image2D (Storage Image)
+    poolSizes[0].descriptorCount = 6 * setCount; // stage 输入 + G-buffer 法线 / 深度 / 位置 / 运动向量 + 反照率
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    poolSizes[1].descriptorCount = 1 * numFrames; // 1 storage image per frame
+    poolSizes[1].descriptorCount = 6 * setCount; // 输入输出 + 两份矩 + 两份位置
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
     poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = numFrames;
-    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT; // 可选，如果需要单独释放
+    poolInfo.maxSets = setCount;
 
     if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
     {
@@ -189,9 +240,9 @@ void SVGFilterPass::createDescriptorPool()
 
 void SVGFilterPass::createDescriptorSets()
 {
-    descriptorSets.resize(imageCount, VK_NULL_HANDLE);
+    descriptorSets.resize(imageCount * 2 * MAX_DISPATCH_COUNT, VK_NULL_HANDLE);
 
-    std::vector<VkDescriptorSetLayout> layouts(imageCount, descriptorSetLayout);
+    std::vector<VkDescriptorSetLayout> layouts(descriptorSets.size(), descriptorSetLayout);
     VkDescriptorSetAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = descriptorPool;
@@ -203,99 +254,320 @@ void SVGFilterPass::createDescriptorSets()
         throw std::runtime_error("Failed to allocate SVG filter descriptor sets!");
     }
 
-    updatePathTracedColorDescriptorSets();
+    appliedChainSettings = svgFilterResourceManager->getDenoiserChainSettings();
+    buildDispatchPlan();
+    updateStageInputDescriptorSets();
     updateGBufferDescriptorSets();
+    updateAlbedoDescriptorSets();
     updateSVGFilterDescriptorSets();
 }
 
-void SVGFilterPass::updatePathTracedColorDescriptorSets()
+VkImageView SVGFilterPass::resolveChainImage(ChainImageRef ref, size_t imageIndex) const
 {
-    for (size_t imageIndex = 0; imageIndex < descriptorSets.size(); ++imageIndex)
+    switch (ref.kind)
     {
-        VkDescriptorImageInfo pathTracedColorInfo{};
-        pathTracedColorInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        pathTracedColorInfo.imageView = pathTracingResourceManager->getPathTracingOutputImageviews()[imageIndex];
-        pathTracedColorInfo.sampler = svgFilterResourceManager->getDenoiserInputSampler();
+    case ChainImage::Upscaled:
+        return temporalUpscaleResourceManager->getUpscaledOutputImageViews()[imageIndex];
+    case ChainImage::Denoised:
+        return svgFilterResourceManager->getDenoisedOutputImageView()[imageIndex];
+    case ChainImage::ColorHistory:
+        return svgFilterResourceManager->getColorHistoryImageView();
+    default:
+        return svgFilterResourceManager->getIntermediateImageView(ref.index);
+    }
+}
 
-        VkWriteDescriptorSet descriptorWrite{};
-        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite.dstSet = descriptorSets[imageIndex];
-        descriptorWrite.dstBinding = 0; // 对应布局中的绑定点 0
-        descriptorWrite.dstArrayElement = 0;
-        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        descriptorWrite.descriptorCount = 1;
-        descriptorWrite.pImageInfo = &pathTracedColorInfo;
+void SVGFilterPass::buildDispatchPlan()
+{
+    dispatches.clear();
+
+    // 中间图像按 stage 顺序分配：stage 执行期间输入仍被占用，scratch 与输出从空闲列表中取，
+    // stage 结束后归还输入与 scratch，供后面的 stage 复用
+    uint32_t intermediateCount = 0;
+    std::vector<uint32_t> freeImages;
+    auto acquire = [&]() {
+        if (freeImages.empty())
+        {
+            return ChainImageRef{ChainImage::Intermediate, intermediateCount++};
+        }
+        ChainImageRef ref = {ChainImage::Intermediate, freeImages.back()};
+        freeImages.pop_back();
+        return ref;
+    };
+    auto release = [&](ChainImageRef ref) {
+        if (ref.kind == ChainImage::Intermediate)
+        {
+            freeImages.push_back(ref.index);
+        }
+    };
+
+    std::vector<DenoiserStageType> stages;
+    for (const DenoiserStageSettings& stage : appliedChainSettings.stages)
+    {
+        if (stage.enabled)
+        {
+            stages.push_back(stage.type);
+        }
+    }
 
-        vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+    ChainImageRef stageInput = {ChainImage::Upscaled};
+    ChainImageRef denoised = {ChainImage::Denoised};
+    if (stages.empty())
+    {
+        dispatches.push_back({copyPipeline, {}, stageInput, denoised, denoised});
+    }
+
+    // 解调后的辐照度只剩光照的噪声，纹理细节不再被当作边缘或被滤掉；最后一个 stage 改写到中间图像，再乘回反照率
+    bool albedoDemodulation = appliedChainSettings.albedoDemodulation && !stages.empty();
+    ChainImageRef chainOutput = denoised;
+    if (albedoDemodulation)
+    {
+        ChainImageRef demodulated = acquire();
+        dispatches.push_back({demodulatePipeline, {}, stageInput, demodulated, demodulated});
+        stageInput = demodulated;
+        chainOutput = acquire();
+    }
+
+    for (size_t i = 0; i < stages.size(); ++i)
+    {
+        bool lastStage = i + 1 == stages.size();
+        ChainImageRef stageOutput;
+        if (stages[i] == DenoiserStageType::SVGF)
+        {
+            ChainImageRef scratch0 = acquire();
+            ChainImageRef scratch1 = acquire();
+            stageOutput = lastStage ? chainOutput : acquire();
+            appendSVGFDispatches(stageInput, stageOutput, scratch0, scratch1);
+            release(scratch0);
+            release(scratch1);
+        }
+        else
+        {
+            stageOutput = lastStage ? chainOutput : acquire();
+            // 单 dispatch 的 stage 不读 binding 5，指向输出只为保证描述符有效
+            dispatches.push_back({stagePipelines[static_cast<size_t>(stages[i])], {}, stageInput, stageOutput,
+                                  stageOutput});
+        }
+        release(stageInput);
+        stageInput = stageOutput;
+    }
+
+    if (albedoDemodulation)
+    {
+        dispatches.push_back({remodulatePipeline, {}, chainOutput, denoised, denoised});
+    }
+
+    svgFilterResourceManager->reserveIntermediateImages(intermediateCount);
+}
+
+void SVGFilterPass::appendSVGFDispatches(ChainImageRef stageInput, ChainImageRef stageOutput,
+                                         ChainImageRef scratch0, ChainImageRef scratch1)
+{
+    // 第 k 个 dispatch 读 chain[k]、写 chain[k + 1]：
+    // 时域累积 历史 -> 1，方差估计 1 -> 0，第一次 à-trous 0 -> 历史 (下一帧的颜色历史)，
+    // 之后在 1 / 0 之间交替，最后一次写入 stage 的输出
+    ChainImageRef colorHistory = {ChainImage::ColorHistory};
+    std::array<ChainImageRef, SVGF_DISPATCH_COUNT + 1> chain{};
+    chain[0] = colorHistory;
+    chain[1] = scratch1;
+    chain[2] = scratch0;
+    chain[3] = colorHistory;
+    for (uint32_t k = 4; k < SVGF_DISPATCH_COUNT; ++k)
+    {
+        chain[k] = k % 2 == 0 ? scratch1 : scratch0;
+    }
+    chain[SVGF_DISPATCH_COUNT] = stageOutput;
+
+    for (uint32_t k = 0; k < SVGF_DISPATCH_COUNT; ++k)
+    {
+        ChainDispatch dispatch = {atrousPipeline, {}, stageInput, chain[k], chain[k + 1]};
+        if (k == 0)
+        {
+            dispatch.pipeline = temporalPipeline;
+        }
+        else if (k == 1)
+        {
+            dispatch.pipeline = variancePipeline;
+        }
+        else
+        {
+            uint32_t iteration = k - 2;
+            dispatch.pushConstants.stepSize = 1 << iteration;
+            // 核半径较小时每个像素被 25 个邻居重复读取，先读进共享内存
+            if (static_cast<uint32_t>(dispatch.pushConstants.stepSize) <= SVGF_SHARED_TILE_MAX_STEP)
+            {
+                dispatch.pipeline = atrousTiledPipeline;
+            }
+            dispatch.pushConstants.lastIteration = iteration + 1 == ATROUS_ITERATIONS ? 1 : 0;
+        }
+        dispatches.push_back(dispatch);
+    }
+}
+
+void SVGFilterPass::updateStageInputDescriptorSets()
+{
+    for (size_t imageIndex = 0; imageIndex < imageCount; ++imageIndex)
+    {
+        for (uint32_t historyIndex = 0; historyIndex < 2; ++historyIndex)
+        {
+            for (uint32_t dispatchIndex = 0; dispatchIndex < dispatches.size(); ++dispatchIndex)
+            {
+                // 上采样结果在降噪期间为 SHADER_READ_ONLY，中间图像常驻 GENERAL
+                ChainImageRef stageInput = dispatches[dispatchIndex].stageInput;
+                VkDescriptorImageInfo stageInputInfo{};
+                stageInputInfo.imageLayout = stageInput.kind == ChainImage::Upscaled
+                                                 ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+                                                 : VK_IMAGE_LAYOUT_GENERAL;
+                stageInputInfo.imageView = resolveChainImage(stageInput, imageIndex);
+                stageInputInfo.sampler = svgFilterResourceManager->getDenoiserInputSampler();
+
+                VkWriteDescriptorSet descriptorWrite{};
+                descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                descriptorWrite.dstSet = descriptorSets[getDescriptorSetIndex(imageIndex, historyIndex, dispatchIndex)];
+                descriptorWrite.dstBinding = 0; // 对应布局中的绑定点 0
+                descriptorWrite.dstArrayElement = 0;
+                descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                descriptorWrite.descriptorCount = 1;
+                descriptorWrite.pImageInfo = &stageInputInfo;
+
+                vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+            }
+        }
     }
 }
 
 void SVGFilterPass::updateGBufferDescriptorSets()
 {
-    for (size_t imageIndex = 0; imageIndex < descriptorSets.size(); ++imageIndex)
+    for (size_t setIndex = 0; setIndex < descriptorSets.size(); ++setIndex)
     {
+        size_t imageIndex = setIndex / (2 * MAX_DISPATCH_COUNT);
+
         VkDescriptorImageInfo gbufferNormalInfo{};
         gbufferNormalInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         gbufferNormalInfo.imageView = gbufferResourceManager->getNormalAttachment(imageIndex).view;
         gbufferNormalInfo.sampler = svgFilterResourceManager->getDenoiserInputSampler();
 
-        VkWriteDescriptorSet normalDescriptorWrite{};
-        normalDescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        normalDescriptorWrite.dstSet = descriptorSets[imageIndex];
-        normalDescriptorWrite.dstBinding = 1; // 对应布局中的绑定点 1
-        normalDescriptorWrite.dstArrayElement = 0;
-        normalDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        normalDescriptorWrite.descriptorCount = 1;
-        normalDescriptorWrite.pImageInfo = &gbufferNormalInfo;
-
         VkDescriptorImageInfo gbufferDepthInfo{};
         gbufferDepthInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
         gbufferDepthInfo.imageView = gbufferResourceManager->getDepthAttachment(imageIndex).view;
         gbufferDepthInfo.sampler = svgFilterResourceManager->getDenoiserInputSampler();
 
-        VkWriteDescriptorSet depthDescriptorWrite{};
-        depthDescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        depthDescriptorWrite.dstSet = descriptorSets[imageIndex];
-        depthDescriptorWrite.dstBinding = 2; // 对应布局中的绑定点 2
-        depthDescriptorWrite.dstArrayElement = 0;
-        depthDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        depthDescriptorWrite.descriptorCount = 1;
-        depthDescriptorWrite.pImageInfo = &gbufferDepthInfo;
-
-        std::array<VkWriteDescriptorSet, 2> descriptorWrites = {normalDescriptorWrite, depthDescriptorWrite};
+        VkDescriptorImageInfo gbufferPositionInfo{};
+        gbufferPositionInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        gbufferPositionInfo.imageView = gbufferResourceManager->getPositionAttachment(imageIndex).view;
+        gbufferPositionInfo.sampler = svgFilterResourceManager->getDenoiserInputSampler();
+
+        VkDescriptorImageInfo gbufferMotionInfo{};
+        gbufferMotionInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        gbufferMotionInfo.imageView = gbufferResourceManager->getMotionVectorAttachment(imageIndex).view;
+        gbufferMotionInfo.sampler = svgFilterResourceManager->getDenoiserInputSampler();
+
+        std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
+        std::array<uint32_t, 4> bindings = {1, 2, 4, 10};
+        std::array<VkDescriptorImageInfo*, 4> imageInfos = {&gbufferNormalInfo, &gbufferDepthInfo,
+                                                            &gbufferPositionInfo, &gbufferMotionInfo};
+        for (size_t i = 0; i < descriptorWrites.size(); ++i)
+        {
+            descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[i].dstSet = descriptorSets[setIndex];
+            descriptorWrites[i].dstBinding = bindings[i];
+            descriptorWrites[i].dstArrayElement = 0;
+            descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            descriptorWrites[i].descriptorCount = 1;
+            descriptorWrites[i].pImageInfo = imageInfos[i];
+        }
 
         vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
                                nullptr);
     }
 }
 
-void SVGFilterPass::updateSVGFilterDescriptorSets()
+void SVGFilterPass::updateAlbedoDescriptorSets()
 {
-    for (size_t imageIndex = 0; imageIndex < descriptorSets.size(); ++imageIndex)
+    for (size_t setIndex = 0; setIndex < descriptorSets.size(); ++setIndex)
     {
-        VkDescriptorImageInfo denoisedOutputInfo{};
-        denoisedOutputInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL; // Storage images 通常使用 GENERAL 布局
-        denoisedOutputInfo.imageView = svgFilterResourceManager->getDenoisedOutputImageView()[imageIndex];
-        // denoisedOutputInfo.sampler = VK_NULL_HANDLE; // Storage images 不需要 sampler
+        size_t imageIndex = setIndex / (2 * MAX_DISPATCH_COUNT);
+
+        // 渲染分辨率，双线性采样到降噪分辨率；路径追踪结束时已转换为 SHADER_READ_ONLY
+        VkDescriptorImageInfo albedoInfo{};
+        albedoInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        albedoInfo.imageView = pathTracingResourceManager->getAlbedoImageViews()[imageIndex];
+        albedoInfo.sampler = svgFilterResourceManager->getDenoiserInputSampler();
 
         VkWriteDescriptorSet descriptorWrite{};
         descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite.dstSet = descriptorSets[imageIndex];
-        descriptorWrite.dstBinding = 3; // 对应布局中的绑定点 3
+        descriptorWrite.dstSet = descriptorSets[setIndex];
+        descriptorWrite.dstBinding = 11;
         descriptorWrite.dstArrayElement = 0;
-        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         descriptorWrite.descriptorCount = 1;
-        descriptorWrite.pImageInfo = &denoisedOutputInfo;
+        descriptorWrite.pImageInfo = &albedoInfo;
 
         vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
     }
 }
 
+void SVGFilterPass::updateSVGFilterDescriptorSets()
+{
+    for (size_t imageIndex = 0; imageIndex < imageCount; ++imageIndex)
+    {
+        for (uint32_t historyIndex = 0; historyIndex < 2; ++historyIndex)
+        {
+            for (uint32_t dispatchIndex = 0; dispatchIndex < dispatches.size(); ++dispatchIndex)
+            {
+                const ChainDispatch& dispatch = dispatches[dispatchIndex];
+
+                // Storage images 使用 GENERAL 布局，不需要 sampler
+                std::array<VkDescriptorImageInfo, 6> imageInfos{};
+                std::array<VkImageView, 6> views = {
+                    resolveChainImage(dispatch.output, imageIndex),
+                    resolveChainImage(dispatch.input, imageIndex),
+                    svgFilterResourceManager->getMomentsImageView(historyIndex ^ 1),
+                    svgFilterResourceManager->getMomentsImageView(historyIndex),
+                    svgFilterResourceManager->getSurfaceImageView(historyIndex ^ 1),
+                    svgFilterResourceManager->getSurfaceImageView(historyIndex)};
+                std::array<uint32_t, 6> bindings = {3, 5, 6, 7, 8, 9};
+
+                std::array<VkWriteDescriptorSet, 6> descriptorWrites{};
+                for (size_t i = 0; i < descriptorWrites.size(); ++i)
+                {
+                    imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+                    imageInfos[i].imageView = views[i];
+
+                    descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                    descriptorWrites[i].dstSet =
+                        descriptorSets[getDescriptorSetIndex(imageIndex, historyIndex, dispatchIndex)];
+                    descriptorWrites[i].dstBinding = bindings[i];
+                    descriptorWrites[i].dstArrayElement = 0;
+                    descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                    descriptorWrites[i].descriptorCount = 1;
+                    descriptorWrites[i].pImageInfo = &imageInfos[i];
+                }
+
+                vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()),
+                                       descriptorWrites.data(), 0, nullptr);
+            }
+        }
+    }
+}
+
 VkCommandBuffer SVGFilterPass::recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex)
 {
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
+    // 降噪链在 UI 中被修改：等在途的帧结束后重建 dispatch 序列与描述符，SVGF 的输入变了，历史一并清空
+    const DenoiserChainSettings& chainSettings = svgFilterResourceManager->getDenoiserChainSettings();
+    if (!(chainSettings == appliedChainSettings))
+    {
+        vkDeviceWaitIdle(device);
+        appliedChainSettings = chainSettings;
+        buildDispatchPlan();
+        svgFilterResourceManager->resetHistory();
+        updateStageInputDescriptorSets();
+        updateSVGFilterDescriptorSets();
+    }
+
     VkCommandBuffer commandBuffer = commandBuffers[frameIndex];
     if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
     {
@@ -319,39 +591,52 @@ VkCommandBuffer SVGFilterPass::recordCommandBuffer(uint32_t frameIndex, uint32_t
     barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;  // 着色器读取
     barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT; // 计算着色器写入
 
-    vkCmdPipelineBarrier(commandBuffer,
-                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, // 源阶段
-                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,  // 目标阶段
-                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+    // 同时等待上采样写完输入，以及上一帧降噪对历史与中间图像的读写
+    VkMemoryBarrier memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
 
-    // 绑定 Compute Pipeline
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
-
-    // 绑定当前帧的描述符集
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1,
-                            &descriptorSets[imageIndex], 0, nullptr);
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, // 源阶段
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,                                         // 目标阶段
+                         0, 1, &memoryBarrier, 0, nullptr, 1, &barrier);
 
-    // 调度 Compute Shader
     VkExtent2D imageExtent = svgFilterResourceManager->getOutputExtent();
     uint32_t localSizeX = 16; // 计算着色器中定义的工作组大小
     uint32_t localSizeY = 16; // 计算着色器中定义的工作组大小
     uint32_t groupCountX = (imageExtent.width + localSizeX - 1) / localSizeX;
     uint32_t groupCountY = (imageExtent.height + localSizeY - 1) / localSizeY;
-    vkCmdDispatch(commandBuffer, groupCountX, groupCountY, 1);
+
+    // 每个 dispatch 的输出是下一个 dispatch 的输入
+    VkMemoryBarrier dispatchBarrier{};
+    dispatchBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    dispatchBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    dispatchBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    for (uint32_t dispatchIndex = 0; dispatchIndex < dispatches.size(); ++dispatchIndex)
+    {
+        const ChainDispatch& dispatch = dispatches[dispatchIndex];
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, dispatch.pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1,
+                                &descriptorSets[getDescriptorSetIndex(imageIndex, historyIndex, dispatchIndex)], 0,
+                                nullptr);
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(SVGFPushConstants),
+                           &dispatch.pushConstants);
+        vkCmdDispatch(commandBuffer, groupCountX, groupCountY, 1);
+
+        if (dispatchIndex + 1 < dispatches.size())
+        {
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &dispatchBarrier, 0, nullptr, 0,
+                                 nullptr);
+        }
+    }
+    historyIndex ^= 1;
 
     // 添加布局转换：从 GENERAL 到 SHADER_READ_ONLY_OPTIMAL
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
     barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = svgFilterResourceManager->getDenoisedOutputImage()[imageIndex]; // 获取图像
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-
     barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT; // 计算着色器写入
     barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;  // 着色器读取
 
@@ -366,4 +651,4 @@ VkCommandBuffer SVGFilterPass::recordCommandBuffer(uint32_t frameIndex, uint32_t
     }
 
     return commandBuffer;
-}
\ No newline at end of file
+}
@@ -1,58 +1,142 @@
 #pragma once
 
+#include "denoiser_chain.hpp"
 #include "gbuffer_resource_manager.hpp"
 #include "path_tracing_resource_manager.hpp"
 #include "svg_filter_resource_manager.hpp"
 #include "swap_chain_manager.hpp"
+#include "temporal_upscale_resource_manager.hpp"
+#include <array>
+#include <memory>
+#include <string>
 #include <vector>
 #include <vulkan/vulkan.h>
 
 class SVGFilterPassObserver;
+
+// 可重排的降噪链：按 SVGFilterResourceManager 中的 DenoiserChainSettings 依次执行启用的 stage，
+// stage 之间的结果与 SVGF 的 à-trous ping-pong 使用资源管理器中池化的中间图像，最后一个 stage 写入降噪输出
+// 开启反照率解调时，降噪链前后各多一个 dispatch：先除以路径追踪写出的首次命中反照率，滤波结束后再乘回
+// SVGF：时域累积颜色与亮度矩 -> 历史不足时估计空间方差 -> 5 次 à-trous 小波迭代，每一步是一个单独的 dispatch
 class SVGFilterPass
 {
   public:
     void init(VkDevice device, VkPhysicalDevice physicalDevice, SwapChainManager& swapChainManager,
               GBufferResourceManager& gbufferResourceManager, PathTracingResourceManager& pathTracingResourceManager,
+              TemporalUpscaleResourceManager& temporalUpscaleResourceManager,
               SVGFilterResourceManager& svgFilterResourceManager, std::vector<VkCommandBuffer>&& commandBuffers);
     void cleanup();
 
     VkCommandBuffer recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex);
 
-    void updatePathTracedColorDescriptorSets();
+    void updateStageInputDescriptorSets();
 
     void updateGBufferDescriptorSets();
 
+    void updateAlbedoDescriptorSets();
+
     void updateSVGFilterDescriptorSets();
 
+    // 降噪图像按新的存储精度重建后，重新编译带格式限定符的着色器；格式未变时不做任何事
+    void updateOutputFormat();
+
   private:
+    static constexpr uint32_t ATROUS_ITERATIONS = 5;
+    static constexpr uint32_t SVGF_DISPATCH_COUNT = ATROUS_ITERATIONS + 2; // 时域累积 + 方差估计 + à-trous
+    static_assert(SVGF_DISPATCH_COUNT == DENOISER_STAGE_INFOS[0].dispatchCount);
+    // 所有 stage 都启用时的 dispatch 数，按此分配描述符集
+    static constexpr uint32_t MAX_DISPATCH_COUNT = getMaxDenoiserDispatchCount() + 2; // + 反照率解调 / 重新调制
+
+    // 与 shader/svgf_common.glsl 中的 push_constant 块一致，其它 stage 不读取
+    struct SVGFPushConstants
+    {
+        int stepSize;
+        int lastIteration;
+    };
+
+    // dispatch 读写的颜色图像，录制前按交换链图像解析为 image view
+    enum class ChainImage
+    {
+        Upscaled,     // 上采样结果，SHADER_READ_ONLY 布局
+        Denoised,     // 降噪输出
+        ColorHistory, // SVGF 颜色历史
+        Intermediate, // 中间图像池中的第 index 张
+    };
+
+    struct ChainImageRef
+    {
+        ChainImage kind;
+        uint32_t index = 0;
+    };
+
+    // 降噪链展开后的一次 dispatch
+    struct ChainDispatch
+    {
+        VkPipeline pipeline;
+        SVGFPushConstants pushConstants;
+        ChainImageRef stageInput; // binding 0：所属 stage 的输入
+        ChainImageRef input;      // binding 5：SVGF 内部上一步的结果
+        ChainImageRef output;     // binding 3
+    };
+
     VkDevice device;
     VkPhysicalDevice physicalDevice;
     SwapChainManager* swapChainManager = nullptr;
 
     GBufferResourceManager* gbufferResourceManager = nullptr;
-    PathTracingResourceManager* pathTracingResourceManager = nullptr;
+    PathTracingResourceManager* pathTracingResourceManager = nullptr; // 首次命中反照率
+    TemporalUpscaleResourceManager* temporalUpscaleResourceManager = nullptr; // 输入为上采样后的全分辨率结果
     SVGFilterResourceManager* svgFilterResourceManager = nullptr;
     uint32_t imageCount;
 
     std::vector<VkCommandBuffer> commandBuffers;
 
-    VkPipeline pipeline;
-    VkPipelineLayout pipelineLayout;
-
-    VkDescriptorSetLayout descriptorSetLayout;
-    VkDescriptorPool descriptorPool;
+    VkPipeline temporalPipeline = VK_NULL_HANDLE;
+    VkPipeline variancePipeline = VK_NULL_HANDLE;
+    VkPipeline atrousPipeline = VK_NULL_HANDLE;
+    VkPipeline atrousTiledPipeline = VK_NULL_HANDLE; // 小步长迭代从共享内存滤波
+    // 单 dispatch 的 stage，按 DenoiserStageType 索引，SVGF 对应的一项不使用
+    std::array<VkPipeline, DENOISER_STAGE_INFOS.size()> stagePipelines{};
+    VkPipeline copyPipeline = VK_NULL_HANDLE; // 全部 stage 禁用时直接复制
+    VkPipeline demodulatePipeline = VK_NULL_HANDLE;
+    VkPipeline remodulatePipeline = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkFormat pipelineOutputFormat = VK_FORMAT_UNDEFINED; // 编译着色器时的输出格式
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    // 按 [交换链图像][矩与位置历史的读写方向][dispatch] 展开
     std::vector<VkDescriptorSet> descriptorSets;
 
+    DenoiserChainSettings appliedChainSettings; // 当前 dispatch 序列对应的设置
+    std::vector<ChainDispatch> dispatches;
+
+    uint32_t historyIndex = 0; // 本帧写入的矩与位置历史，每次录制后翻转
+
     std::unique_ptr<SVGFilterPassObserver> svgFilterPassObserver;
 
-    void createPipeline();
+    size_t getDescriptorSetIndex(size_t imageIndex, uint32_t historyIndex, uint32_t dispatchIndex) const
+    {
+        return (imageIndex * 2 + historyIndex) * MAX_DISPATCH_COUNT + dispatchIndex;
+    }
+
+    VkImageView resolveChainImage(ChainImageRef ref, size_t imageIndex) const;
+
+    VkPipeline createComputePipeline(const std::string& shaderPath, uint32_t sharedTileMaxStep = 0,
+                                     const char* define = nullptr);
+    void createPipelines();
+    void destroyPipelines();
     void createDescriptorSetLayout();
     void createDescriptorPool();
     void createDescriptorSets();
+    void buildDispatchPlan();
+    void appendSVGFDispatches(ChainImageRef stageInput, ChainImageRef stageOutput, ChainImageRef scratch0,
+                              ChainImageRef scratch1);
 };
 
 class SVGFilterPassObserver : public SVGFilterImageRecreateObserver,
                               public GBufferResourceRecreateObserver,
+                              public UpscaleImageRecreateObserver,
                               public PathTracingResourceReloadObserver
 {
   public:
@@ -64,6 +148,9 @@ class SVGFilterPassObserver : public SVGFilterImageRecreateObserver,
     {
         if (svgFilterPass)
         {
+            // 中间图像也可能是 stage 的输入
+            svgFilterPass->updateOutputFormat();
+            svgFilterPass->updateStageInputDescriptorSets();
             svgFilterPass->updateSVGFilterDescriptorSets();
         }
     }
@@ -76,11 +163,19 @@ class SVGFilterPassObserver : public SVGFilterImageRecreateObserver,
         }
     }
 
+    void onUpscaleImagesRecreated() override
+    {
+        if (svgFilterPass)
+        {
+            svgFilterPass->updateStageInputDescriptorSets();
+        }
+    }
+
     void onPathTracingOutputImagesRecreated() override
     {
         if (svgFilterPass)
         {
-            svgFilterPass->updatePathTracedColorDescriptorSets();
+            svgFilterPass->updateAlbedoDescriptorSets();
         }
     }
 
@@ -15,6 +15,7 @@ void SVGFilterResourceManager::init(VkDevice device, VkPhysicalDevice physicalDe
     this->commandManager = &commandManager;
 
     createDenoisedOutputImages();
+    createFilterImages();
     createSamplers();
 }
 
@@ -38,6 +39,7 @@ void SVGFilterResourceManager::cleanup()
     denoisedOutputImageViews.clear();
     denoisedOutputImages.clear();
     denoisedOutputImageMemories.clear();
+    destroyFilterImages();
 
     if (denoiserInputSampler != VK_NULL_HANDLE)
     {
@@ -60,6 +62,10 @@ void SVGFilterResourceManager::recreateDenoisedOutputImages(VkExtent2D imageExte
     this->imageHeight = imageExtent.height;
     createDenoisedOutputImages();
 
+    // 尺寸变化后历史无法重投影，中间图像重建即清空
+    destroyFilterImages();
+    createFilterImages();
+
     for (auto observer : svgFilterImageRecreateObservers)
     {
         observer->onSVGFilterImageRecreated(); // 通知观察者
@@ -74,7 +80,7 @@ void SVGFilterResourceManager::createDenoisedOutputImages()
 
     VulkanUtils& vulkanUtils = VulkanUtils::getInstance(); // 获取辅助类实例
 
-    VkFormat format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    VkFormat format = getOutputImageFormat();
     VkImageUsageFlags usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
     // 如果只是写入，然后直接复制到交换链，可以只有 VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT
 
@@ -94,6 +100,108 @@ void SVGFilterResourceManager::createDenoisedOutputImages()
     }
 }
 
+void SVGFilterResourceManager::createFilterImages()
+{
+    // 颜色类图像跟随存储精度；矩与位置需要完整精度
+    for (auto& intermediateImage : intermediateImages)
+    {
+        createFilterImage(getOutputImageFormat(), intermediateImage);
+    }
+    createFilterImage(getOutputImageFormat(), colorHistoryImage);
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        createFilterImage(VK_FORMAT_R32G32B32A32_SFLOAT, momentsImages[i]);
+        createFilterImage(VK_FORMAT_R32G32B32A32_SFLOAT, surfaceImages[i]);
+    }
+}
+
+void SVGFilterResourceManager::createFilterImage(VkFormat format, SVGFilterImage& filterImage)
+{
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+
+    vulkanUtils.createImage(device, physicalDevice, imageWidth, imageHeight, format, VK_IMAGE_TILING_OPTIMAL,
+                            VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, filterImage.image, filterImage.memory);
+    filterImage.view = vulkanUtils.createImageView(device, filterImage.image, format, VK_IMAGE_ASPECT_COLOR_BIT);
+
+    clearFilterImage(filterImage);
+}
+
+void SVGFilterResourceManager::clearFilterImage(SVGFilterImage& filterImage)
+{
+    // 清零 (历史长度为 0 表示没有可用历史)，之后常驻 GENERAL；旧内容直接丢弃
+    VkCommandBuffer commandBuffer = commandManager->beginSingleTimeCommands();
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = filterImage.image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                         nullptr, 0, nullptr, 1, &barrier);
+
+    VkClearColorValue clearColor = {{0.0f, 0.0f, 0.0f, 0.0f}};
+    vkCmdClearColorImage(commandBuffer, filterImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearColor, 1,
+                         &barrier.subresourceRange);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0,
+                         nullptr, 0, nullptr, 1, &barrier);
+
+    commandManager->endSingleTimeCommands(commandBuffer);
+}
+
+void SVGFilterResourceManager::reserveIntermediateImages(uint32_t count)
+{
+    while (intermediateImages.size() < count)
+    {
+        createFilterImage(getOutputImageFormat(), intermediateImages.emplace_back());
+    }
+}
+
+void SVGFilterResourceManager::resetHistory()
+{
+    clearFilterImage(colorHistoryImage);
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        clearFilterImage(momentsImages[i]);
+        clearFilterImage(surfaceImages[i]);
+    }
+}
+
+void SVGFilterResourceManager::destroyFilterImages()
+{
+    auto destroyFilterImage = [this](SVGFilterImage& filterImage) {
+        if (filterImage.image == VK_NULL_HANDLE)
+        {
+            return;
+        }
+        vkDestroyImageView(device, filterImage.view, nullptr);
+        vkDestroyImage(device, filterImage.image, nullptr);
+        vkFreeMemory(device, filterImage.memory, nullptr);
+        filterImage = SVGFilterImage{};
+    };
+
+    for (auto& intermediateImage : intermediateImages)
+    {
+        destroyFilterImage(intermediateImage);
+    }
+    destroyFilterImage(colorHistoryImage);
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        destroyFilterImage(momentsImages[i]);
+        destroyFilterImage(surfaceImages[i]);
+    }
+}
+
 void SVGFilterResourceManager::createSamplers()
 {
     VkSamplerCreateInfo samplerInfo{};
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "command_manager.hpp"
+#include "denoiser_chain.hpp"
+#include "storage_precision.hpp"
 #include "swap_chain_manager.hpp"
+#include <array>
 #include <vector>
 #include <vulkan/vulkan.h>
 
@@ -12,6 +15,14 @@ class SVGFilterImageRecreateObserver
     virtual ~SVGFilterImageRecreateObserver() = default;
 };
 
+// 降噪中间图像：创建后清零并常驻 GENERAL 布局，通过 storage image 读写，下一个 stage 也可以在 GENERAL 下采样
+struct SVGFilterImage
+{
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+};
+
 class SVGFilterResourceManager
 {
   public:
@@ -20,6 +31,17 @@ class SVGFilterResourceManager
 
     void cleanup();
 
+    // 在 init 或重新创建图像之前设置，下一次创建图像时生效
+    void setStoragePrecision(StoragePrecision precision)
+    {
+        storagePrecision = precision;
+    }
+
+    VkFormat getOutputImageFormat() const
+    {
+        return getColorStorageFormat(storagePrecision);
+    }
+
     void recreateDenoisedOutputImages(VkExtent2D imageExtent);
 
     std::vector<VkImageView> getDenoisedOutputImageView() const
@@ -32,6 +54,46 @@ class SVGFilterResourceManager
         return denoisedOutputImages;
     };
 
+    DenoiserChainSettings& getDenoiserChainSettings()
+    {
+        return denoiserChainSettings;
+    }
+
+    // 降噪链的中间图像池：stage 之间传递的结果与 SVGF 的 à-trous ping-pong 都从池中分配，
+    // 只增不减，尺寸变化时按原有数量重建
+    void reserveIntermediateImages(uint32_t count);
+
+    VkImageView getIntermediateImageView(uint32_t index) const
+    {
+        return intermediateImages[index].view;
+    }
+
+    uint32_t getIntermediateImageCount() const
+    {
+        return static_cast<uint32_t>(intermediateImages.size());
+    }
+
+    // 清空 SVGF 的颜色、矩与位置历史，降噪链顺序变化或 SVGF 重新启用时调用
+    void resetHistory();
+
+    // 第一次 à-trous 迭代的结果，作为下一帧时域累积的颜色历史
+    VkImageView getColorHistoryImageView() const
+    {
+        return colorHistoryImage.view;
+    }
+
+    // 亮度矩与法线，按帧交替读写
+    VkImageView getMomentsImageView(uint32_t index) const
+    {
+        return momentsImages[index].view;
+    }
+
+    // 世界空间位置与历史长度，按帧交替读写
+    VkImageView getSurfaceImageView(uint32_t index) const
+    {
+        return surfaceImages[index].view;
+    }
+
     VkSampler getDenoiserInputSampler() const
     {
         return denoiserInputSampler;
@@ -49,6 +111,10 @@ class SVGFilterResourceManager
 
   private:
     void createDenoisedOutputImages();
+    void createFilterImages();
+    void createFilterImage(VkFormat format, SVGFilterImage& filterImage);
+    void clearFilterImage(SVGFilterImage& filterImage);
+    void destroyFilterImages();
     void createSamplers();
 
     VkDevice device;
@@ -60,11 +126,19 @@ class SVGFilterResourceManager
     uint32_t imageWidth;
     uint32_t imageHeight;
     uint32_t imageCount;
+    StoragePrecision storagePrecision = StoragePrecision::Full;
+    DenoiserChainSettings denoiserChainSettings;
 
     std::vector<VkImage> denoisedOutputImages;
     std::vector<VkDeviceMemory> denoisedOutputImageMemories;
     std::vector<VkImageView> denoisedOutputImageViews;
 
+    // 全部只有一份：各帧的降噪在同一队列上按提交顺序执行
+    std::vector<SVGFilterImage> intermediateImages;
+    SVGFilterImage colorHistoryImage;
+    std::array<SVGFilterImage, 2> momentsImages;
+    std::array<SVGFilterImage, 2> surfaceImages;
+
     std::vector<SVGFilterImageRecreateObserver*> svgFilterImageRecreateObservers;
 
     // 采样器 (可以是一个通用的，或为每个输入纹理单独创建)
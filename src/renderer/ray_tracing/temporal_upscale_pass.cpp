@@ -0,0 +1,414 @@
+#include "temporal_upscale_pass.hpp"
+#include "vulkan_utils.hpp"
+#include <array>
+#include <shaderc/shaderc.hpp>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+void TemporalUpscalePass::init(VkDevice device, VkPhysicalDevice physicalDevice, SwapChainManager& swapChainManager,
+                               GBufferResourceManager& gbufferResourceManager,
+                               PathTracingResourceManager& pathTracingResourceManager,
+                               TemporalUpscaleResourceManager& temporalUpscaleResourceManager,
+                               std::vector<VkCommandBuffer>&& commandBuffers)
+{
+    this->device = device;
+    this->physicalDevice = physicalDevice;
+    this->swapChainManager = &swapChainManager;
+    this->gbufferResourceManager = &gbufferResourceManager;
+    this->pathTracingResourceManager = &pathTracingResourceManager;
+    this->temporalUpscaleResourceManager = &temporalUpscaleResourceManager;
+    this->imageCount = swapChainManager.getSwapChainImages().size();
+    this->commandBuffers = std::move(commandBuffers);
+
+    temporalUpscalePassObserver = std::make_unique<TemporalUpscalePassObserver>(this);
+    temporalUpscaleResourceManager.addUpscaleImageRecreateObserver(temporalUpscalePassObserver.get());
+    gbufferResourceManager.addGBufferResourceRecreateObserver(temporalUpscalePassObserver.get());
+    pathTracingResourceManager.addPathTracingResourceReloadObserver(temporalUpscalePassObserver.get());
+
+    createDescriptorSetLayout();
+    createPipeline();
+    createDescriptorPool();
+    createDescriptorSets();
+}
+
+void TemporalUpscalePass::cleanup()
+{
+    destroyPipeline();
+    if (descriptorSetLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+        descriptorSetLayout = VK_NULL_HANDLE;
+    }
+    if (descriptorPool != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+    }
+    descriptorSets.clear();
+}
+
+void TemporalUpscalePass::createDescriptorSetLayout()
+{
+    // binding 0: 累积后的路径追踪结果 (低分辨率)
+    // binding 1: 本帧的路径追踪样本 (低分辨率，带抖动)
+    // binding 2-4: G-buffer 法线、深度、位置 (全分辨率)
+    // binding 5: 历史 (全分辨率)
+    // binding 6: 上采样输出 (storage image)
+    // binding 7: 同分辨率历史的样本数 (storage image)
+    std::array<VkDescriptorSetLayoutBinding, 8> bindings = {};
+    for (uint32_t i = 0; i < bindings.size(); ++i)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType =
+            i < 6 ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create temporal upscale descriptor set layout!");
+    }
+}
+
+void TemporalUpscalePass::destroyPipeline()
+{
+    if (pipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        pipeline = VK_NULL_HANDLE;
+    }
+    if (pipelineLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        pipelineLayout = VK_NULL_HANDLE;
+    }
+}
+
+void TemporalUpscalePass::updateOutputFormat()
+{
+    if (temporalUpscaleResourceManager->getOutputImageFormat() == pipelineOutputFormat)
+    {
+        return;
+    }
+    // 重建上采样图像前已 vkDeviceWaitIdle，旧管线不再被使用
+    destroyPipeline();
+    createPipeline();
+}
+
+void TemporalUpscalePass::createPipeline()
+{
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+    std::string compute_shader_code_path = "../shader/temporal_upscale.comp";
+
+    std::string cs = vulkanUtils.readFileToString(compute_shader_code_path);
+    shaderc::Compiler compiler;
+    shaderc::CompileOptions options;
+    pipelineOutputFormat = temporalUpscaleResourceManager->getOutputImageFormat();
+    options.AddMacroDefinition("OUTPUT_IMAGE_FORMAT", getStorageFormatQualifier(pipelineOutputFormat));
+    auto computeResult =
+        compiler.CompileGlslToSpv(cs, shaderc_glsl_compute_shader, compute_shader_code_path.c_str(), options);
+    auto errorInfo = computeResult.GetErrorMessage();
+    if (!errorInfo.empty())
+    {
+        throw std::runtime_error("Compute shader compilation error: " + errorInfo);
+    }
+
+    std::span<const uint32_t> compute_spv = {computeResult.begin(),
+                                             size_t(computeResult.end() - computeResult.begin()) * 4};
+    VkShaderModuleCreateInfo csmoduleCreateInfo; // 准备计算着色器模块创建信息
+    csmoduleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    csmoduleCreateInfo.pNext = nullptr;
+    csmoduleCreateInfo.flags = 0;
+    csmoduleCreateInfo.codeSize = compute_spv.size(); // 计算着色器SPV数据总字节数
+    csmoduleCreateInfo.pCode = compute_spv.data();    // 计算着色器SPV数据
+
+    auto computeShaderModule = vulkanUtils.createShaderModule(device, csmoduleCreateInfo);
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(UpscalePushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+    {
+        vkDestroyShaderModule(device, computeShaderModule, nullptr);
+        throw std::runtime_error("failed to create temporal upscale pipeline layout!");
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = computeShaderModule;
+    pipelineInfo.stage.pName = "main";
+
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+    {
+        vkDestroyShaderModule(device, computeShaderModule, nullptr);
+        throw std::runtime_error("failed to create temporal upscale compute pipeline!");
+    }
+
+    vkDestroyShaderModule(device, computeShaderModule, nullptr);
+}
+
+void TemporalUpscalePass::createDescriptorPool()
+{
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[0].descriptorCount = 6 * imageCount;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSizes[1].descriptorCount = 2 * imageCount;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = imageCount;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create temporal upscale descriptor pool!");
+    }
+}
+
+void TemporalUpscalePass::createDescriptorSets()
+{
+    descriptorSets.resize(imageCount, VK_NULL_HANDLE);
+
+    std::vector<VkDescriptorSetLayout> layouts(imageCount, descriptorSetLayout);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+    allocInfo.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate temporal upscale descriptor sets!");
+    }
+
+    updatePathTracedColorDescriptorSets();
+    updateGBufferDescriptorSets();
+    updateUpscaleDescriptorSets();
+}
+
+void TemporalUpscalePass::updatePathTracedColorDescriptorSets()
+{
+    VkSampler sampler = temporalUpscaleResourceManager->getUpscaleSampler();
+    for (size_t imageIndex = 0; imageIndex < descriptorSets.size(); ++imageIndex)
+    {
+        std::array<VkDescriptorImageInfo, 2> imageInfos{};
+        imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfos[0].imageView = pathTracingResourceManager->getPathTracingOutputImageviews()[imageIndex];
+        imageInfos[0].sampler = sampler;
+        imageInfos[1].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfos[1].imageView = pathTracingResourceManager->getAccumulationImageViews()[imageIndex];
+        imageInfos[1].sampler = sampler;
+
+        std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+        for (uint32_t i = 0; i < descriptorWrites.size(); ++i)
+        {
+            descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[i].dstSet = descriptorSets[imageIndex];
+            descriptorWrites[i].dstBinding = i;
+            descriptorWrites[i].dstArrayElement = 0;
+            descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            descriptorWrites[i].descriptorCount = 1;
+            descriptorWrites[i].pImageInfo = &imageInfos[i];
+        }
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
+                               nullptr);
+    }
+}
+
+void TemporalUpscalePass::updateGBufferDescriptorSets()
+{
+    VkSampler sampler = temporalUpscaleResourceManager->getUpscaleSampler();
+    for (size_t imageIndex = 0; imageIndex < descriptorSets.size(); ++imageIndex)
+    {
+        std::array<VkDescriptorImageInfo, 3> imageInfos{};
+        imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfos[0].imageView = gbufferResourceManager->getNormalAttachment(imageIndex).view;
+        imageInfos[0].sampler = sampler;
+        imageInfos[1].imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        imageInfos[1].imageView = gbufferResourceManager->getDepthAttachment(imageIndex).view;
+        imageInfos[1].sampler = sampler;
+        imageInfos[2].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfos[2].imageView = gbufferResourceManager->getPositionAttachment(imageIndex).view;
+        imageInfos[2].sampler = sampler;
+
+        std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+        for (uint32_t i = 0; i < descriptorWrites.size(); ++i)
+        {
+            descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[i].dstSet = descriptorSets[imageIndex];
+            descriptorWrites[i].dstBinding = 2 + i;
+            descriptorWrites[i].dstArrayElement = 0;
+            descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            descriptorWrites[i].descriptorCount = 1;
+            descriptorWrites[i].pImageInfo = &imageInfos[i];
+        }
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
+                               nullptr);
+    }
+}
+
+void TemporalUpscalePass::updateUpscaleDescriptorSets()
+{
+    for (size_t imageIndex = 0; imageIndex < descriptorSets.size(); ++imageIndex)
+    {
+        VkDescriptorImageInfo historyInfo{};
+        historyInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        historyInfo.imageView = temporalUpscaleResourceManager->getHistoryImageView();
+        historyInfo.sampler = temporalUpscaleResourceManager->getUpscaleSampler();
+
+        VkDescriptorImageInfo outputInfo{};
+        outputInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        outputInfo.imageView = temporalUpscaleResourceManager->getUpscaledOutputImageViews()[imageIndex];
+
+        VkDescriptorImageInfo sampleCountInfo{};
+        sampleCountInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        sampleCountInfo.imageView = temporalUpscaleResourceManager->getHistorySampleCountImageView();
+
+        std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+        descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[0].dstSet = descriptorSets[imageIndex];
+        descriptorWrites[0].dstBinding = 5;
+        descriptorWrites[0].dstArrayElement = 0;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[0].descriptorCount = 1;
+        descriptorWrites[0].pImageInfo = &historyInfo;
+
+        descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[1].dstSet = descriptorSets[imageIndex];
+        descriptorWrites[1].dstBinding = 6;
+        descriptorWrites[1].dstArrayElement = 0;
+        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        descriptorWrites[1].descriptorCount = 1;
+        descriptorWrites[1].pImageInfo = &outputInfo;
+
+        descriptorWrites[2] = descriptorWrites[1];
+        descriptorWrites[2].dstBinding = 7;
+        descriptorWrites[2].pImageInfo = &sampleCountInfo;
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
+                               nullptr);
+    }
+}
+
+VkCommandBuffer TemporalUpscalePass::recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex)
+{
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+    VkCommandBuffer commandBuffer = commandBuffers[frameIndex];
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to begin recording command buffer!");
+    }
+
+    VkImage outputImage = temporalUpscaleResourceManager->getUpscaledOutputImages()[imageIndex];
+    VkImage historyImage = temporalUpscaleResourceManager->getHistoryImage();
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+    // 输出图像：SHADER_READ_ONLY -> GENERAL；同时等待路径追踪写完低分辨率结果与上一帧写完样本数
+    barrier.image = outputImage;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+
+    VkMemoryBarrier memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 1, &barrier);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1,
+                            &descriptorSets[imageIndex], 0, nullptr);
+
+    // 与路径追踪使用同一帧的抖动和上一帧矩阵
+    const CameraData& cameraData = pathTracingResourceManager->getCurrentCameraData();
+    UpscalePushConstants pushConstants{};
+    pushConstants.prevViewProj = cameraData.prevViewProj;
+    pushConstants.pixelJitter = cameraData.pixelJitter;
+    pushConstants.frame = cameraData.frame;
+    pushConstants.newSamples = pathTracingResourceManager->isConverged() ? 0 : cameraData.samplesPerPixel;
+    pushConstants.discardHistory = pathTracingResourceManager->isHistoryDiscarded() ? 1 : 0;
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(UpscalePushConstants),
+                       &pushConstants);
+
+    VkExtent2D imageExtent = temporalUpscaleResourceManager->getOutputExtent();
+    uint32_t localSizeX = 16; // 计算着色器中定义的工作组大小
+    uint32_t localSizeY = 16;
+    uint32_t groupCountX = (imageExtent.width + localSizeX - 1) / localSizeX;
+    uint32_t groupCountY = (imageExtent.height + localSizeY - 1) / localSizeY;
+    vkCmdDispatch(commandBuffer, groupCountX, groupCountY, 1);
+
+    // 把本帧结果拷贝为下一帧的历史
+    std::array<VkImageMemoryBarrier, 2> copyBarriers = {barrier, barrier};
+    copyBarriers[0].image = outputImage;
+    copyBarriers[0].oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    copyBarriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    copyBarriers[0].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    copyBarriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    copyBarriers[1].image = historyImage;
+    copyBarriers[1].oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    copyBarriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    copyBarriers[1].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    copyBarriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                         nullptr, 0, nullptr, static_cast<uint32_t>(copyBarriers.size()), copyBarriers.data());
+
+    VkImageCopy copyRegion{};
+    copyRegion.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    copyRegion.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    copyRegion.extent = {imageExtent.width, imageExtent.height, 1};
+    vkCmdCopyImage(commandBuffer, outputImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, historyImage,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+
+    copyBarriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    copyBarriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    copyBarriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    copyBarriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    copyBarriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    copyBarriers[1].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    copyBarriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    copyBarriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr,
+                         0, nullptr, static_cast<uint32_t>(copyBarriers.size()), copyBarriers.data());
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+
+    return commandBuffer;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "gbuffer_resource_manager.hpp"
+#include "path_tracing_resource_manager.hpp"
+#include "swap_chain_manager.hpp"
+#include "temporal_upscale_resource_manager.hpp"
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+class TemporalUpscalePassObserver;
+
+// 时域上采样：把降分辨率的路径追踪结果按抖动位置重建到全分辨率，
+// 用全分辨率 G-buffer 做边缘感知的权重，并与重投影的历史混合
+// 同分辨率时不做重建，只在相机移动重置累积后接上重投影并经邻域裁剪的历史
+class TemporalUpscalePass
+{
+  public:
+    void init(VkDevice device, VkPhysicalDevice physicalDevice, SwapChainManager& swapChainManager,
+              GBufferResourceManager& gbufferResourceManager, PathTracingResourceManager& pathTracingResourceManager,
+              TemporalUpscaleResourceManager& temporalUpscaleResourceManager,
+              std::vector<VkCommandBuffer>&& commandBuffers);
+    void cleanup();
+
+    VkCommandBuffer recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex);
+
+    void updatePathTracedColorDescriptorSets();
+
+    void updateGBufferDescriptorSets();
+
+    void updateUpscaleDescriptorSets();
+
+    // 上采样图像按新的存储精度重建后，重新编译带格式限定符的着色器；格式未变时不做任何事
+    void updateOutputFormat();
+
+  private:
+    // 与 shader/temporal_upscale.comp 中的 push_constant 块一致
+    struct UpscalePushConstants
+    {
+        glm::mat4 prevViewProj;
+        glm::vec2 pixelJitter;
+        int frame;
+        int newSamples;
+        int discardHistory;
+    };
+
+    VkDevice device;
+    VkPhysicalDevice physicalDevice;
+    SwapChainManager* swapChainManager = nullptr;
+
+    GBufferResourceManager* gbufferResourceManager = nullptr;
+    PathTracingResourceManager* pathTracingResourceManager = nullptr;
+    TemporalUpscaleResourceManager* temporalUpscaleResourceManager = nullptr;
+    uint32_t imageCount;
+
+    std::vector<VkCommandBuffer> commandBuffers;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkFormat pipelineOutputFormat = VK_FORMAT_UNDEFINED; // 编译着色器时的输出格式
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> descriptorSets;
+
+    std::unique_ptr<TemporalUpscalePassObserver> temporalUpscalePassObserver;
+
+    void createPipeline();
+    void destroyPipeline();
+    void createDescriptorSetLayout();
+    void createDescriptorPool();
+    void createDescriptorSets();
+};
+
+class TemporalUpscalePassObserver : public UpscaleImageRecreateObserver,
+                                    public GBufferResourceRecreateObserver,
+                                    public PathTracingResourceReloadObserver
+{
+  public:
+    TemporalUpscalePassObserver(TemporalUpscalePass* temporalUpscalePass) : temporalUpscalePass(temporalUpscalePass)
+    {
+    }
+
+    void onUpscaleImagesRecreated() override
+    {
+        if (temporalUpscalePass)
+        {
+            temporalUpscalePass->updateOutputFormat();
+            temporalUpscalePass->updateUpscaleDescriptorSets();
+        }
+    }
+
+    void onGBufferRecreated() override
+    {
+        if (temporalUpscalePass)
+        {
+            temporalUpscalePass->updateGBufferDescriptorSets();
+        }
+    }
+
+    void onPathTracingOutputImagesRecreated() override
+    {
+        if (temporalUpscalePass)
+        {
+            temporalUpscalePass->updatePathTracedColorDescriptorSets();
+        }
+    }
+
+    void onModelReloaded() override
+    {
+    }
+
+  private:
+    TemporalUpscalePass* temporalUpscalePass = nullptr;
+};
@@ -0,0 +1,186 @@
+#include "temporal_upscale_resource_manager.hpp"
+#include "vulkan_utils.hpp"
+#include <array>
+#include <stdexcept>
+
+void TemporalUpscaleResourceManager::init(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue,
+                                          SwapChainManager& swapChainManager, CommandManager& commandManager)
+{
+    this->device = device;
+    this->physicalDevice = physicalDevice;
+    this->graphicsQueue = graphicsQueue;
+    this->swapChainManager = &swapChainManager;
+    this->outPutExtent = swapChainManager.getSwapChainExtent();
+    this->imageCount = swapChainManager.getSwapChainImages().size();
+    this->commandManager = &commandManager;
+
+    createUpscaledOutputImages();
+    createHistoryImage();
+    createSampler();
+}
+
+void TemporalUpscaleResourceManager::cleanup()
+{
+    destroyImages();
+
+    if (upscaleSampler != VK_NULL_HANDLE)
+    {
+        vkDestroySampler(device, upscaleSampler, nullptr);
+        upscaleSampler = VK_NULL_HANDLE;
+    }
+}
+
+void TemporalUpscaleResourceManager::destroyImages()
+{
+    for (uint32_t i = 0; i < upscaledOutputImages.size(); ++i)
+    {
+        vkDestroyImageView(device, upscaledOutputImageViews[i], nullptr);
+        vkDestroyImage(device, upscaledOutputImages[i], nullptr);
+        vkFreeMemory(device, upscaledOutputImageMemories[i], nullptr);
+    }
+    upscaledOutputImageViews.clear();
+    upscaledOutputImages.clear();
+    upscaledOutputImageMemories.clear();
+
+    if (historyImage != VK_NULL_HANDLE)
+    {
+        vkDestroyImageView(device, historyImageView, nullptr);
+        vkDestroyImage(device, historyImage, nullptr);
+        vkFreeMemory(device, historyImageMemory, nullptr);
+        historyImageView = VK_NULL_HANDLE;
+        historyImage = VK_NULL_HANDLE;
+        historyImageMemory = VK_NULL_HANDLE;
+    }
+
+    if (historySampleCountImage != VK_NULL_HANDLE)
+    {
+        vkDestroyImageView(device, historySampleCountImageView, nullptr);
+        vkDestroyImage(device, historySampleCountImage, nullptr);
+        vkFreeMemory(device, historySampleCountImageMemory, nullptr);
+        historySampleCountImageView = VK_NULL_HANDLE;
+        historySampleCountImage = VK_NULL_HANDLE;
+        historySampleCountImageMemory = VK_NULL_HANDLE;
+    }
+}
+
+void TemporalUpscaleResourceManager::recreateUpscaledImages(VkExtent2D imageExtent)
+{
+    vkDeviceWaitIdle(device); // 等待设备空闲
+    destroyImages();
+    this->outPutExtent = imageExtent;
+    createUpscaledOutputImages();
+    createHistoryImage();
+
+    for (auto observer : upscaleImageRecreateObservers)
+    {
+        observer->onUpscaleImagesRecreated(); // 通知观察者
+    }
+}
+
+void TemporalUpscaleResourceManager::createUpscaledOutputImages()
+{
+    upscaledOutputImages.resize(imageCount);
+    upscaledOutputImageMemories.resize(imageCount);
+    upscaledOutputImageViews.resize(imageCount);
+
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+
+    VkFormat format = getOutputImageFormat();
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+    for (uint32_t i = 0; i < imageCount; ++i)
+    {
+        vulkanUtils.createImage(device, physicalDevice, outPutExtent.width, outPutExtent.height, format,
+                                VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                upscaledOutputImages[i], upscaledOutputImageMemories[i]);
+
+        upscaledOutputImageViews[i] =
+            vulkanUtils.createImageView(device, upscaledOutputImages[i], format, VK_IMAGE_ASPECT_COLOR_BIT);
+
+        vulkanUtils.transitionImageLayout(device, commandManager->getCommandPool(), graphicsQueue,
+                                          upscaledOutputImages[i], format, VK_IMAGE_LAYOUT_UNDEFINED,
+                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+}
+
+void TemporalUpscaleResourceManager::createHistoryImage()
+{
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+
+    VkFormat format = getOutputImageFormat(); // 由输出图像拷贝而来，格式必须一致
+    vulkanUtils.createImage(device, physicalDevice, outPutExtent.width, outPutExtent.height, format,
+                            VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, historyImage, historyImageMemory);
+    historyImageView = vulkanUtils.createImageView(device, historyImage, format, VK_IMAGE_ASPECT_COLOR_BIT);
+
+    // 样本数始终用 FP32，与存储精度无关
+    vulkanUtils.createImage(device, physicalDevice, outPutExtent.width, outPutExtent.height, VK_FORMAT_R32_SFLOAT,
+                            VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, historySampleCountImage,
+                            historySampleCountImageMemory);
+    historySampleCountImageView = vulkanUtils.createImageView(device, historySampleCountImage, VK_FORMAT_R32_SFLOAT,
+                                                              VK_IMAGE_ASPECT_COLOR_BIT);
+
+    // 清零历史 (alpha 与样本数为 0 表示没有可用历史)，之后常驻 GENERAL
+    VkCommandBuffer commandBuffer = commandManager->beginSingleTimeCommands();
+
+    std::array<VkImageMemoryBarrier, 2> barriers{};
+    for (size_t i = 0; i < barriers.size(); ++i)
+    {
+        barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[i].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[i].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].image = i == 0 ? historyImage : historySampleCountImage;
+        barriers[i].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        barriers[i].srcAccessMask = 0;
+        barriers[i].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                         nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    VkClearColorValue clearColor = {{0.0f, 0.0f, 0.0f, 0.0f}};
+    for (const VkImageMemoryBarrier& barrier : barriers)
+    {
+        vkCmdClearColorImage(commandBuffer, barrier.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearColor, 1,
+                             &barrier.subresourceRange);
+    }
+
+    for (VkImageMemoryBarrier& barrier : barriers)
+    {
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0,
+                         nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    commandManager->endSingleTimeCommands(commandBuffer);
+}
+
+void TemporalUpscaleResourceManager::createSampler()
+{
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.anisotropyEnable = VK_FALSE;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = 0.0f;
+
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &upscaleSampler) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create temporal upscale sampler!");
+    }
+}
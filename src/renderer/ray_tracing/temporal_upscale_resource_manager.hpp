@@ -0,0 +1,112 @@
+#pragma once
+
+#include "command_manager.hpp"
+#include "storage_precision.hpp"
+#include "swap_chain_manager.hpp"
+#include <vector>
+#include <vulkan/vulkan.h>
+
+class UpscaleImageRecreateObserver
+{
+  public:
+    virtual void onUpscaleImagesRecreated() = 0;
+    virtual ~UpscaleImageRecreateObserver() = default;
+};
+
+// 时域上采样的输出与历史图像，尺寸始终为视口 (全分辨率)
+class TemporalUpscaleResourceManager
+{
+  public:
+    void init(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue,
+              SwapChainManager& swapChainManager, CommandManager& commandManager);
+
+    void cleanup();
+
+    // 在 init 或重新创建图像之前设置，下一次创建图像时生效
+    void setStoragePrecision(StoragePrecision precision)
+    {
+        storagePrecision = precision;
+    }
+
+    VkFormat getOutputImageFormat() const
+    {
+        return getColorStorageFormat(storagePrecision);
+    }
+
+    void recreateUpscaledImages(VkExtent2D imageExtent);
+
+    std::vector<VkImage> getUpscaledOutputImages() const
+    {
+        return upscaledOutputImages;
+    }
+
+    std::vector<VkImageView> getUpscaledOutputImageViews() const
+    {
+        return upscaledOutputImageViews;
+    }
+
+    // 上一帧的上采样结果，每帧结束时由输出图像拷贝而来，常驻 GENERAL 布局
+    VkImage getHistoryImage() const
+    {
+        return historyImage;
+    }
+
+    VkImageView getHistoryImageView() const
+    {
+        return historyImageView;
+    }
+
+    // 同分辨率时历史带有的样本数 (R32F)，输出与历史的 alpha 在半精度下无法精确表示大样本数
+    // 每个像素只读写自己的位置，常驻 GENERAL 布局
+    VkImageView getHistorySampleCountImageView() const
+    {
+        return historySampleCountImageView;
+    }
+
+    VkSampler getUpscaleSampler() const
+    {
+        return upscaleSampler;
+    }
+
+    VkExtent2D getOutputExtent() const
+    {
+        return outPutExtent;
+    }
+
+    void addUpscaleImageRecreateObserver(UpscaleImageRecreateObserver* observer)
+    {
+        upscaleImageRecreateObservers.push_back(observer);
+    }
+
+  private:
+    void createUpscaledOutputImages();
+    void createHistoryImage();
+    void destroyImages();
+    void createSampler();
+
+    VkDevice device;
+    VkPhysicalDevice physicalDevice;
+    VkQueue graphicsQueue;
+    VkExtent2D outPutExtent;
+    CommandManager* commandManager = nullptr;
+    SwapChainManager* swapChainManager = nullptr;
+    uint32_t imageCount;
+    StoragePrecision storagePrecision = StoragePrecision::Full;
+
+    std::vector<VkImage> upscaledOutputImages;
+    std::vector<VkDeviceMemory> upscaledOutputImageMemories;
+    std::vector<VkImageView> upscaledOutputImageViews;
+
+    VkImage historyImage = VK_NULL_HANDLE;
+    VkDeviceMemory historyImageMemory = VK_NULL_HANDLE;
+    VkImageView historyImageView = VK_NULL_HANDLE;
+
+    VkImage historySampleCountImage = VK_NULL_HANDLE;
+    VkDeviceMemory historySampleCountImageMemory = VK_NULL_HANDLE;
+    VkImageView historySampleCountImageView = VK_NULL_HANDLE;
+
+    // 双线性采样器，用于历史重投影和低分辨率输入的回退采样
+    VkSampler upscaleSampler = VK_NULL_HANDLE;
+
+    std::vector<UpscaleImageRecreateObserver*> upscaleImageRecreateObservers;
+};
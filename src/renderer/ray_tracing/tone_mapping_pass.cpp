@@ -0,0 +1,394 @@
+#include "tone_mapping_pass.hpp"
+#include "shader_includer.hpp"
+#include "vulkan_utils.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <shaderc/shaderc.hpp>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+void ToneMappingPass::init(VkDevice device, VkPhysicalDevice physicalDevice, SwapChainManager& swapChainManager,
+                           SVGFilterResourceManager& svgFilterResourceManager,
+                           ToneMappingResourceManager& toneMappingResourceManager,
+                           std::vector<VkCommandBuffer>&& commandBuffers)
+{
+    this->device = device;
+    this->physicalDevice = physicalDevice;
+    this->svgFilterResourceManager = &svgFilterResourceManager;
+    this->toneMappingResourceManager = &toneMappingResourceManager;
+    this->imageCount = swapChainManager.getSwapChainImages().size();
+    this->commandBuffers = std::move(commandBuffers);
+
+    toneMappingPassObserver = std::make_unique<ToneMappingPassObserver>(this);
+    svgFilterResourceManager.addSVGFilterImageRecreateObserver(toneMappingPassObserver.get());
+    toneMappingResourceManager.addDisplayImageRecreateObserver(toneMappingPassObserver.get());
+
+    createDescriptorSetLayout();
+    createPipelines();
+    createDescriptorPool();
+    createDescriptorSets();
+}
+
+void ToneMappingPass::cleanup()
+{
+    for (VkPipeline* pipeline : {&histogramPipeline, &exposurePipeline, &toneMappingPipeline})
+    {
+        if (*pipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(device, *pipeline, nullptr);
+            *pipeline = VK_NULL_HANDLE;
+        }
+    }
+    if (pipelineLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        pipelineLayout = VK_NULL_HANDLE;
+    }
+    if (descriptorSetLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+        descriptorSetLayout = VK_NULL_HANDLE;
+    }
+    if (descriptorPool != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+    }
+    descriptorSets.clear();
+}
+
+void ToneMappingPass::createDescriptorSetLayout()
+{
+    // binding 0: 降噪输出 (sampler2D), 1: 亮度直方图, 2: 曝光 (storage buffer), 3: 显示图像 (storage image)
+    std::array<VkDescriptorType, 4> types = {
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE};
+    std::array<VkDescriptorSetLayoutBinding, 4> bindings = {};
+    for (uint32_t i = 0; i < bindings.size(); ++i)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = types[i];
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create tone mapping descriptor set layout!");
+    }
+}
+
+bool ToneMappingPass::isSubgroupReductionSupported() const
+{
+    VkPhysicalDeviceSubgroupProperties subgroupProperties{};
+    subgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &subgroupProperties;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    VkSubgroupFeatureFlags requiredOperations = VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_ARITHMETIC_BIT;
+    return (subgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) &&
+           (subgroupProperties.supportedOperations & requiredOperations) == requiredOperations;
+}
+
+VkPipeline ToneMappingPass::createComputePipeline(const std::string& shaderPath, bool subgroupReduction)
+{
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+    std::string cs = vulkanUtils.readFileToString(shaderPath);
+    shaderc::Compiler compiler;
+    shaderc::CompileOptions options;
+    options.SetIncluder(std::make_unique<ShaderIncluder>()); // tone_mapping_common.glsl
+    if (subgroupReduction)
+    {
+        // 子组操作需要 SPIR-V 1.3
+        options.AddMacroDefinition("SUBGROUP_REDUCTION");
+        options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_1);
+    }
+    auto computeResult = compiler.CompileGlslToSpv(cs, shaderc_glsl_compute_shader, shaderPath.c_str(), options);
+    auto errorInfo = computeResult.GetErrorMessage();
+    if (!errorInfo.empty())
+    {
+        throw std::runtime_error("Compute shader compilation error: " + errorInfo);
+    }
+
+    std::span<const uint32_t> compute_spv = {computeResult.begin(),
+                                             size_t(computeResult.end() - computeResult.begin()) * 4};
+    VkShaderModuleCreateInfo csmoduleCreateInfo; // 准备计算着色器模块创建信息
+    csmoduleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    csmoduleCreateInfo.pNext = nullptr;
+    csmoduleCreateInfo.flags = 0;
+    csmoduleCreateInfo.codeSize = compute_spv.size(); // 计算着色器SPV数据总字节数
+    csmoduleCreateInfo.pCode = compute_spv.data();    // 计算着色器SPV数据
+
+    auto computeShaderModule = vulkanUtils.createShaderModule(device, csmoduleCreateInfo);
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = computeShaderModule;
+    pipelineInfo.stage.pName = "main";
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+    {
+        vkDestroyShaderModule(device, computeShaderModule, nullptr);
+        throw std::runtime_error("Failed to create tone mapping compute pipeline!");
+    }
+
+    vkDestroyShaderModule(device, computeShaderModule, nullptr);
+    return pipeline;
+}
+
+void ToneMappingPass::createPipelines()
+{
+    // 三个 pass 共享同一个管线布局和描述符集布局
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(ToneMappingPushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create tone mapping pipeline layout!");
+    }
+
+    histogramPipeline = createComputePipeline("../shader/luminance_histogram.comp");
+    // 不支持子组算术操作时退回共享内存归约树
+    exposurePipeline = createComputePipeline("../shader/auto_exposure.comp", isSubgroupReductionSupported());
+    toneMappingPipeline = createComputePipeline("../shader/tone_mapping.comp");
+}
+
+void ToneMappingPass::createDescriptorPool()
+{
+    std::array<VkDescriptorPoolSize, 3> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[0].descriptorCount = imageCount;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = 2 * imageCount; // 直方图 + 曝光
+    poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSizes[2].descriptorCount = imageCount;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = imageCount;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create tone mapping descriptor pool!");
+    }
+}
+
+void ToneMappingPass::createDescriptorSets()
+{
+    descriptorSets.resize(imageCount, VK_NULL_HANDLE);
+
+    std::vector<VkDescriptorSetLayout> layouts(imageCount, descriptorSetLayout);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = imageCount;
+    allocInfo.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate tone mapping descriptor sets!");
+    }
+
+    // 直方图与曝光缓冲不会重建，只写一次
+    for (size_t i = 0; i < imageCount; ++i)
+    {
+        std::array<VkDescriptorBufferInfo, 2> bufferInfos{};
+        bufferInfos[0].buffer = toneMappingResourceManager->getHistogramBuffer();
+        bufferInfos[0].offset = 0;
+        bufferInfos[0].range = VK_WHOLE_SIZE;
+        bufferInfos[1].buffer = toneMappingResourceManager->getExposureBuffer();
+        bufferInfos[1].offset = 0;
+        bufferInfos[1].range = VK_WHOLE_SIZE;
+
+        std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+        for (size_t j = 0; j < descriptorWrites.size(); ++j)
+        {
+            descriptorWrites[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[j].dstSet = descriptorSets[i];
+            descriptorWrites[j].dstBinding = static_cast<uint32_t>(j + 1);
+            descriptorWrites[j].dstArrayElement = 0;
+            descriptorWrites[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[j].descriptorCount = 1;
+            descriptorWrites[j].pBufferInfo = &bufferInfos[j];
+        }
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0,
+                               nullptr);
+    }
+
+    updateInputDescriptorSets();
+    updateDisplayDescriptorSets();
+}
+
+void ToneMappingPass::updateInputDescriptorSets()
+{
+    for (size_t i = 0; i < imageCount; ++i)
+    {
+        VkDescriptorImageInfo inputInfo{};
+        inputInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        inputInfo.imageView = svgFilterResourceManager->getDenoisedOutputImageView()[i];
+        inputInfo.sampler = toneMappingResourceManager->getLuminanceSampler();
+
+        VkWriteDescriptorSet descriptorWrite{};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = descriptorSets[i];
+        descriptorWrite.dstBinding = 0;
+        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pImageInfo = &inputInfo;
+
+        vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+    }
+}
+
+void ToneMappingPass::updateDisplayDescriptorSets()
+{
+    for (size_t i = 0; i < imageCount; ++i)
+    {
+        VkDescriptorImageInfo displayInfo{};
+        displayInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        displayInfo.imageView = toneMappingResourceManager->getDisplayStorageImageViews()[i];
+
+        VkWriteDescriptorSet descriptorWrite{};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = descriptorSets[i];
+        descriptorWrite.dstBinding = 3;
+        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pImageInfo = &displayInfo;
+
+        vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+    }
+}
+
+VkCommandBuffer ToneMappingPass::recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex)
+{
+    auto now = std::chrono::steady_clock::now();
+    float deltaTime = hasRecorded ? std::chrono::duration<float>(now - lastRecordTime).count() : 0.0f;
+    lastRecordTime = now;
+    hasRecorded = true;
+
+    const ToneMappingSettings& settings = toneMappingResourceManager->getSettings();
+    VkExtent2D imageExtent = toneMappingResourceManager->getOutputExtent();
+    uint32_t halfWidth = (imageExtent.width + 1) / 2;
+    uint32_t halfHeight = (imageExtent.height + 1) / 2;
+
+    ToneMappingPushConstants pushConstants{};
+    pushConstants.minLogLuminance = settings.minLogLuminance;
+    pushConstants.logLuminanceRange = std::max(settings.maxLogLuminance - settings.minLogLuminance, 0.001f);
+    pushConstants.adaptationRate = 1.0f - std::exp(-deltaTime * std::max(settings.adaptationSpeed, 0.0f));
+    pushConstants.exposureCompensation = settings.exposureCompensation;
+    pushConstants.sampleCount = halfWidth * halfHeight;
+    pushConstants.autoExposure = settings.autoExposure ? 1 : 0;
+    pushConstants.manualExposure = settings.manualExposure;
+    pushConstants.toneMapper = static_cast<int>(settings.toneMapper);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+    VkCommandBuffer commandBuffer = commandBuffers[frameIndex];
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to begin recording command buffer!");
+    }
+
+    // 显示图像：SHADER_READ_ONLY -> GENERAL
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = toneMappingResourceManager->getDisplayImages()[imageIndex];
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+
+    // 等待降噪写完输入，以及上一帧对直方图的读取结束后再清零
+    VkMemoryBarrier memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier,
+                         0, nullptr, 1, &barrier);
+
+    vkCmdFillBuffer(commandBuffer, toneMappingResourceManager->getHistogramBuffer(), 0, VK_WHOLE_SIZE, 0);
+
+    VkMemoryBarrier clearBarrier{};
+    clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1,
+                         &clearBarrier, 0, nullptr, 0, nullptr);
+
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1,
+                            &descriptorSets[imageIndex], 0, nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                       sizeof(ToneMappingPushConstants), &pushConstants);
+
+    // 每个 pass 的结果是下一个 pass 的输入
+    VkMemoryBarrier dispatchBarrier{};
+    dispatchBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    dispatchBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    dispatchBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    uint32_t localSize = 16; // 计算着色器中定义的工作组大小
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, histogramPipeline);
+    vkCmdDispatch(commandBuffer, (halfWidth + localSize - 1) / localSize, (halfHeight + localSize - 1) / localSize,
+                  1);
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         1, &dispatchBarrier, 0, nullptr, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, exposurePipeline);
+    vkCmdDispatch(commandBuffer, 1, 1, 1);
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         1, &dispatchBarrier, 0, nullptr, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, toneMappingPipeline);
+    vkCmdDispatch(commandBuffer, (imageExtent.width + localSize - 1) / localSize,
+                  (imageExtent.height + localSize - 1) / localSize, 1);
+
+    // 显示图像：GENERAL -> SHADER_READ_ONLY，由 ImGui 在片元着色器中采样
+    barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+
+    return commandBuffer;
+}
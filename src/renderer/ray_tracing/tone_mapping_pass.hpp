@@ -0,0 +1,101 @@
+#pragma once
+
+#include "svg_filter_resource_manager.hpp"
+#include "swap_chain_manager.hpp"
+#include "tone_mapping_resource_manager.hpp"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+class ToneMappingPassObserver;
+
+// 自动曝光与色调映射：半分辨率 log2 亮度直方图 -> 单个工作组归约出平均亮度并随时间适应 -> 曝光、
+// Reinhard / ACES 色调映射与 sRGB 编码，写入 ImGui 显示的 8 位图像
+class ToneMappingPass
+{
+  public:
+    void init(VkDevice device, VkPhysicalDevice physicalDevice, SwapChainManager& swapChainManager,
+              SVGFilterResourceManager& svgFilterResourceManager,
+              ToneMappingResourceManager& toneMappingResourceManager, std::vector<VkCommandBuffer>&& commandBuffers);
+    void cleanup();
+
+    VkCommandBuffer recordCommandBuffer(uint32_t frameIndex, uint32_t imageIndex);
+
+    void updateInputDescriptorSets();
+
+    void updateDisplayDescriptorSets();
+
+  private:
+    // 与 shader/tone_mapping_common.glsl 中的 push_constant 块一致
+    struct ToneMappingPushConstants
+    {
+        float minLogLuminance;
+        float logLuminanceRange;
+        float adaptationRate;
+        float exposureCompensation;
+        uint32_t sampleCount;
+        int autoExposure;
+        float manualExposure;
+        int toneMapper;
+    };
+
+    VkDevice device;
+    VkPhysicalDevice physicalDevice;
+
+    SVGFilterResourceManager* svgFilterResourceManager = nullptr; // 输入为降噪输出
+    ToneMappingResourceManager* toneMappingResourceManager = nullptr;
+    uint32_t imageCount;
+
+    std::vector<VkCommandBuffer> commandBuffers;
+
+    VkPipeline histogramPipeline = VK_NULL_HANDLE;
+    VkPipeline exposurePipeline = VK_NULL_HANDLE;
+    VkPipeline toneMappingPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> descriptorSets; // 每个交换链图像一个
+
+    // 亮度适应按真实经过的时间计算，与帧率无关
+    std::chrono::steady_clock::time_point lastRecordTime;
+    bool hasRecorded = false;
+
+    std::unique_ptr<ToneMappingPassObserver> toneMappingPassObserver;
+
+    bool isSubgroupReductionSupported() const;
+    VkPipeline createComputePipeline(const std::string& shaderPath, bool subgroupReduction = false);
+    void createPipelines();
+    void createDescriptorSetLayout();
+    void createDescriptorPool();
+    void createDescriptorSets();
+};
+
+class ToneMappingPassObserver : public SVGFilterImageRecreateObserver, public DisplayImageRecreateObserver
+{
+  public:
+    ToneMappingPassObserver(ToneMappingPass* toneMappingPass) : toneMappingPass(toneMappingPass)
+    {
+    }
+
+    void onSVGFilterImageRecreated() override
+    {
+        if (toneMappingPass)
+        {
+            toneMappingPass->updateInputDescriptorSets();
+        }
+    }
+
+    void onDisplayImagesRecreated() override
+    {
+        if (toneMappingPass)
+        {
+            toneMappingPass->updateDisplayDescriptorSets();
+        }
+    }
+
+  private:
+    ToneMappingPass* toneMappingPass = nullptr;
+};
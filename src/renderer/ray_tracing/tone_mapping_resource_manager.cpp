@@ -0,0 +1,161 @@
+#include "tone_mapping_resource_manager.hpp"
+#include "vulkan_utils.hpp"
+#include <cstring>
+#include <stdexcept>
+
+void ToneMappingResourceManager::init(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue,
+                                      SwapChainManager& swapChainManager, CommandManager& commandManager)
+{
+    this->device = device;
+    this->physicalDevice = physicalDevice;
+    this->graphicsQueue = graphicsQueue;
+    this->outPutExtent = swapChainManager.getSwapChainExtent();
+    this->imageCount = swapChainManager.getSwapChainImages().size();
+    this->commandManager = &commandManager;
+
+    createDisplayImages();
+    createBuffers();
+    createSampler();
+}
+
+void ToneMappingResourceManager::cleanup()
+{
+    destroyDisplayImages();
+
+    if (exposureBuffer != VK_NULL_HANDLE)
+    {
+        vkUnmapMemory(device, exposureBufferMemory);
+        vkDestroyBuffer(device, exposureBuffer, nullptr);
+        vkFreeMemory(device, exposureBufferMemory, nullptr);
+        exposureBuffer = VK_NULL_HANDLE;
+        exposureBufferMapped = nullptr;
+    }
+    if (histogramBuffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(device, histogramBuffer, nullptr);
+        vkFreeMemory(device, histogramBufferMemory, nullptr);
+        histogramBuffer = VK_NULL_HANDLE;
+    }
+    if (luminanceSampler != VK_NULL_HANDLE)
+    {
+        vkDestroySampler(device, luminanceSampler, nullptr);
+        luminanceSampler = VK_NULL_HANDLE;
+    }
+}
+
+void ToneMappingResourceManager::recreateDisplayImages(VkExtent2D imageExtent)
+{
+    vkDeviceWaitIdle(device); // 等待设备空闲
+    destroyDisplayImages();
+    this->outPutExtent = imageExtent;
+    createDisplayImages();
+
+    for (auto observer : displayImageRecreateObservers)
+    {
+        observer->onDisplayImagesRecreated(); // 通知观察者
+    }
+}
+
+void ToneMappingResourceManager::destroyDisplayImages()
+{
+    for (uint32_t i = 0; i < displayImages.size(); ++i)
+    {
+        vkDestroyImageView(device, displayImageViews[i], nullptr);
+        vkDestroyImageView(device, displayStorageImageViews[i], nullptr);
+        vkDestroyImage(device, displayImages[i], nullptr);
+        vkFreeMemory(device, displayImageMemories[i], nullptr);
+    }
+    displayImageViews.clear();
+    displayStorageImageViews.clear();
+    displayImages.clear();
+    displayImageMemories.clear();
+}
+
+void ToneMappingResourceManager::createDisplayImages()
+{
+    displayImages.resize(imageCount);
+    displayImageMemories.resize(imageCount);
+    displayStorageImageViews.resize(imageCount);
+    displayImageViews.resize(imageCount);
+
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+
+    // SRGB 格式通常不支持 storage，写入走 UNORM 视图；需要 MUTABLE_FORMAT 才能再建 SRGB 视图
+    VkFormat storageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    VkFormat sampledFormat = VK_FORMAT_R8G8B8A8_SRGB;
+    for (uint32_t i = 0; i < imageCount; ++i)
+    {
+        vulkanUtils.createImage(device, physicalDevice, outPutExtent.width, outPutExtent.height, storageFormat,
+                                VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, displayImages[i], displayImageMemories[i],
+                                VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT);
+
+        displayStorageImageViews[i] =
+            vulkanUtils.createImageView(device, displayImages[i], storageFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+
+        // SRGB 视图只用于采样，不继承图像的 storage 用途
+        VkImageViewUsageCreateInfo viewUsageInfo{};
+        viewUsageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+        viewUsageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT;
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.pNext = &viewUsageInfo;
+        viewInfo.image = displayImages[i];
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = sampledFormat;
+        viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        if (vkCreateImageView(device, &viewInfo, nullptr, &displayImageViews[i]) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create display image view!");
+        }
+
+        vulkanUtils.transitionImageLayout(device, commandManager->getCommandPool(), graphicsQueue, displayImages[i],
+                                          storageFormat, VK_IMAGE_LAYOUT_UNDEFINED,
+                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+}
+
+void ToneMappingResourceManager::createBuffers()
+{
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+
+    // 直方图每帧开始时清零
+    vulkanUtils.createBuffer(device, physicalDevice, HISTOGRAM_BIN_COUNT * sizeof(uint32_t),
+                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, histogramBuffer, histogramBufferMemory);
+
+    // 只有 8 字节，放在主机可见内存里，UI 可以直接读取当前曝光
+    vulkanUtils.createBuffer(device, physicalDevice, sizeof(ExposureData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                             exposureBuffer, exposureBufferMemory);
+    vkMapMemory(device, exposureBufferMemory, 0, sizeof(ExposureData), 0, &exposureBufferMapped);
+    // averageLuminance 为 0 表示还没有统计过，第一帧直接采用目标亮度
+    ExposureData initialData = {0.0f, 1.0f};
+    memcpy(exposureBufferMapped, &initialData, sizeof(ExposureData));
+}
+
+void ToneMappingResourceManager::createSampler()
+{
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.anisotropyEnable = VK_FALSE;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = 0.0f;
+
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &luminanceSampler) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create luminance sampler!");
+    }
+}
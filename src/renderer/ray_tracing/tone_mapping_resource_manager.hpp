@@ -0,0 +1,138 @@
+#pragma once
+
+#include "command_manager.hpp"
+#include "swap_chain_manager.hpp"
+#include <vector>
+#include <vulkan/vulkan.h>
+
+class DisplayImageRecreateObserver
+{
+  public:
+    virtual void onDisplayImagesRecreated() = 0;
+    virtual ~DisplayImageRecreateObserver() = default;
+};
+
+enum class ToneMapper
+{
+    Reinhard = 0,
+    ACES = 1,
+};
+
+// 自动曝光与色调映射的参数，由 ImGui 修改，每帧以 push constant 传入
+struct ToneMappingSettings
+{
+    bool autoExposure = true;
+    float exposureCompensation = 0.0f; // EV，叠加在自动曝光上
+    float manualExposure = 0.0f;       // EV，关闭自动曝光时使用
+    float adaptationSpeed = 2.0f;      // 每秒向目标亮度靠近的速率
+    float minLogLuminance = -10.0f;    // 直方图覆盖的 log2 亮度范围
+    float maxLogLuminance = 6.0f;
+    ToneMapper toneMapper = ToneMapper::ACES;
+};
+
+// 与 shader/tone_mapping_common.glsl 中的 ExposureData 一致
+struct ExposureData
+{
+    float averageLuminance;
+    float exposure;
+};
+
+// 显示图像：降噪输出经曝光与色调映射后的 8 位 sRGB 结果，ImGui 直接采样
+// 以 RGBA8_UNORM 创建并由着色器写入 sRGB 编码值，另建一个 SRGB 格式的视图供采样，采样时解码回线性，
+// 写入 sRGB 交换链时再由硬件编码，显示结果与之前直接显示线性值的路径一致
+class ToneMappingResourceManager
+{
+  public:
+    static constexpr uint32_t HISTOGRAM_BIN_COUNT = 256;
+
+    void init(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue,
+              SwapChainManager& swapChainManager, CommandManager& commandManager);
+
+    void cleanup();
+
+    void recreateDisplayImages(VkExtent2D imageExtent);
+
+    const std::vector<VkImage>& getDisplayImages() const
+    {
+        return displayImages;
+    }
+
+    // RGBA8_UNORM，色调映射 pass 以 storage image 写入
+    const std::vector<VkImageView>& getDisplayStorageImageViews() const
+    {
+        return displayStorageImageViews;
+    }
+
+    // RGBA8_SRGB，供 ImGui 采样
+    const std::vector<VkImageView>& getDisplayImageViews() const
+    {
+        return displayImageViews;
+    }
+
+    VkBuffer getHistogramBuffer() const
+    {
+        return histogramBuffer;
+    }
+
+    VkBuffer getExposureBuffer() const
+    {
+        return exposureBuffer;
+    }
+
+    // 主机可见，UI 读取的是最近一次完成的统计结果
+    const ExposureData& getExposureData() const
+    {
+        return *static_cast<const ExposureData*>(exposureBufferMapped);
+    }
+
+    // 双线性采样器，直方图在半分辨率上采样时一次取 2x2 像素的平均
+    VkSampler getLuminanceSampler() const
+    {
+        return luminanceSampler;
+    }
+
+    ToneMappingSettings& getSettings()
+    {
+        return settings;
+    }
+
+    VkExtent2D getOutputExtent() const
+    {
+        return outPutExtent;
+    }
+
+    void addDisplayImageRecreateObserver(DisplayImageRecreateObserver* observer)
+    {
+        displayImageRecreateObservers.push_back(observer);
+    }
+
+  private:
+    void createDisplayImages();
+    void destroyDisplayImages();
+    void createBuffers();
+    void createSampler();
+
+    VkDevice device;
+    VkPhysicalDevice physicalDevice;
+    VkQueue graphicsQueue;
+    VkExtent2D outPutExtent;
+    CommandManager* commandManager = nullptr;
+    uint32_t imageCount;
+    ToneMappingSettings settings;
+
+    std::vector<VkImage> displayImages;
+    std::vector<VkDeviceMemory> displayImageMemories;
+    std::vector<VkImageView> displayStorageImageViews;
+    std::vector<VkImageView> displayImageViews;
+
+    // 各帧按提交顺序使用，只需一份
+    VkBuffer histogramBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory histogramBufferMemory = VK_NULL_HANDLE;
+    VkBuffer exposureBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory exposureBufferMemory = VK_NULL_HANDLE;
+    void* exposureBufferMapped = nullptr;
+
+    VkSampler luminanceSampler = VK_NULL_HANDLE;
+
+    std::vector<DisplayImageRecreateObserver*> displayImageRecreateObservers;
+};
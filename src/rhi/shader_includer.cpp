@@ -0,0 +1,52 @@
+#include "shader_includer.hpp"
+#include "vulkan_utils.hpp"
+
+namespace
+{
+// shaderc_include_result 只保存指针，需要由我们持有字符串的生命周期
+struct IncludeData
+{
+    shaderc_include_result result;
+    std::string sourceName;
+    std::string content;
+};
+} // namespace
+
+shaderc_include_result* ShaderIncluder::GetInclude(const char* requestedSource, shaderc_include_type type,
+                                                   const char* requestingSource, size_t includeDepth)
+{
+    std::string path = requestedSource;
+    if (type == shaderc_include_type_relative)
+    {
+        std::string requesting = requestingSource;
+        size_t slash = requesting.find_last_of("/\\");
+        if (slash != std::string::npos)
+        {
+            path = requesting.substr(0, slash + 1) + requestedSource;
+        }
+    }
+
+    auto* data = new IncludeData();
+    data->content = VulkanUtils::getInstance().readFileToString(path);
+    if (data->content.empty())
+    {
+        // sourceName 为空表示包含失败，content 中放错误信息
+        data->content = "failed to open include file: " + path;
+    }
+    else
+    {
+        data->sourceName = path;
+    }
+
+    data->result.source_name = data->sourceName.c_str();
+    data->result.source_name_length = data->sourceName.size();
+    data->result.content = data->content.c_str();
+    data->result.content_length = data->content.size();
+    data->result.user_data = data;
+    return &data->result;
+}
+
+void ShaderIncluder::ReleaseInclude(shaderc_include_result* data)
+{
+    delete static_cast<IncludeData*>(data->user_data);
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <shaderc/shaderc.hpp>
+#include <string>
+
+// 为 shaderc 提供 #include 支持，被包含文件相对于请求文件所在目录解析
+class ShaderIncluder : public shaderc::CompileOptions::IncluderInterface
+{
+  public:
+    shaderc_include_result* GetInclude(const char* requestedSource, shaderc_include_type type,
+                                       const char* requestingSource, size_t includeDepth) override;
+
+    void ReleaseInclude(shaderc_include_result* data) override;
+};
@@ -2,8 +2,18 @@
 #include "vulkan_utils.hpp"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h> // 用于加载 HDR 图像
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
 #include <stdexcept>
 
+namespace
+{
+constexpr uint32_t MATERIAL_TEXTURE_RESIDENT_SIZE = 64; // 加载时只上传边长不超过该值的 mip，其余按需上传
+constexpr uint32_t MAX_MIP_UPLOADS_PER_FRAME = 2;       // 每帧最多上传的 mip 层数，避免卡顿
+} // namespace
+
 void TextureResourceManager::init(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue,
                                   CommandManager& commandManager)
 {
@@ -21,6 +31,10 @@ void TextureResourceManager::init(VkDevice device, VkPhysicalDevice physicalDevi
     createIrradianceMapSampler();
     createPrefilteredMapSampler();
     createBRDFLUTSampler();
+
+    createMaterialTextureSampler();
+    createMaterialTextureStreamingBuffers();
+    defaultMaterialTexture = createMaterialTexture({255, 255, 255, 255}, 1, 1);
 }
 
 void TextureResourceManager::cleanup()
@@ -28,6 +42,10 @@ void TextureResourceManager::cleanup()
     vkDestroyImageView(device, sourceHDRImageView, nullptr);
     vkDestroyImage(device, sourceHDRImage, nullptr);
     vkFreeMemory(device, sourceHDRImageMemory, nullptr);
+    vkDestroySampler(device, sourceHDRSampler, nullptr);
+
+    vkDestroyBuffer(device, environmentDistributionBuffer, nullptr);
+    vkFreeMemory(device, environmentDistributionBufferMemory, nullptr);
 
     vkDestroyImageView(device, environmentMapImageView, nullptr);
     vkDestroyImage(device, environmentMapImage, nullptr);
@@ -64,6 +82,23 @@ void TextureResourceManager::cleanup()
     vkDestroySampler(device, irradianceMapSampler, nullptr);
     vkDestroySampler(device, prefilteredMapSampler, nullptr);
     vkDestroySampler(device, brdfLUTSampler, nullptr);
+
+    destroyMaterialTextures();
+    destroyMaterialTexture(defaultMaterialTexture);
+    vkDestroySampler(device, materialTextureSampler, nullptr);
+    for (size_t i = 0; i < materialTextureStreamingBuffers.size(); i++)
+    {
+        vkDestroyBuffer(device, materialTextureStreamingBuffers[i], nullptr);
+        vkFreeMemory(device, materialTextureStreamingBufferMemory[i], nullptr);
+    }
+    for (size_t i = 0; i < materialTextureStagingBuffers.size(); i++)
+    {
+        if (materialTextureStagingBuffers[i] != VK_NULL_HANDLE)
+        {
+            vkDestroyBuffer(device, materialTextureStagingBuffers[i], nullptr);
+            vkFreeMemory(device, materialTextureStagingBufferMemory[i], nullptr);
+        }
+    }
 }
 
 VkImageView TextureResourceManager::loadHDRTexture(const std::string& hdrPath)
@@ -92,6 +127,8 @@ VkImageView TextureResourceManager::loadHDRTexture(const std::string& hdrPath)
     memcpy(data, pixels, static_cast<size_t>(imageSize));
     vkUnmapMemory(device, stagingBufferMemory);
 
+    createEnvironmentDistribution(pixels, texWidth, texHeight);
+
     stbi_image_free(pixels);
 
     vulkanUtils.createImage(device, physicalDevice, texWidth, texHeight, VK_FORMAT_R32G32B32A32_SFLOAT,
@@ -110,6 +147,101 @@ VkImageView TextureResourceManager::loadHDRTexture(const std::string& hdrPath)
 
     vkDestroyBuffer(device, stagingBuffer, nullptr);
     vkFreeMemory(device, stagingBufferMemory, nullptr);
+
+    createSourceHDRSampler();
+
+    return sourceHDRImageView;
+}
+
+// 为路径追踪的环境光重要性采样构建分段常数分布
+// 权重为 luminance * sin(theta)，先按行求条件 CDF，再对行积分求边缘 CDF
+// 行/列与 equirect 贴图的 uv 一一对应 (v = asin(y) / PI + 0.5)
+void TextureResourceManager::createEnvironmentDistribution(const float* pixels, int width, int height)
+{
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+
+    const size_t w = static_cast<size_t>(width);
+    const size_t h = static_cast<size_t>(height);
+    const size_t headerSize = 4;
+    const size_t marginalOffset = headerSize;
+    const size_t conditionalOffset = marginalOffset + (h + 1);
+    const size_t pdfOffset = conditionalOffset + h * (w + 1);
+    std::vector<float> data(pdfOffset + w * h, 0.0f);
+
+    std::vector<float> func(w * h);
+    for (size_t row = 0; row < h; row++)
+    {
+        float sinTheta = std::sin(3.14159265359f * (static_cast<float>(row) + 0.5f) / static_cast<float>(h));
+        for (size_t col = 0; col < w; col++)
+        {
+            const float* p = pixels + (row * w + col) * 4;
+            float luminance = 0.2126f * p[0] + 0.7152f * p[1] + 0.0722f * p[2];
+            func[row * w + col] = std::max(luminance, 0.0f) * sinTheta;
+        }
+    }
+
+    std::vector<float> rowIntegrals(h);
+    for (size_t row = 0; row < h; row++)
+    {
+        float* cdf = data.data() + conditionalOffset + row * (w + 1);
+        cdf[0] = 0.0f;
+        for (size_t col = 0; col < w; col++)
+        {
+            cdf[col + 1] = cdf[col] + func[row * w + col] / static_cast<float>(w);
+        }
+        rowIntegrals[row] = cdf[w];
+        for (size_t col = 1; col <= w; col++)
+        {
+            // 整行为黑时退化为均匀分布
+            cdf[col] = rowIntegrals[row] > 0.0f ? cdf[col] / rowIntegrals[row]
+                                                : static_cast<float>(col) / static_cast<float>(w);
+        }
+    }
+
+    float* marginal = data.data() + marginalOffset;
+    marginal[0] = 0.0f;
+    for (size_t row = 0; row < h; row++)
+    {
+        marginal[row + 1] = marginal[row] + rowIntegrals[row] / static_cast<float>(h);
+    }
+    float integral = marginal[h];
+    for (size_t row = 1; row <= h; row++)
+    {
+        marginal[row] = integral > 0.0f ? marginal[row] / integral : static_cast<float>(row) / static_cast<float>(h);
+    }
+
+    // uv 空间的概率密度，∫∫ pdf du dv = 1
+    for (size_t i = 0; i < w * h; i++)
+    {
+        data[pdfOffset + i] = integral > 0.0f ? func[i] / integral : 1.0f;
+    }
+
+    uint32_t header[4] = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 0, 0};
+    std::memcpy(data.data(), header, sizeof(header));
+    data[2] = integral;
+
+    VkDeviceSize bufferSize = sizeof(float) * data.size();
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    vulkanUtils.createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
+                             stagingBufferMemory);
+
+    void* mapped;
+    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &mapped);
+    memcpy(mapped, data.data(), static_cast<size_t>(bufferSize));
+    vkUnmapMemory(device, stagingBufferMemory);
+
+    vulkanUtils.createBuffer(device, physicalDevice, bufferSize,
+                             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, environmentDistributionBuffer,
+                             environmentDistributionBufferMemory);
+    vulkanUtils.copyBuffer(device, commandManager->getCommandPool(), graphicsQueue, stagingBuffer,
+                           environmentDistributionBuffer, bufferSize);
+
+    vkDestroyBuffer(device, stagingBuffer, nullptr);
+    vkFreeMemory(device, stagingBufferMemory, nullptr);
 }
 
 void TextureResourceManager::createEnvironmentMap()
@@ -353,4 +485,395 @@ void TextureResourceManager::createBRDFLUTSampler()
     {
         throw std::runtime_error("Failed to create BRDF LUT sampler!");
     }
-}
\ No newline at end of file
+}
+
+// 源 HDR 采样器 (Equirectangular):
+// 目的：路径追踪中直接查询环境光
+// 过滤模式：线性
+// U 方向重复 (经度环绕)，V 方向截断
+void TextureResourceManager::createSourceHDRSampler()
+{
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.anisotropyEnable = VK_FALSE;
+    samplerInfo.maxAnisotropy = 1.0f;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = 0.0f;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &sourceHDRSampler) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create source HDR sampler!");
+    }
+}
+
+void TextureResourceManager::initMaterialTextures(VertexResourceManager& vertexResourceManager)
+{
+    loadMaterialTextures(vertexResourceManager.getMaterialTexturePaths());
+    textureResourceManagerModelObserver =
+        std::make_unique<TextureResourceManagerModelObserver>(this, &vertexResourceManager);
+    vertexResourceManager.addModelReloadObserver(textureResourceManagerModelObserver.get());
+}
+
+void TextureResourceManager::loadMaterialTextures(const std::vector<std::string>& texturePaths)
+{
+    destroyMaterialTextures(); // 调用方保证 GPU 已空闲 (初始化或 reloadModel 中的 vkDeviceWaitIdle)
+    if (texturePaths.size() > MAX_MATERIAL_TEXTURES)
+    {
+        std::cerr << "Warning: " << texturePaths.size() << " material textures exceed the limit of "
+                  << MAX_MATERIAL_TEXTURES << ", extra textures are ignored." << std::endl;
+    }
+
+    size_t textureCount = std::min<size_t>(texturePaths.size(), MAX_MATERIAL_TEXTURES);
+    for (size_t i = 0; i < textureCount; i++)
+    {
+        int texWidth, texHeight, texChannels;
+        stbi_uc* pixels = stbi_load(texturePaths[i].c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+        if (!pixels)
+        {
+            // 保持下标不变，缺失的贴图用白色代替
+            std::cerr << "Failed to load material texture: " << texturePaths[i] << std::endl;
+            materialTextures.push_back(createMaterialTexture({255, 255, 255, 255}, 1, 1));
+            continue;
+        }
+        std::vector<unsigned char> data(pixels, pixels + static_cast<size_t>(texWidth) * texHeight * 4);
+        stbi_image_free(pixels);
+        materialTextures.push_back(
+            createMaterialTexture(std::move(data), static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight)));
+    }
+
+    for (size_t frame = 0; frame < materialTextureStreamingBuffersMapped.size(); frame++)
+    {
+        auto* streaming = static_cast<MaterialTextureStreaming*>(materialTextureStreamingBuffersMapped[frame]);
+        for (uint32_t i = 0; i < MAX_MATERIAL_TEXTURES; i++)
+        {
+            streaming->requestedMip[i] = UINT32_MAX;
+            streaming->residentMip[i] = i < materialTextures.size() ? float(materialTextures[i].residentMip) : 0.0f;
+        }
+    }
+}
+
+void TextureResourceManager::updateMaterialTextureStreaming(uint32_t currentFrame)
+{
+    // 需求来自该帧上一次的光栅化 pass，fence 之后可以直接读取
+    auto* streaming = static_cast<MaterialTextureStreaming*>(materialTextureStreamingBuffersMapped[currentFrame]);
+    std::vector<size_t> uploads;
+    VkDeviceSize uploadSize = 0;
+    for (size_t i = 0; i < materialTextures.size() && uploads.size() < MAX_MIP_UPLOADS_PER_FRAME; i++)
+    {
+        MaterialTexture& texture = materialTextures[i];
+        if (streaming->requestedMip[i] < texture.residentMip)
+        {
+            // 每次只细化一层，逐帧逼近需要的分辨率
+            uploads.push_back(i);
+            uploadSize += texture.mipPixels[texture.residentMip - 1].size();
+        }
+    }
+
+    if (!uploads.empty())
+    {
+        // 该帧的 fence 已等待，上一次使用的命令缓冲与暂存缓冲可以复用；
+        // 提交先于本帧的渲染提交进入同一队列，由 mip 上传之后的屏障保证着色器读到新数据，
+        // 本帧的 fence 同时覆盖这次提交
+        reserveMaterialTextureStagingBuffer(currentFrame, uploadSize);
+        VkCommandBuffer commandBuffer = materialTextureUploadCommandBuffers[currentFrame];
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkResetCommandBuffer(commandBuffer, 0);
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+        VkDeviceSize offset = 0;
+        for (size_t i : uploads)
+        {
+            MaterialTexture& texture = materialTextures[i];
+            uint32_t mip = texture.residentMip - 1;
+            recordMaterialTextureMipUpload(commandBuffer, texture, mip, mip, false,
+                                           materialTextureStagingBuffers[currentFrame], offset,
+                                           materialTextureStagingBuffersMapped[currentFrame]);
+            offset += texture.mipPixels[mip].size();
+            texture.residentMip = mip;
+        }
+
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to record material texture upload command buffer!");
+        }
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to submit material texture upload command buffer!");
+        }
+    }
+
+    for (uint32_t i = 0; i < MAX_MATERIAL_TEXTURES; i++)
+    {
+        streaming->requestedMip[i] = UINT32_MAX;
+        streaming->residentMip[i] = i < materialTextures.size() ? float(materialTextures[i].residentMip) : 0.0f;
+    }
+}
+
+std::vector<VkDescriptorImageInfo> TextureResourceManager::getMaterialTextureImageInfos() const
+{
+    std::vector<VkDescriptorImageInfo> imageInfos(MAX_MATERIAL_TEXTURES);
+    for (uint32_t i = 0; i < MAX_MATERIAL_TEXTURES; i++)
+    {
+        imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfos[i].imageView = i < materialTextures.size() ? materialTextures[i].view : defaultMaterialTexture.view;
+        imageInfos[i].sampler = materialTextureSampler;
+    }
+    return imageInfos;
+}
+
+MaterialTexture TextureResourceManager::createMaterialTexture(std::vector<unsigned char>&& pixels, uint32_t width,
+                                                              uint32_t height)
+{
+    MaterialTexture texture;
+    texture.mipExtents.push_back({width, height});
+    texture.mipPixels.push_back(std::move(pixels));
+
+    // CPU 上用 2x2 盒式滤波生成完整 mip 链，奇数边长时边缘像素重复
+    while (width > 1 || height > 1)
+    {
+        uint32_t nextWidth = std::max(width / 2, 1u);
+        uint32_t nextHeight = std::max(height / 2, 1u);
+        const std::vector<unsigned char>& src = texture.mipPixels.back();
+        std::vector<unsigned char> dst(static_cast<size_t>(nextWidth) * nextHeight * 4);
+        for (uint32_t y = 0; y < nextHeight; y++)
+        {
+            for (uint32_t x = 0; x < nextWidth; x++)
+            {
+                uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+                uint32_t y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    uint32_t sum = src[(y0 * width + x0) * 4 + c] + src[(y0 * width + x1) * 4 + c] +
+                                   src[(y1 * width + x0) * 4 + c] + src[(y1 * width + x1) * 4 + c];
+                    dst[(y * nextWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+        width = nextWidth;
+        height = nextHeight;
+        texture.mipExtents.push_back({width, height});
+        texture.mipPixels.push_back(std::move(dst));
+    }
+
+    uint32_t mipLevels = static_cast<uint32_t>(texture.mipExtents.size());
+    texture.residentMip = mipLevels - 1;
+    for (uint32_t level = 0; level < mipLevels; level++)
+    {
+        if (std::max(texture.mipExtents[level].width, texture.mipExtents[level].height) <=
+            MATERIAL_TEXTURE_RESIDENT_SIZE)
+        {
+            texture.residentMip = level;
+            break;
+        }
+    }
+
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+    vulkanUtils.createImage(device, physicalDevice, texture.mipExtents[0].width, texture.mipExtents[0].height,
+                            VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL,
+                            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture.image, texture.memory, 0, 1, mipLevels);
+    uploadMaterialTextureMips(texture, texture.residentMip, mipLevels - 1);
+    // 视图覆盖完整 mip 链，流式上传时不需要更新描述符
+    texture.view = vulkanUtils.createImageView(device, texture.image, VK_FORMAT_R8G8B8A8_UNORM,
+                                               VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_VIEW_TYPE_2D, 1, 0, mipLevels, 0);
+    return texture;
+}
+
+void TextureResourceManager::uploadMaterialTextureMips(MaterialTexture& texture, uint32_t firstMip, uint32_t lastMip)
+{
+    // 加载时的首次上传，阻塞直到完成
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+    VkDeviceSize bufferSize = 0;
+    for (uint32_t level = firstMip; level <= lastMip; level++)
+    {
+        bufferSize += texture.mipPixels[level].size();
+    }
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    vulkanUtils.createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
+                             stagingBufferMemory);
+
+    void* data;
+    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
+    VkCommandPool commandPool = commandManager->getCommandPool();
+    VkCommandBuffer commandBuffer = vulkanUtils.beginSingleTimeCommands(device, commandPool);
+    recordMaterialTextureMipUpload(commandBuffer, texture, firstMip, lastMip, true, stagingBuffer, 0, data);
+    vkUnmapMemory(device, stagingBufferMemory);
+    vulkanUtils.endSingleTimeCommands(device, commandPool, graphicsQueue, commandBuffer);
+
+    vkDestroyBuffer(device, stagingBuffer, nullptr);
+    vkFreeMemory(device, stagingBufferMemory, nullptr);
+}
+
+// 把 [firstMip, lastMip] 的像素写入暂存缓冲的 stagingOffset 处，并记录拷贝与前后的布局转换
+void TextureResourceManager::recordMaterialTextureMipUpload(VkCommandBuffer commandBuffer, MaterialTexture& texture,
+                                                            uint32_t firstMip, uint32_t lastMip, bool initialUpload,
+                                                            VkBuffer stagingBuffer, VkDeviceSize stagingOffset,
+                                                            void* stagingData)
+{
+    std::vector<VkBufferImageCopy> regions;
+    VkDeviceSize offset = stagingOffset;
+    for (uint32_t level = firstMip; level <= lastMip; level++)
+    {
+        memcpy(static_cast<unsigned char*>(stagingData) + offset, texture.mipPixels[level].data(),
+               texture.mipPixels[level].size());
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {texture.mipExtents[level].width, texture.mipExtents[level].height, 1};
+        regions.push_back(region);
+        offset += texture.mipPixels[level].size();
+    }
+
+    // 首次上传时把所有层级都转换到可采样布局，未上传的层级内容未定义但不会被采样；
+    // 流式上传时之前的帧可能仍在采样该图像 (读后写)，布局转换需要等待这些着色器阶段
+    uint32_t mipLevels = static_cast<uint32_t>(texture.mipExtents.size());
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = initialUpload ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = texture.image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = initialUpload ? 0 : firstMip;
+    barrier.subresourceRange.levelCount = initialUpload ? mipLevels : lastMip - firstMip + 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    VkPipelineStageFlags srcStage = initialUpload
+                                        ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT
+                                        : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    vkCmdPipelineBarrier(commandBuffer, srcStage, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                         &barrier);
+
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0,
+                         nullptr, 1, &barrier);
+}
+
+// 暂存缓冲按需增大；调用前该帧的 fence 已等待，旧缓冲不再被 GPU 使用
+void TextureResourceManager::reserveMaterialTextureStagingBuffer(uint32_t currentFrame, VkDeviceSize size)
+{
+    if (size <= materialTextureStagingBufferSizes[currentFrame])
+    {
+        return;
+    }
+    if (materialTextureStagingBuffers[currentFrame] != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(device, materialTextureStagingBuffers[currentFrame], nullptr);
+        vkFreeMemory(device, materialTextureStagingBufferMemory[currentFrame], nullptr);
+    }
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+    vulkanUtils.createBuffer(device, physicalDevice, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                             materialTextureStagingBuffers[currentFrame],
+                             materialTextureStagingBufferMemory[currentFrame]);
+    vkMapMemory(device, materialTextureStagingBufferMemory[currentFrame], 0, size, 0,
+                &materialTextureStagingBuffersMapped[currentFrame]);
+    materialTextureStagingBufferSizes[currentFrame] = size;
+}
+
+void TextureResourceManager::destroyMaterialTexture(MaterialTexture& texture)
+{
+    vkDestroyImageView(device, texture.view, nullptr);
+    vkDestroyImage(device, texture.image, nullptr);
+    vkFreeMemory(device, texture.memory, nullptr);
+    texture = MaterialTexture{};
+}
+
+void TextureResourceManager::destroyMaterialTextures()
+{
+    for (auto& texture : materialTextures)
+    {
+        destroyMaterialTexture(texture);
+    }
+    materialTextures.clear();
+}
+
+void TextureResourceManager::createMaterialTextureStreamingBuffers()
+{
+    VkDeviceSize bufferSize = sizeof(MaterialTextureStreaming);
+    materialTextureStreamingBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    materialTextureStreamingBufferMemory.resize(MAX_FRAMES_IN_FLIGHT);
+    materialTextureStreamingBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+    materialTextureUploadCommandBuffers = commandManager->allocateCommandBuffers(MAX_FRAMES_IN_FLIGHT);
+    materialTextureStagingBuffers.assign(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+    materialTextureStagingBufferMemory.assign(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+    materialTextureStagingBuffersMapped.assign(MAX_FRAMES_IN_FLIGHT, nullptr);
+    materialTextureStagingBufferSizes.assign(MAX_FRAMES_IN_FLIGHT, 0);
+
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        vulkanUtils.createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                 materialTextureStreamingBuffers[i], materialTextureStreamingBufferMemory[i]);
+        vkMapMemory(device, materialTextureStreamingBufferMemory[i], 0, bufferSize, 0,
+                    &materialTextureStreamingBuffersMapped[i]);
+        auto* streaming = static_cast<MaterialTextureStreaming*>(materialTextureStreamingBuffersMapped[i]);
+        std::fill(std::begin(streaming->requestedMip), std::end(streaming->requestedMip), UINT32_MAX);
+        std::fill(std::begin(streaming->residentMip), std::end(streaming->residentMip), 0.0f);
+    }
+}
+
+// 材质贴图采样器:
+// 目的：光栅化与路径追踪中采样基础色 / 粗糙度 / 金属度 / 法线贴图
+// 过滤模式：三线性 + 各向异性，UV 重复
+// maxLod 不限制，实际可用的层级由着色器按驻留信息钳制
+void TextureResourceManager::createMaterialTextureSampler()
+{
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.anisotropyEnable = VK_TRUE;
+    samplerInfo.maxAnisotropy = 16;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &materialTextureSampler) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create material texture sampler!");
+    }
+}
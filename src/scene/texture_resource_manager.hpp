@@ -1,10 +1,36 @@
 #pragma once
 
 #include "command_manager.hpp"
+#include "vertex_resource_manager.hpp"
 #include <array>
+#include <memory>
 #include <string>
+#include <vector>
 #include <vulkan/vulkan.h>
 
+// 材质贴图数组的容量，与 shader 中的 MAX_MATERIAL_TEXTURES 一致；空位绑定 1x1 白色贴图
+constexpr uint32_t MAX_MATERIAL_TEXTURES = 128;
+
+// 材质贴图的 mip 驻留信息，布局与 shader 中的 MaterialTextureStreaming 一致 (std430)
+struct MaterialTextureStreaming
+{
+    uint32_t requestedMip[MAX_MATERIAL_TEXTURES]; // 光栅化着色器写入本帧需要的最精细 mip，CPU 读取后复位
+    float residentMip[MAX_MATERIAL_TEXTURES];     // 已上传的最精细 mip，着色器采样时不会越过它
+};
+
+// 一张材质贴图：图像包含完整的 mip 链，但只有 residentMip 及更粗的层级已上传
+struct MaterialTexture
+{
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+    uint32_t residentMip = 0;
+    std::vector<VkExtent2D> mipExtents;
+    std::vector<std::vector<unsigned char>> mipPixels; // CPU 侧保留的 RGBA8 mip 链，按需上传
+};
+
+class TextureResourceManagerModelObserver;
+
 class TextureResourceManager
 {
   public:
@@ -19,10 +45,33 @@ class TextureResourceManager
     void createPrefilteredMap();
     void createBRDFLUT();
 
+    // 加载模型引用的材质贴图，并在模型重新加载时重新加载
+    // 需在各管线之前注册观察者，保证管线刷新描述符时贴图已经重建
+    void initMaterialTextures(VertexResourceManager& vertexResourceManager);
+    void loadMaterialTextures(const std::vector<std::string>& texturePaths);
+    // 读取该帧的 mip 需求并上传更精细的层级，需在该帧的 fence 等待之后调用
+    void updateMaterialTextureStreaming(uint32_t currentFrame);
+
+    // 长度为 MAX_MATERIAL_TEXTURES，空位为默认贴图
+    std::vector<VkDescriptorImageInfo> getMaterialTextureImageInfos() const;
+    const std::vector<VkBuffer>& getMaterialTextureStreamingBuffers() const
+    {
+        return materialTextureStreamingBuffers;
+    }
+
     const VkImageView& getSourceHDRImageView() const
     {
         return sourceHDRImageView;
     }
+    const VkSampler& getSourceHDRSampler() const
+    {
+        return sourceHDRSampler;
+    }
+    // 环境光重要性采样分布：[width, height, integral, padding] + marginalCdf + conditionalCdf + pdf
+    const VkBuffer& getEnvironmentDistributionBuffer() const
+    {
+        return environmentDistributionBuffer;
+    }
     const VkImageView& getEnvironmentMapImageView() const
     {
         return environmentMapImageView;
@@ -78,6 +127,10 @@ class TextureResourceManager
     VkImage sourceHDRImage;
     VkDeviceMemory sourceHDRImageMemory;
     VkImageView sourceHDRImageView;
+    VkSampler sourceHDRSampler;
+
+    VkBuffer environmentDistributionBuffer;
+    VkDeviceMemory environmentDistributionBufferMemory;
 
     VkImage environmentMapImage;
     VkDeviceMemory environmentMapImageMemory;
@@ -103,8 +156,54 @@ class TextureResourceManager
     VkSampler prefilteredMapSampler;
     VkSampler brdfLUTSampler;
 
+    std::vector<MaterialTexture> materialTextures;
+    MaterialTexture defaultMaterialTexture;
+    VkSampler materialTextureSampler = VK_NULL_HANDLE;
+    std::vector<VkBuffer> materialTextureStreamingBuffers;
+    std::vector<VkDeviceMemory> materialTextureStreamingBufferMemory;
+    std::vector<void*> materialTextureStreamingBuffersMapped;
+    // 流式上传：每个 in-flight 帧一个命令缓冲与暂存缓冲，本帧的所有 mip 合并为一次提交，不等待队列空闲
+    std::vector<VkCommandBuffer> materialTextureUploadCommandBuffers;
+    std::vector<VkBuffer> materialTextureStagingBuffers;
+    std::vector<VkDeviceMemory> materialTextureStagingBufferMemory;
+    std::vector<void*> materialTextureStagingBuffersMapped;
+    std::vector<VkDeviceSize> materialTextureStagingBufferSizes;
+    std::unique_ptr<TextureResourceManagerModelObserver> textureResourceManagerModelObserver;
+
     void createEnvironmentMapSampler();
     void createIrradianceMapSampler();
     void createPrefilteredMapSampler();
     void createBRDFLUTSampler();
+    void createSourceHDRSampler();
+    void createEnvironmentDistribution(const float* pixels, int width, int height);
+    void createMaterialTextureSampler();
+    void createMaterialTextureStreamingBuffers();
+    MaterialTexture createMaterialTexture(std::vector<unsigned char>&& pixels, uint32_t width, uint32_t height);
+    void uploadMaterialTextureMips(MaterialTexture& texture, uint32_t firstMip, uint32_t lastMip);
+    void recordMaterialTextureMipUpload(VkCommandBuffer commandBuffer, MaterialTexture& texture, uint32_t firstMip,
+                                        uint32_t lastMip, bool initialUpload, VkBuffer stagingBuffer,
+                                        VkDeviceSize stagingOffset, void* stagingData);
+    void reserveMaterialTextureStagingBuffer(uint32_t currentFrame, VkDeviceSize size);
+    void destroyMaterialTexture(MaterialTexture& texture);
+    void destroyMaterialTextures();
+};
+
+class TextureResourceManagerModelObserver : public ModelReloadObserver
+{
+  public:
+    TextureResourceManagerModelObserver(TextureResourceManager* textureResourceManager,
+                                        VertexResourceManager* vertexResourceManager)
+        : textureResourceManager(textureResourceManager), vertexResourceManager(vertexResourceManager)
+    {
+    }
+
+    void onModelReloaded() override
+    {
+        // 模型重新加载后贴图集合可能变化
+        textureResourceManager->loadMaterialTextures(vertexResourceManager->getMaterialTexturePaths());
+    }
+
+  private:
+    TextureResourceManager* textureResourceManager;
+    VertexResourceManager* vertexResourceManager;
 };
\ No newline at end of file
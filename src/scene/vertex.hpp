@@ -16,6 +16,7 @@ struct Vertex
     glm::vec3 color;
     glm::vec3 normal;
     uint32_t materialID; // 新增材质 ID
+    glm::vec2 texCoord;  // 纹理坐标，OBJ 没有时为 0
 
     // 获取顶点绑定描述
     static VkVertexInputBindingDescription getBindingDescription()
@@ -29,9 +30,9 @@ struct Vertex
     }
 
     // 获取顶点属性描述
-    static std::array<VkVertexInputAttributeDescription, 4> getAttributeDescriptions()
+    static std::array<VkVertexInputAttributeDescription, 5> getAttributeDescriptions()
     {
-        std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{};
+        std::array<VkVertexInputAttributeDescription, 5> attributeDescriptions{};
 
         attributeDescriptions[0].binding = 0;
         attributeDescriptions[0].location = 0;
@@ -53,6 +54,11 @@ struct Vertex
         attributeDescriptions[3].format = VK_FORMAT_R32_UINT; // 材质 ID 是 uint 类型
         attributeDescriptions[3].offset = offsetof(Vertex, materialID);
 
+        attributeDescriptions[4].binding = 0;
+        attributeDescriptions[4].location = 4;
+        attributeDescriptions[4].format = VK_FORMAT_R32G32_SFLOAT;
+        attributeDescriptions[4].offset = offsetof(Vertex, texCoord);
+
         return attributeDescriptions;
     }
 
@@ -83,7 +89,7 @@ struct Vertex
     // 重载比较运算符
     bool operator==(const Vertex& other) const
     {
-        return pos == other.pos && color == other.color && normal == other.normal;
+        return pos == other.pos && color == other.color && normal == other.normal && texCoord == other.texCoord;
     }
 };
 
@@ -94,8 +100,10 @@ template <> struct hash<Vertex>
 {
     size_t operator()(const Vertex& vertex) const
     {
-        return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
-               (hash<glm::vec3>()(vertex.normal) << 1);
+        return ((((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
+                 (hash<glm::vec3>()(vertex.normal) << 1)) >>
+                1) ^
+               (hash<glm::vec2>()(vertex.texCoord) << 1);
     }
 };
 } // namespace std
\ No newline at end of file
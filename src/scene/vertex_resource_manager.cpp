@@ -1,6 +1,8 @@
 #include "vertex_resource_manager.hpp"
 #include "vulkan_utils.hpp"
+#include <algorithm>
 #include <cstring>
+#include <filesystem>
 #include <glm/gtc/matrix_transform.hpp>
 #include <stdexcept>
 #include <unordered_map>
@@ -34,10 +36,10 @@ void VertexResourceManager::cleanup()
         vkDestroyBuffer(device, uniformBuffers[i], nullptr);
         vkFreeMemory(device, uniformBuffersMemory[i], nullptr);
     }
-    for (size_t i = 0; i < materialUniformBuffers.size(); i++)
+    for (size_t i = 0; i < materialBuffers.size(); i++)
     {
-        vkDestroyBuffer(device, materialUniformBuffers[i], nullptr);
-        vkFreeMemory(device, materialUniformBuffersMemory[i], nullptr);
+        vkDestroyBuffer(device, materialBuffers[i], nullptr);
+        vkFreeMemory(device, materialBuffersMemory[i], nullptr);
     }
 }
 
@@ -168,6 +170,13 @@ void VertexResourceManager::loadModel(const std::string& modelPath, const std::s
                     vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f); // 默认朝上，或你后面再计算 face normal
                 }
 
+                // 纹理坐标（可能不存在），OBJ 的 v 轴向上，Vulkan 图像的 v 轴向下
+                if (idx.texcoord_index >= 0)
+                {
+                    vertex.texCoord = {attrib.texcoords[2 * idx.texcoord_index + 0],
+                                       1.0f - attrib.texcoords[2 * idx.texcoord_index + 1]};
+                }
+
                 vertex.color = color;
                 vertex.materialID = shapeIndex; // 设置材质 ID
                 if (uniqueVertices.count(vertex) == 0)
@@ -186,14 +195,63 @@ void VertexResourceManager::loadModel(const std::string& modelPath, const std::s
         {
             emission = 20.0f; // 如果是光源，设置自发光强度
         }
-        materialUniformBufferObjects.push_back(
-            std::make_shared<MaterialUniformBufferObject>(vertices.back().color, emission)); // 添加材质统一缓冲区对象
-        preMaterialUniformBufferObjects.push_back(
-            std::make_shared<MaterialUniformBufferObject>(vertices.back().color, emission));
+        auto material = std::make_shared<MaterialUniformBufferObject>(vertices.back().color, emission);
+
+        // 贴图取该形状第一个面的材质，路径相对 .mtl 所在目录
+        int shapeMaterialId = shape.mesh.material_ids.empty() ? -1 : shape.mesh.material_ids[0];
+        if (shapeMaterialId >= 0 && shapeMaterialId < static_cast<int>(materials.size()))
+        {
+            const auto& mat = materials[shapeMaterialId];
+            std::filesystem::path baseDir(materialPath);
+            if (!mat.diffuse_texname.empty())
+            {
+                material->albedoTexture = addMaterialTexture((baseDir / mat.diffuse_texname).string());
+            }
+            if (!mat.roughness_texname.empty())
+            {
+                material->roughnessTexture = addMaterialTexture((baseDir / mat.roughness_texname).string());
+                material->roughness = 1.0f; // 有贴图时常量作为系数
+            }
+            if (!mat.metallic_texname.empty())
+            {
+                material->metallicTexture = addMaterialTexture((baseDir / mat.metallic_texname).string());
+                material->metallic = 1.0f;
+            }
+            const std::string& normalTexname = !mat.normal_texname.empty() ? mat.normal_texname : mat.bump_texname;
+            if (!normalTexname.empty())
+            {
+                material->normalTexture = addMaterialTexture((baseDir / normalTexname).string());
+            }
+        }
+        if (material->albedoTexture < 0)
+        {
+            // 没有 .mtl 时使用模型旁边同名的 png 作为基础色贴图 (如 viking_room.obj / viking_room.png)
+            std::filesystem::path sidecarTexture = std::filesystem::path(modelPath).replace_extension(".png");
+            if (std::filesystem::exists(sidecarTexture))
+            {
+                material->albedoTexture = addMaterialTexture(sidecarTexture.string());
+            }
+        }
+
+        materialUniformBufferObjects.push_back(material); // 添加材质统一缓冲区对象
+        preMaterialUniformBufferObjects.push_back(std::make_shared<MaterialUniformBufferObject>(*material));
         shapeNames.push_back(shape.name); // 存储形状名称
     }
 }
 
+int VertexResourceManager::addMaterialTexture(const std::string& texturePath)
+{
+    // 多个材质引用同一张贴图时只加载一次
+    std::string normalizedPath = std::filesystem::path(texturePath).lexically_normal().string();
+    auto it = std::find(materialTexturePaths.begin(), materialTexturePaths.end(), normalizedPath);
+    if (it != materialTexturePaths.end())
+    {
+        return static_cast<int>(it - materialTexturePaths.begin());
+    }
+    materialTexturePaths.push_back(normalizedPath);
+    return static_cast<int>(materialTexturePaths.size()) - 1;
+}
+
 void VertexResourceManager::reloadModel(const std::string& modelPath, const std::string& materialPath)
 {
     vkDeviceWaitIdle(device);
@@ -201,6 +259,8 @@ void VertexResourceManager::reloadModel(const std::string& modelPath, const std:
     indices.clear();
     shapeNames.clear();
     materialUniformBufferObjects.clear();
+    preMaterialUniformBufferObjects.clear();
+    materialTexturePaths.clear();
     cleanup(); // 清理之前的资源
     // vkDestroyBuffer(device, vertexBuffer, nullptr);
     // vkFreeMemory(device, vertexBufferMemory, nullptr);
@@ -361,23 +421,58 @@ void VertexResourceManager::createUniformBuffers(size_t maxFramesInFlight)
 
     if (shapeNames.empty())
     {
-        std::cerr << "Error: No shapes loaded. Cannot create material uniform buffers." << std::endl;
+        std::cerr << "Error: No shapes loaded. Cannot create material buffers." << std::endl;
         return;
     }
-    // 创建材质统一缓冲区
+    // 创建材质存储缓冲区，大小随形状数量变化，着色器中为不定长数组
     bufferSize = sizeof(MaterialUniformBufferObject) * shapeNames.size();
-    materialUniformBuffers.resize(maxFramesInFlight);
-    materialUniformBuffersMemory.resize(maxFramesInFlight);
-    materialUniformBuffersMapped.resize(maxFramesInFlight);
+    materialBuffers.resize(maxFramesInFlight);
+    materialBuffersMemory.resize(maxFramesInFlight);
+    materialBuffersMapped.resize(maxFramesInFlight);
+    materialDirtyRanges.assign(maxFramesInFlight, {0, 0});
     for (size_t i = 0; i < maxFramesInFlight; i++)
     {
-        createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        createBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     materialUniformBuffers[i], materialUniformBuffersMemory[i]);
-        vkMapMemory(device, materialUniformBuffersMemory[i], 0, bufferSize, 0, &materialUniformBuffersMapped[i]);
+                     materialBuffers[i], materialBuffersMemory[i]);
+        vkMapMemory(device, materialBuffersMemory[i], 0, bufferSize, 0, &materialBuffersMapped[i]);
+        // 创建时整体写入一次，之后只写入变化的区间
+        auto* materials = static_cast<MaterialUniformBufferObject*>(materialBuffersMapped[i]);
+        for (size_t j = 0; j < shapeNames.size(); j++)
+        {
+            materials[j] = *materialUniformBufferObjects[j];
+        }
+    }
+}
+
+void VertexResourceManager::markMaterialDirty(size_t materialIndex)
+{
+    for (auto& range : materialDirtyRanges)
+    {
+        if (range.first == range.second)
+        {
+            range = {materialIndex, materialIndex + 1};
+        }
+        else
+        {
+            range.first = std::min(range.first, materialIndex);
+            range.second = std::max(range.second, materialIndex + 1);
+        }
     }
 }
 
+void VertexResourceManager::flushMaterialBuffer(uint32_t currentFrame)
+{
+    // fence 已保证该帧的缓冲区不再被 GPU 读取，只拷贝变化过的区间
+    auto& range = materialDirtyRanges[currentFrame];
+    auto* materials = static_cast<MaterialUniformBufferObject*>(materialBuffersMapped[currentFrame]);
+    for (size_t i = range.first; i < range.second; i++)
+    {
+        materials[i] = *materialUniformBufferObjects[i];
+    }
+    range = {0, 0};
+}
+
 void VertexResourceManager::updateUniformBuffer(uint32_t currentFrame, VkExtent2D swapChainExtent, Camera& camera)
 {
     // static auto startTime = std::chrono::high_resolution_clock::now();
@@ -405,44 +500,37 @@ void VertexResourceManager::updateUniformBuffer(uint32_t currentFrame, VkExtent2
     lightProjection[1][1] *= -1; // 反转Y轴
     ubo.lightSpaceMatrix = lightProjection * lightView * glm::mat4(1.0f);
 
-    memcpy(uniformBuffersMapped[currentFrame], &ubo, sizeof(ubo));
-
-    std::vector<MaterialUniformBufferObject> materialUbo(shapeNames.size());
+    // 第一帧或窗口尺寸变化 (G-buffer 重建) 后没有对应的上一帧矩阵，沿用本帧矩阵，运动向量为 0
+    glm::mat4 viewProj = ubo.proj * ubo.view;
+    bool hasLastViewProj = lastViewProjExtent.width == swapChainExtent.width &&
+                           lastViewProjExtent.height == swapChainExtent.height;
+    ubo.prevViewProj = hasLastViewProj ? lastViewProj : viewProj;
+    lastViewProj = viewProj;
+    lastViewProjExtent = swapChainExtent;
 
-    for (size_t i = 0; i < shapeNames.size(); i++)
-    {
-        materialUbo[i].albedo = materialUniformBufferObjects[i]->albedo;
-        materialUbo[i].metallic = materialUniformBufferObjects[i]->metallic;
-        materialUbo[i].roughness = materialUniformBufferObjects[i]->roughness;
-        materialUbo[i].ambientOcclusion = materialUniformBufferObjects[i]->ambientOcclusion;
-        materialUbo[i].emission = materialUniformBufferObjects[i]->emission;
-    }
-    memcpy(materialUniformBuffersMapped[currentFrame], materialUbo.data(),
-           sizeof(MaterialUniformBufferObject) * shapeNames.size());
+    memcpy(uniformBuffersMapped[currentFrame], &ubo, sizeof(ubo));
 
-    // 检查材质是否发生变化，并通知观察者
+    // 检查 ImGui 编辑过的材质，记录变化区间并通知观察者
     bool materialChanged = false;
     for (size_t i = 0; i < shapeNames.size(); i++)
     {
-        // 更新材质统一缓冲区对象
-        if (preMaterialUniformBufferObjects[i]->albedo != materialUbo[i].albedo)
-            materialChanged = true;
-        if (preMaterialUniformBufferObjects[i]->metallic != materialUbo[i].metallic)
-            materialChanged = true;
-        if (preMaterialUniformBufferObjects[i]->roughness != materialUbo[i].roughness)
-            materialChanged = true;
-        if (preMaterialUniformBufferObjects[i]->ambientOcclusion != materialUbo[i].ambientOcclusion)
+        const MaterialUniformBufferObject& material = *materialUniformBufferObjects[i];
+        MaterialUniformBufferObject& preMaterial = *preMaterialUniformBufferObjects[i];
+        if (preMaterial.albedo != material.albedo || preMaterial.metallic != material.metallic ||
+            preMaterial.roughness != material.roughness || preMaterial.ambientOcclusion != material.ambientOcclusion ||
+            preMaterial.emission != material.emission)
+        {
+            preMaterial = material;
+            markMaterialDirty(i);
             materialChanged = true;
+        }
+    }
+    if (!materialBuffersMapped.empty())
+    {
+        flushMaterialBuffer(currentFrame);
     }
     if (materialChanged)
     {
-        for (size_t i = 0; i < shapeNames.size(); i++)
-        {
-            preMaterialUniformBufferObjects[i]->albedo = materialUbo[i].albedo;
-            preMaterialUniformBufferObjects[i]->metallic = materialUbo[i].metallic;
-            preMaterialUniformBufferObjects[i]->roughness = materialUbo[i].roughness;
-            preMaterialUniformBufferObjects[i]->ambientOcclusion = materialUbo[i].ambientOcclusion;
-        }
         for (auto observer : materialUpdateObservers)
         {
             observer->onMaterialUpdated();
@@ -13,6 +13,7 @@
 #include <string>
 #include <tiny_obj_loader.h> // 包含 tinyobj_loader 库
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 const int MAX_FRAMES_IN_FLIGHT = 2;
@@ -25,6 +26,7 @@ struct UniformBufferObject
     glm::vec3 cameraPos; //
     float padding;       // 保持对齐（vec3 + float = 16字节）
     glm::mat4 lightSpaceMatrix;
+    glm::mat4 prevViewProj; // 上一帧的视图投影矩阵，G-buffer 用它输出运动向量
 };
 
 struct MaterialUniformBufferObject
@@ -35,9 +37,15 @@ struct MaterialUniformBufferObject
     alignas(4) float ambientOcclusion;
     alignas(4) float padding2; // 对齐
     alignas(4) float emission; // 自发光强度
+    // 材质贴图在纹理数组中的下标，-1 表示没有贴图；贴图值与上面的常量相乘
+    alignas(4) int albedoTexture;
+    alignas(4) int roughnessTexture;
+    alignas(4) int metallicTexture;
+    alignas(4) int normalTexture;
 
     MaterialUniformBufferObject(glm::vec3 albedo = glm::vec3(1.0f), float emission = 0.0f)
-        : albedo(albedo), metallic(0.0f), roughness(0.5f), ambientOcclusion(1.0f), padding2(0.0f), emission(emission)
+        : albedo(albedo), metallic(0.0f), roughness(0.5f), ambientOcclusion(1.0f), padding2(0.0f), emission(emission),
+          albedoTexture(-1), roughnessTexture(-1), metallicTexture(-1), normalTexture(-1)
     {
     }
 };
@@ -107,9 +115,9 @@ class VertexResourceManager
         return uniformBuffersMapped;
     };
 
-    std::vector<VkBuffer>& getMaterialUniformBuffers()
+    std::vector<VkBuffer>& getMaterialBuffers()
     {
-        return materialUniformBuffers;
+        return materialBuffers;
     };
 
     const std::vector<std::string>& getShapeNames() const
@@ -122,6 +130,12 @@ class VertexResourceManager
         return materialUniformBufferObjects;
     }
 
+    // 按路径去重后的材质贴图，下标即材质中的贴图序号
+    const std::vector<std::string>& getMaterialTexturePaths() const
+    {
+        return materialTexturePaths;
+    }
+
     float* getMetallics() const
     {
         return metallics;
@@ -172,10 +186,14 @@ class VertexResourceManager
     std::vector<VkBuffer> uniformBuffers;
     std::vector<VkDeviceMemory> uniformBuffersMemory;
     std::vector<void*> uniformBuffersMapped;
+    glm::mat4 lastViewProj = glm::mat4(1.0f);
+    VkExtent2D lastViewProjExtent = {0, 0}; // 写入 lastViewProj 时的窗口尺寸，0 表示还没有上一帧
 
-    std::vector<VkBuffer> materialUniformBuffers;
-    std::vector<VkDeviceMemory> materialUniformBuffersMemory;
-    std::vector<void*> materialUniformBuffersMapped;
+    // 材质存储缓冲区，数量不受限制；每帧只写入该帧缓冲区中变化过的区间
+    std::vector<VkBuffer> materialBuffers;
+    std::vector<VkDeviceMemory> materialBuffersMemory;
+    std::vector<void*> materialBuffersMapped;
+    std::vector<std::pair<size_t, size_t>> materialDirtyRanges; // 每个 in-flight 帧待写入的材质区间 [first, second)
 
     // std::unordered_map<std::string, tinyobj::material_t> materials; // 材质映射
     // std::unordered_map<std::string, tinyobj::shape_t> shapes; // 形状映射
@@ -186,6 +204,7 @@ class VertexResourceManager
     std::vector<std::string> shapeNames;                                                       // 形状名称数组
     std::vector<std::shared_ptr<MaterialUniformBufferObject>> materialUniformBufferObjects;    // 材质统一缓冲区对象
     std::vector<std::shared_ptr<MaterialUniformBufferObject>> preMaterialUniformBufferObjects; // 材质统一缓冲区对象
+    std::vector<std::string> materialTexturePaths;                                             // 去重后的贴图路径
 
     std::vector<ModelReloadObserver*> modelReloadObservers;      // 存储观察者
     std::vector<MaterialIpdateObsever*> materialUpdateObservers; // 存储材质更新观察者
@@ -195,6 +214,9 @@ class VertexResourceManager
                       VkDeviceMemory& bufferMemory);
     void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
     void generateNormals(tinyobj::attrib_t& attrib, std::vector<tinyobj::shape_t>& shapes);
+    int addMaterialTexture(const std::string& texturePath);
+    void markMaterialDirty(size_t materialIndex);
+    void flushMaterialBuffer(uint32_t currentFrame);
 
     // VertexResourceManager() = default;
 };
\ No newline at end of file
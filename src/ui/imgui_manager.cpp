@@ -7,16 +7,25 @@
 #include "vulkan_utils.hpp"
 #include <windows.h>
 #include <commdlg.h>
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
 #include <stdexcept>
+#include <utility>
 
 void ImGuiManager::init(GLFWwindow* window, VulkanContext& vulkanContext, SwapChainManager& swapChainManager,
-                        VertexResourceManager& vertexResourceManager, CommandManager& commandManager)
+                        VertexResourceManager& vertexResourceManager,
+                        PathTracingResourceManager& pathTracingResourceManager,
+                        SVGFilterResourceManager& svgFilterResourceManager,
+                        ToneMappingResourceManager& toneMappingResourceManager, CommandManager& commandManager)
 {
     // 创建 ImGui 上下文
     this->device = vulkanContext.getDevice();
     this->swapChainManager = &swapChainManager;
     this->vertexResourceManager = &vertexResourceManager;
+    this->pathTracingResourceManager = &pathTracingResourceManager;
+    this->svgFilterResourceManager = &svgFilterResourceManager;
+    this->toneMappingResourceManager = &toneMappingResourceManager;
     this->commandBuffers = commandManager.allocateCommandBuffers(2);
 
     this->preContentExtent = swapChainManager.getSwapChainExtent();
@@ -341,6 +350,250 @@ VkExtent2D ImGuiManager::renderImGuiInterface()
             ImGui::TreePop();
         }
     }
+
+    // 路径追踪设置，修改后会重置累积
+    if (ImGui::CollapsingHeader("Path Tracing", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        PathTracingSettings& settings = pathTracingResourceManager->getPathTracingSettings();
+        ImGui::Checkbox("ReSTIR DI", &settings.enableReSTIR);
+        ImGui::Checkbox("Unbounded Depth", &settings.unboundedDepth);
+        ImGui::BeginDisabled(settings.unboundedDepth);
+        ImGui::SliderInt("Max Bounces", &settings.maxBounces, 1, 32);
+        ImGui::EndDisabled();
+        ImGui::SliderInt("Roulette Min Depth", &settings.rouletteMinDepth, 0, 16);
+
+        // 固定几档比例，避免拖动滑块时每帧重建输出图像
+        const float renderScales[] = {1.0f, 0.75f, 0.5f, 0.25f};
+        const char* renderScaleNames[] = {"100%", "75%", "50%", "25%"};
+        int renderScaleIndex = 0;
+        for (int i = 0; i < IM_ARRAYSIZE(renderScales); ++i)
+        {
+            if (settings.renderScale == renderScales[i])
+            {
+                renderScaleIndex = i;
+            }
+        }
+        if (ImGui::Combo("Render Scale", &renderScaleIndex, renderScaleNames, IM_ARRAYSIZE(renderScaleNames)))
+        {
+            settings.renderScale = renderScales[renderScaleIndex];
+        }
+
+        // 萤火虫处理：无偏 / 路径正则化 / 按累积均值相对截断
+        const char* fireflyModeNames[] = {"Unbiased", "Path Regularization", "Relative Clamp"};
+        int fireflyModeIndex = static_cast<int>(settings.fireflyMode);
+        if (ImGui::Combo("Firefly Mode", &fireflyModeIndex, fireflyModeNames, IM_ARRAYSIZE(fireflyModeNames)))
+        {
+            settings.fireflyMode = static_cast<FireflyMode>(fireflyModeIndex);
+        }
+        if (settings.fireflyMode == FireflyMode::Regularize)
+        {
+            ImGui::SliderFloat("Regularization", &settings.regularizationStrength, 0.0f, 2.0f, "%.2f");
+        }
+        else if (settings.fireflyMode == FireflyMode::RelativeClamp)
+        {
+            ImGui::SliderFloat("Clamp Factor", &settings.fireflyClampFactor, 1.0f, 100.0f, "%.1f",
+                               ImGuiSliderFlags_Logarithmic);
+        }
+        // 存储精度：修改后在下一帧重新创建输出、上采样与降噪图像并重新编译着色器
+        const char* storagePrecisionNames[] = {"FP32", "FP16"};
+        int storagePrecisionIndex = static_cast<int>(settings.storagePrecision);
+        if (ImGui::Combo("Storage Precision", &storagePrecisionIndex, storagePrecisionNames,
+                         IM_ARRAYSIZE(storagePrecisionNames)))
+        {
+            settings.storagePrecision = static_cast<StoragePrecision>(storagePrecisionIndex);
+        }
+        // 半精度存储时总是使用 RGBA32F 的补偿求和
+        bool halfPrecision = pathTracingResourceManager->getStoragePrecision() == StoragePrecision::Half;
+        ImGui::BeginDisabled(halfPrecision);
+        ImGui::Checkbox("Kahan Accumulation", &settings.compensatedAccumulation);
+        ImGui::EndDisabled();
+        // 路径空间滤波：粗糙主顶点的间接光改用次级顶点所在哈希格子的跨帧均值，有偏但噪声低得多
+        ImGui::Checkbox("Path-Space Filtering", &settings.pathSpaceFiltering);
+        // 辐亮度缓存：缓存顶点命中已学习的格子时终止路径，只有一部分路径继续追踪以更新缓存
+        ImGui::Checkbox("Radiance Cache", &settings.radianceCache);
+        if (settings.radianceCache)
+        {
+            ImGui::SliderInt("Cache Bounce", &settings.radianceCacheBounce, 1, 2);
+            ImGui::SliderFloat("Update Rate", &settings.radianceCacheUpdateRate, 0.0f, 1.0f, "%.2f");
+        }
+        if (settings.pathSpaceFiltering || settings.radianceCache)
+        {
+            ImGui::SliderFloat("Cell Size", &settings.pathSpaceCellSize, 0.002f, 0.1f, "%.3f",
+                               ImGuiSliderFlags_Logarithmic);
+            // 每个格子 48 字节
+            const char* cacheSizeNames[] = {"64K cells (3 MB)", "256K cells (12 MB)", "1M cells (48 MB)",
+                                            "4M cells (192 MB)"};
+            int cacheSizeIndex = std::clamp((settings.pathSpaceCacheSizeLog2 - 16) / 2, 0, 3);
+            if (ImGui::Combo("Cache Size", &cacheSizeIndex, cacheSizeNames, IM_ARRAYSIZE(cacheSizeNames)))
+            {
+                settings.pathSpaceCacheSizeLog2 = 16 + cacheSizeIndex * 2;
+            }
+        }
+        VkExtent2D extent4K = {3840, 2160};
+        auto storageImageCount = static_cast<uint32_t>(pathTracingResourceManager->getPathTracingOutputImages().size());
+        uint64_t storage4K = estimateStorageImageBytes(pathTracingResourceManager->getStoragePrecision(),
+                                                       pathTracingResourceManager->getSampleImageFormat(), extent4K,
+                                                       extent4K, storageImageCount);
+        uint64_t fullStorage4K = estimateStorageImageBytes(StoragePrecision::Full, VK_FORMAT_R32G32B32A32_SFLOAT,
+                                                           extent4K, extent4K, storageImageCount);
+        ImGui::Text("Storage: %s  4K: %.0f MB (saves %.0f MB)", halfPrecision ? "FP16" : "FP32",
+                    storage4K / (1024.0 * 1024.0), (fullStorage4K - storage4K) / (1024.0 * 1024.0));
+        ImGui::Text("Avg Path Length: %.2f", pathTracingResourceManager->getAveragePathLength());
+
+        // 光线统计：读回的是 MAX_FRAMES_IN_FLIGHT 帧之前的结果
+        bool rayStatisticsEnabled = pathTracingResourceManager->isRayStatisticsEnabled();
+        if (ImGui::Checkbox("Ray Statistics", &rayStatisticsEnabled))
+        {
+            pathTracingResourceManager->setRayStatisticsEnabled(rayStatisticsEnabled);
+        }
+        if (rayStatisticsEnabled)
+        {
+            const RayStatistics& rays = pathTracingResourceManager->getRayStatistics();
+            uint64_t totalRays = rays.primaryRays + rays.bounceRays + rays.shadowRays;
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Log"))
+            {
+                pathTracingResourceManager->logRayStatistics();
+            }
+            double averageBounces =
+                rays.primaryRays > 0 ? static_cast<double>(rays.bounceRays) / rays.primaryRays : 0.0;
+            double nodesPerRay = totalRays > 0 ? static_cast<double>(rays.nodeVisits) / totalRays : 0.0;
+            double trianglesPerRay = totalRays > 0 ? static_cast<double>(rays.triangleTests) / totalRays : 0.0;
+            ImGui::Text("%.1f Mrays/s  Avg Bounces: %.2f", pathTracingResourceManager->getRaysPerSecond() * 1e-6,
+                        averageBounces);
+            ImGui::Text("Nodes/Ray: %.1f  Tris/Ray: %.1f", nodesPerRay, trianglesPerRay);
+        }
+
+        // 帧时间预算，按路径追踪 dispatch 的 GPU 耗时调整每帧 SPP
+        SampleBudgetSettings& budget = pathTracingResourceManager->getSampleBudgetSettings();
+        ImGui::Checkbox("Frame Budget", &budget.enabled);
+        ImGui::BeginDisabled(!budget.enabled);
+        ImGui::SliderFloat("Target (ms)", &budget.targetMilliseconds, 2.0f, 50.0f, "%.1f");
+        ImGui::SliderInt("Max SPP", &budget.maxSamplesPerFrame, 1, 256);
+        ImGui::EndDisabled();
+        ImGui::Text("Dispatch: %.2f ms  SPP: %u", pathTracingResourceManager->getDispatchMilliseconds(),
+                    budget.enabled ? pathTracingResourceManager->getSamplesPerPixel() : 1u);
+
+        // 收敛判定，修改后不会重置累积
+        ConvergenceSettings& convergence = pathTracingResourceManager->getConvergenceSettings();
+        ImGui::Checkbox("Stop When Converged", &convergence.stopWhenConverged);
+        ImGui::BeginDisabled(!convergence.stopWhenConverged);
+        ImGui::SliderFloat("Noise Target", &convergence.noiseTarget, 0.001f, 0.1f, "%.4f",
+                           ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderFloat("Converged Pixels", &convergence.convergedFraction, 0.5f, 1.0f, "%.3f");
+        ImGui::SliderInt("Max Samples", &convergence.maxSamples, 0, 65536, "%d", ImGuiSliderFlags_Logarithmic);
+        ImGui::EndDisabled();
+        ImGui::Text("Samples: %u  Converged: %.1f%%%s", pathTracingResourceManager->getTotalSampleCount(),
+                    pathTracingResourceManager->getConvergedPixelRatio() * 100.0f,
+                    pathTracingResourceManager->isConverged() ? "  (idle)" : "");
+
+        // 分块派发，修改后不会重置累积
+        TileDispatchSettings& tiles = pathTracingResourceManager->getTileDispatchSettings();
+        // 设备不支持子组 ballot 时常驻线程内核退回 tile 内核
+        const char* kernelNames[] = {"Tiled Workgroups", "Persistent Threads"};
+        int kernelIndex = static_cast<int>(tiles.kernel);
+        if (ImGui::Combo("Kernel", &kernelIndex, kernelNames, IM_ARRAYSIZE(kernelNames)))
+        {
+            tiles.kernel = static_cast<PathTracingKernel>(kernelIndex);
+        }
+        const int tileSizes[] = {16, 32, 64, 128};
+        const char* tileSizeNames[] = {"16", "32", "64", "128"};
+        int tileSizeIndex = 0;
+        for (int i = 0; i < IM_ARRAYSIZE(tileSizes); ++i)
+        {
+            if (tiles.tileSize == tileSizes[i])
+            {
+                tileSizeIndex = i;
+            }
+        }
+        if (ImGui::Combo("Tile Size", &tileSizeIndex, tileSizeNames, IM_ARRAYSIZE(tileSizeNames)))
+        {
+            tiles.tileSize = tileSizes[tileSizeIndex];
+        }
+        ImGui::SliderInt("Tiles Per Dispatch", &tiles.tilesPerDispatch, 1, 4096, "%d", ImGuiSliderFlags_Logarithmic);
+        // 默认值为设备能同时驻留的 256 线程工作组数 (NV/AMD 的计算单元扩展)，查询不到时为 128；
+        // 寄存器压力大时实际驻留数更少，多出的工作组排队领取 tile，不影响正确性
+        ImGui::SliderInt("Persistent Groups", &tiles.persistentWorkgroups, 1, 1024, "%d",
+                         ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderFloat("Submit Budget (ms)", &tiles.submitMilliseconds, 0.5f, 33.0f, "%.1f");
+        ImGui::Text("Tiles: %u  Dispatches: %u", pathTracingResourceManager->getTileCount(),
+                    (pathTracingResourceManager->getTileCount() + pathTracingResourceManager->getTilesPerDispatch() -
+                     1) / pathTracingResourceManager->getTilesPerDispatch());
+    }
+
+    // 降噪链：按列表顺序执行启用的 stage，修改后在下一帧重建
+    if (ImGui::CollapsingHeader("Denoiser", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        std::vector<DenoiserStageSettings>& stages = svgFilterResourceManager->getDenoiserChainSettings().stages;
+        for (size_t i = 0; i < stages.size(); ++i)
+        {
+            const DenoiserStageInfo& info = getDenoiserStageInfo(stages[i].type);
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::BeginDisabled(i == 0);
+            if (ImGui::ArrowButton("##up", ImGuiDir_Up))
+            {
+                std::swap(stages[i], stages[i - 1]);
+            }
+            ImGui::EndDisabled();
+            ImGui::SameLine();
+            ImGui::BeginDisabled(i + 1 == stages.size());
+            if (ImGui::ArrowButton("##down", ImGuiDir_Down))
+            {
+                std::swap(stages[i], stages[i + 1]);
+            }
+            ImGui::EndDisabled();
+            ImGui::SameLine();
+            ImGui::Checkbox(info.name, &stages[i].enabled);
+            ImGui::PopID();
+
+            std::string inputs;
+            for (uint32_t resource = DENOISER_RESOURCE_COLOR; resource <= DENOISER_RESOURCE_HISTORY; resource <<= 1)
+            {
+                if (info.inputs & resource)
+                {
+                    inputs += (inputs.empty() ? "" : ", ") +
+                              std::string(getDenoiserResourceName(static_cast<DenoiserResource>(resource)));
+                }
+            }
+            ImGui::TextDisabled("    In: %s", inputs.c_str());
+        }
+        // 只对光照降噪，纹理细节不参与滤波
+        DenoiserChainSettings& chainSettings = svgFilterResourceManager->getDenoiserChainSettings();
+        ImGui::Checkbox("Albedo Demodulation", &chainSettings.albedoDemodulation);
+        if (ImGui::Button("Reset Order"))
+        {
+            svgFilterResourceManager->getDenoiserChainSettings() = DenoiserChainSettings{};
+        }
+        ImGui::Text("Intermediate Images: %u", svgFilterResourceManager->getIntermediateImageCount());
+    }
+
+    // 曝光与色调映射只影响显示，不会重置累积
+    if (ImGui::CollapsingHeader("Tone Mapping", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        ToneMappingSettings& toneMapping = toneMappingResourceManager->getSettings();
+        ImGui::Checkbox("Auto Exposure", &toneMapping.autoExposure);
+        if (toneMapping.autoExposure)
+        {
+            ImGui::SliderFloat("Exposure Compensation", &toneMapping.exposureCompensation, -5.0f, 5.0f, "%.1f EV");
+            ImGui::SliderFloat("Adaptation Speed", &toneMapping.adaptationSpeed, 0.1f, 10.0f, "%.1f",
+                               ImGuiSliderFlags_Logarithmic);
+            ImGui::DragFloatRange2("Log Luminance", &toneMapping.minLogLuminance, &toneMapping.maxLogLuminance, 0.1f,
+                                   -20.0f, 20.0f, "%.1f");
+        }
+        else
+        {
+            ImGui::SliderFloat("Exposure", &toneMapping.manualExposure, -10.0f, 10.0f, "%.1f EV");
+        }
+        const char* toneMapperNames[] = {"Reinhard", "ACES"};
+        int toneMapperIndex = static_cast<int>(toneMapping.toneMapper);
+        if (ImGui::Combo("Tone Mapper", &toneMapperIndex, toneMapperNames, IM_ARRAYSIZE(toneMapperNames)))
+        {
+            toneMapping.toneMapper = static_cast<ToneMapper>(toneMapperIndex);
+        }
+        const ExposureData& exposure = toneMappingResourceManager->getExposureData();
+        ImGui::Text("Avg Luminance: %.4f  Exposure: %.3f (%.1f EV)", exposure.averageLuminance, exposure.exposure,
+                    std::log2(std::max(exposure.exposure, 1e-6f)));
+    }
     // std::vector<std::string> shapeNames = {"Cube", "Sphere", "Cylinder", "Plane"};
     // static  int currentShapeIndex = 0;
     // if (ImGui::BeginCombo("Shape", shapeNames[currentShapeIndex].c_str())) {
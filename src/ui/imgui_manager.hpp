@@ -8,7 +8,10 @@
 #endif
 #include "command_manager.hpp"
 #include "imgui.h"
+#include "path_tracing_resource_manager.hpp"
+#include "svg_filter_resource_manager.hpp"
 #include "swap_chain_manager.hpp"
+#include "tone_mapping_resource_manager.hpp"
 #include "vertex_resource_manager.hpp"
 #include "vulkan_context.hpp"
 
@@ -17,7 +20,9 @@ class ImGuiManager
   public:
     // 初始化 ImGui
     void init(GLFWwindow* window, VulkanContext& vulkanContext, SwapChainManager& swapChainManager,
-              VertexResourceManager& vertexResourceManager, CommandManager& commandManager);
+              VertexResourceManager& vertexResourceManager, PathTracingResourceManager& pathTracingResourceManager,
+              SVGFilterResourceManager& svgFilterResourceManager,
+              ToneMappingResourceManager& toneMappingResourceManager, CommandManager& commandManager);
 
     // 开始 ImGui 帧
     void beginFrame();
@@ -54,6 +59,9 @@ class ImGuiManager
   private:
     SwapChainManager* swapChainManager = nullptr;
     VertexResourceManager* vertexResourceManager = nullptr;
+    PathTracingResourceManager* pathTracingResourceManager = nullptr;
+    SVGFilterResourceManager* svgFilterResourceManager = nullptr;
+    ToneMappingResourceManager* toneMappingResourceManager = nullptr;
     VkDevice device = VK_NULL_HANDLE;
     VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
     VkRenderPass renderPass = VK_NULL_HANDLE;
@@ -0,0 +1,480 @@
+#include "denoise_gpu_harness.hpp"
+#include "shader_includer.hpp"
+#include "vulkan_utils.hpp"
+#include <array>
+#include <cstring>
+#include <memory>
+#include <shaderc/shaderc.hpp>
+#include <stdexcept>
+
+DenoiseGpuHarness::~DenoiseGpuHarness()
+{
+    if (device == VK_NULL_HANDLE)
+    {
+        if (instance != VK_NULL_HANDLE)
+        {
+            vkDestroyInstance(instance, nullptr);
+        }
+        return;
+    }
+    vkDeviceWaitIdle(device);
+
+    for (VkPipeline pipeline : pipelines)
+    {
+        vkDestroyPipeline(device, pipeline, nullptr);
+    }
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+    if (timestampQueryPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(device, timestampQueryPool, nullptr);
+    }
+    vkDestroySampler(device, sampler, nullptr);
+
+    std::array<VkImageView, 4> views = {colorImageView, normalImageView, depthImageView, outputImageView};
+    std::array<VkImage, 4> images = {colorImage, normalImage, depthImage, outputImage};
+    std::array<VkDeviceMemory, 4> memories = {colorImageMemory, normalImageMemory, depthImageMemory,
+                                              outputImageMemory};
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        vkDestroyImageView(device, views[i], nullptr);
+        vkDestroyImage(device, images[i], nullptr);
+        vkFreeMemory(device, memories[i], nullptr);
+    }
+    if (stagingBuffer != VK_NULL_HANDLE)
+    {
+        vkUnmapMemory(device, stagingBufferMemory);
+        vkDestroyBuffer(device, stagingBuffer, nullptr);
+        vkFreeMemory(device, stagingBufferMemory, nullptr);
+    }
+
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    vkDestroyDevice(device, nullptr);
+    vkDestroyInstance(instance, nullptr);
+}
+
+bool DenoiseGpuHarness::init(const DenoiseGBuffer& gbuffer, std::string& reason)
+{
+    if (!createDevice(reason))
+    {
+        return false;
+    }
+    width = gbuffer.width;
+    height = gbuffer.height;
+
+    createImages();
+    createDescriptors();
+    upload(normalImage, gbuffer.normal.data(), gbuffer.normal.size());
+    upload(depthImage, gbuffer.depth.data(), gbuffer.depth.size());
+    return true;
+}
+
+bool DenoiseGpuHarness::createDevice(std::string& reason)
+{
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "denoise_reference_test";
+    appInfo.apiVersion = VK_API_VERSION_1_1;
+
+    VkInstanceCreateInfo instanceInfo{};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pApplicationInfo = &appInfo;
+    if (vkCreateInstance(&instanceInfo, nullptr, &instance) != VK_SUCCESS)
+    {
+        instance = VK_NULL_HANDLE;
+        reason = "vkCreateInstance failed (no Vulkan ICD installed)";
+        return false;
+    }
+
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+    std::vector<VkPhysicalDevice> physicalDevices(deviceCount);
+    vkEnumeratePhysicalDevices(instance, &deviceCount, physicalDevices.data());
+
+    // 取第一个带计算队列的设备，lavapipe 与独显都满足
+    for (VkPhysicalDevice candidate : physicalDevices)
+    {
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, families.data());
+        for (uint32_t i = 0; i < familyCount; ++i)
+        {
+            if (families[i].queueFlags & VK_QUEUE_COMPUTE_BIT)
+            {
+                physicalDevice = candidate;
+                queueFamilyIndex = i;
+                break;
+            }
+        }
+        if (physicalDevice != VK_NULL_HANDLE)
+        {
+            break;
+        }
+    }
+    if (physicalDevice == VK_NULL_HANDLE)
+    {
+        reason = "no Vulkan device with a compute queue";
+        return false;
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    deviceName = properties.deviceName;
+
+    float queuePriority = 1.0f;
+    VkDeviceQueueCreateInfo queueInfo{};
+    queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueInfo.queueFamilyIndex = queueFamilyIndex;
+    queueInfo.queueCount = 1;
+    queueInfo.pQueuePriorities = &queuePriority;
+
+    VkDeviceCreateInfo deviceInfo{};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.queueCreateInfoCount = 1;
+    deviceInfo.pQueueCreateInfos = &queueInfo;
+    if (vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device) != VK_SUCCESS)
+    {
+        device = VK_NULL_HANDLE;
+        reason = "vkCreateDevice failed on " + deviceName;
+        return false;
+    }
+    vkGetDeviceQueue(device, queueFamilyIndex, 0, &queue);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = queueFamilyIndex;
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create denoise test command pool!");
+    }
+
+    if (properties.limits.timestampComputeAndGraphics)
+    {
+        timestampPeriod = properties.limits.timestampPeriod;
+        VkQueryPoolCreateInfo queryPoolInfo{};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount = 2;
+        if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &timestampQueryPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create denoise test timestamp query pool!");
+        }
+    }
+    return true;
+}
+
+void DenoiseGpuHarness::createImage(VkFormat format, VkImageUsageFlags usage, VkImage& image, VkDeviceMemory& memory,
+                                    VkImageView& view)
+{
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+    vulkanUtils.createImage(device, physicalDevice, width, height, format, VK_IMAGE_TILING_OPTIMAL, usage,
+                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory);
+    view = vulkanUtils.createImageView(device, image, format, VK_IMAGE_ASPECT_COLOR_BIT);
+}
+
+void DenoiseGpuHarness::createImages()
+{
+    VkFormat colorFormat = VK_FORMAT_R32G32B32A32_SFLOAT;
+    createImage(colorFormat,
+                VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                colorImage, colorImageMemory, colorImageView);
+    createImage(colorFormat, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, normalImage,
+                normalImageMemory, normalImageView);
+    createImage(VK_FORMAT_R32_SFLOAT, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, depthImage,
+                depthImageMemory, depthImageView);
+    createImage(colorFormat, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, outputImage,
+                outputImageMemory, outputImageView);
+
+    VkDeviceSize stagingSize = VkDeviceSize(width) * height * 4 * sizeof(float);
+    VulkanUtils::getInstance().createBuffer(device, physicalDevice, stagingSize,
+                                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                            stagingBuffer, stagingBufferMemory);
+    vkMapMemory(device, stagingBufferMemory, 0, stagingSize, 0, &stagingBufferMapped);
+
+    // 所有图像始终保持 GENERAL，既可以采样也可以作为 storage 与拷贝目标
+    VkCommandBuffer commandBuffer = VulkanUtils::getInstance().beginSingleTimeCommands(device, commandPool);
+    std::array<VkImageMemoryBarrier, 4> barriers{};
+    std::array<VkImage, 4> images = {colorImage, normalImage, depthImage, outputImage};
+    for (size_t i = 0; i < barriers.size(); ++i)
+    {
+        barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[i].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[i].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].image = images[i];
+        barriers[i].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        barriers[i].srcAccessMask = 0;
+        barriers[i].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT |
+                                    VK_ACCESS_SHADER_WRITE_BIT;
+    }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0,
+                         nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+    VulkanUtils::getInstance().endSingleTimeCommands(device, commandPool, queue, commandBuffer);
+
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_NEAREST; // svg_filter.comp 以像素中心 uv 采样，最近点与 texelFetch 一致
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create denoise test sampler!");
+    }
+}
+
+void DenoiseGpuHarness::createDescriptors()
+{
+    struct BindingInfo
+    {
+        uint32_t binding;
+        VkDescriptorType type;
+        VkImageView view;
+    };
+    std::array<BindingInfo, 5> bindingInfos = {{
+        {0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, colorImageView},
+        {1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, normalImageView},
+        {2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, depthImageView},
+        {3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, outputImageView},
+        {5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, colorImageView},
+    }};
+
+    std::array<VkDescriptorSetLayoutBinding, 5> bindings{};
+    for (size_t i = 0; i < bindings.size(); ++i)
+    {
+        bindings[i].binding = bindingInfos[i].binding;
+        bindings[i].descriptorType = bindingInfos[i].type;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create denoise test descriptor set layout!");
+    }
+
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[0].descriptorCount = 3;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSizes[1].descriptorCount = 2;
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 1;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create denoise test descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &descriptorSetLayout;
+    if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate denoise test descriptor set!");
+    }
+
+    std::array<VkDescriptorImageInfo, 5> imageInfos{};
+    std::array<VkWriteDescriptorSet, 5> writes{};
+    for (size_t i = 0; i < writes.size(); ++i)
+    {
+        bool sampled = bindingInfos[i].type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        imageInfos[i].sampler = sampled ? sampler : VK_NULL_HANDLE;
+        imageInfos[i].imageView = bindingInfos[i].view;
+        imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = descriptorSet;
+        writes[i].dstBinding = bindingInfos[i].binding;
+        writes[i].descriptorType = bindingInfos[i].type;
+        writes[i].descriptorCount = 1;
+        writes[i].pImageInfo = &imageInfos[i];
+    }
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create denoise test pipeline layout!");
+    }
+}
+
+VkPipeline DenoiseGpuHarness::createPipeline(const std::string& shaderPath, const std::vector<std::string>& macros)
+{
+    VulkanUtils& vulkanUtils = VulkanUtils::getInstance();
+    std::string source = vulkanUtils.readFileToString(shaderPath);
+    if (source.empty())
+    {
+        throw std::runtime_error("failed to open shader file: " + shaderPath);
+    }
+
+    shaderc::Compiler compiler;
+    shaderc::CompileOptions options;
+    options.SetIncluder(std::make_unique<ShaderIncluder>());
+    for (const std::string& macro : macros)
+    {
+        size_t equals = macro.find('=');
+        if (equals == std::string::npos)
+        {
+            options.AddMacroDefinition(macro);
+        }
+        else
+        {
+            options.AddMacroDefinition(macro.substr(0, equals), macro.substr(equals + 1));
+        }
+    }
+    auto result = compiler.CompileGlslToSpv(source, shaderc_glsl_compute_shader, shaderPath.c_str(), options);
+    if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+    {
+        throw std::runtime_error("Compute shader compilation error: " + result.GetErrorMessage());
+    }
+
+    std::vector<uint32_t> spirv(result.begin(), result.end());
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = spirv.size() * sizeof(uint32_t);
+    moduleInfo.pCode = spirv.data();
+    VkShaderModule shaderModule = vulkanUtils.createShaderModule(device, moduleInfo);
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = pipelineLayout;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult pipelineResult = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+    vkDestroyShaderModule(device, shaderModule, nullptr);
+    if (pipelineResult != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create denoise test pipeline for " + shaderPath);
+    }
+    pipelines.push_back(pipeline);
+    return pipeline;
+}
+
+void DenoiseGpuHarness::upload(VkImage image, const float* data, size_t floatCount)
+{
+    memcpy(stagingBufferMapped, data, floatCount * sizeof(float));
+
+    VkCommandBuffer commandBuffer = VulkanUtils::getInstance().beginSingleTimeCommands(device, commandPool);
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                         nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {width, height, 1};
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0,
+                         nullptr, 0, nullptr, 1, &barrier);
+    VulkanUtils::getInstance().endSingleTimeCommands(device, commandPool, queue, commandBuffer);
+}
+
+DenoiseImage DenoiseGpuHarness::run(VkPipeline pipeline, const DenoiseImage& input, PushConstants pushConstants,
+                                    float& gpuMilliseconds)
+{
+    if (input.width != width || input.height != height)
+    {
+        throw std::runtime_error("Denoise test: input image does not match the G-buffer size!");
+    }
+    upload(colorImage, input.data.data(), input.data.size());
+
+    VkCommandBuffer commandBuffer = VulkanUtils::getInstance().beginSingleTimeCommands(device, commandPool);
+    if (timestampQueryPool != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(commandBuffer, timestampQueryPool, 0, 2);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, 0);
+    }
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0,
+                            nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants),
+                       &pushConstants);
+    vkCmdDispatch(commandBuffer, (width + 15) / 16, (height + 15) / 16, 1);
+    if (timestampQueryPool != VK_NULL_HANDLE)
+    {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampQueryPool, 1);
+    }
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = outputImage;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                         nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {width, height, 1};
+    vkCmdCopyImageToBuffer(commandBuffer, outputImage, VK_IMAGE_LAYOUT_GENERAL, stagingBuffer, 1, &region);
+
+    VkMemoryBarrier hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1,
+                         &hostBarrier, 0, nullptr, 0, nullptr);
+    VulkanUtils::getInstance().endSingleTimeCommands(device, commandPool, queue, commandBuffer); // 内部等待队列空闲
+
+    DenoiseImage output(width, height);
+    memcpy(output.data.data(), stagingBufferMapped, output.data.size() * sizeof(float));
+
+    gpuMilliseconds = -1.0f;
+    std::array<uint64_t, 2> timestamps{};
+    if (timestampQueryPool != VK_NULL_HANDLE &&
+        vkGetQueryPoolResults(device, timestampQueryPool, 0, 2, sizeof(timestamps), timestamps.data(),
+                              sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS &&
+        timestamps[1] >= timestamps[0])
+    {
+        gpuMilliseconds = static_cast<float>(timestamps[1] - timestamps[0]) * timestampPeriod * 1e-6f;
+    }
+    return output;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "denoise_reference.hpp"
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// 无窗口的 Vulkan 计算环境，把降噪 shader 在固定尺寸的图像上跑一次并读回结果。
+// 描述符布局与 SVGFilterPass 中 stage 的绑定点一致：0 颜色 (采样)、1 法线、2 深度、3 输出、5 颜色 (storage)，
+// push constant 为 {stepSize, lastIteration}；颜色图像保持 GENERAL，同时作为采样与 storage 输入
+class DenoiseGpuHarness
+{
+  public:
+    struct PushConstants
+    {
+        int stepSize = 1;
+        int lastIteration = 0;
+    };
+
+    ~DenoiseGpuHarness();
+
+    // 没有可用的 Vulkan 实现 (例如未安装 lavapipe) 时返回 false，reason 给出原因；之后的调用都会抛出异常
+    bool init(const DenoiseGBuffer& gbuffer, std::string& reason);
+
+    std::string getDeviceName() const
+    {
+        return deviceName;
+    }
+
+    // 编译 shaderPath 的计算着色器，macros 为额外的宏定义 (NAME 或 NAME=VALUE)
+    VkPipeline createPipeline(const std::string& shaderPath, const std::vector<std::string>& macros = {});
+
+    // 以 input 为颜色输入 dispatch 一次，返回读回的输出；gpuMilliseconds 为时间戳测得的 dispatch 耗时，
+    // 设备不支持计算队列时间戳时为 -1
+    DenoiseImage run(VkPipeline pipeline, const DenoiseImage& input, PushConstants pushConstants,
+                     float& gpuMilliseconds);
+
+  private:
+    VkInstance instance = VK_NULL_HANDLE;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+    uint32_t queueFamilyIndex = 0;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    std::string deviceName;
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    VkImage colorImage = VK_NULL_HANDLE;
+    VkDeviceMemory colorImageMemory = VK_NULL_HANDLE;
+    VkImageView colorImageView = VK_NULL_HANDLE;
+    VkImage normalImage = VK_NULL_HANDLE;
+    VkDeviceMemory normalImageMemory = VK_NULL_HANDLE;
+    VkImageView normalImageView = VK_NULL_HANDLE;
+    VkImage depthImage = VK_NULL_HANDLE;
+    VkDeviceMemory depthImageMemory = VK_NULL_HANDLE;
+    VkImageView depthImageView = VK_NULL_HANDLE;
+    VkImage outputImage = VK_NULL_HANDLE;
+    VkDeviceMemory outputImageMemory = VK_NULL_HANDLE;
+    VkImageView outputImageView = VK_NULL_HANDLE;
+    VkSampler sampler = VK_NULL_HANDLE;
+
+    // 上传与读回共用，主机可见
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+    void* stagingBufferMapped = nullptr;
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    std::vector<VkPipeline> pipelines;
+
+    VkQueryPool timestampQueryPool = VK_NULL_HANDLE;
+    float timestampPeriod = 0.0f;
+
+    bool createDevice(std::string& reason);
+    void createImages();
+    void createImage(VkFormat format, VkImageUsageFlags usage, VkImage& image, VkDeviceMemory& memory,
+                     VkImageView& view);
+    void createDescriptors();
+    void upload(VkImage image, const float* data, size_t floatCount);
+};
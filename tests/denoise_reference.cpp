@@ -0,0 +1,373 @@
+#include "denoise_reference.hpp"
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+constexpr float SVGF_EPSILON = 0.0001f;
+constexpr float SVGF_PHI_NORMAL = 128.0f;
+constexpr float SVGF_PHI_DEPTH = 1.0f;
+constexpr float SVGF_PHI_COLOR = 4.0f; // 与 svgf_atrous.comp 一致
+
+// 每个线程处理连续的一段行，行之间没有依赖
+template <typename RowFunction> void parallelForRows(uint32_t height, const RowFunction& rowFunction)
+{
+    uint32_t threadCount = std::clamp(std::thread::hardware_concurrency(), 1u, std::max(height, 1u));
+    uint32_t rowsPerThread = (height + threadCount - 1) / threadCount;
+    std::vector<std::thread> threads;
+    for (uint32_t begin = 0; begin < height; begin += rowsPerThread)
+    {
+        uint32_t end = std::min(begin + rowsPerThread, height);
+        threads.emplace_back([&rowFunction, begin, end]() {
+            for (uint32_t y = begin; y < end; ++y)
+            {
+                rowFunction(static_cast<int>(y));
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void checkGBuffer(const DenoiseImage& input, const DenoiseGBuffer& gbuffer)
+{
+    size_t pixelCount = size_t(input.width) * input.height;
+    if (gbuffer.width != input.width || gbuffer.height != input.height || gbuffer.normal.size() != pixelCount * 4 ||
+        gbuffer.depth.size() != pixelCount)
+    {
+        throw std::runtime_error("Denoise reference: G-buffer size does not match the input image!");
+    }
+}
+
+bool isInsideImage(int x, int y, const DenoiseImage& image)
+{
+    return x >= 0 && y >= 0 && x < static_cast<int>(image.width) && y < static_cast<int>(image.height);
+}
+
+float luminance(const glm::vec3& c)
+{
+    return glm::dot(c, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+}
+
+glm::vec3 loadColor(const DenoiseImage& image, int x, int y)
+{
+    const float* p = image.pixel(x, y);
+    return glm::vec3(p[0], p[1], p[2]);
+}
+
+void storeColor(DenoiseImage& image, int x, int y, const glm::vec3& color, float alpha)
+{
+    float* p = image.pixel(x, y);
+    p[0] = color.x;
+    p[1] = color.y;
+    p[2] = color.z;
+    p[3] = alpha;
+}
+
+glm::vec3 loadEncodedNormal(const DenoiseGBuffer& gbuffer, int x, int y)
+{
+    const float* p = gbuffer.normal.data() + (size_t(y) * gbuffer.width + x) * 4;
+    return glm::vec3(p[0], p[1], p[2]) * 2.0f - 1.0f;
+}
+
+float loadDepth(const DenoiseGBuffer& gbuffer, int x, int y)
+{
+    return gbuffer.depth[size_t(y) * gbuffer.width + x];
+}
+
+// svgf_common.glsl 中的 depthGradient
+glm::vec2 depthGradient(const DenoiseGBuffer& gbuffer, int x, int y)
+{
+    int right = std::min(x + 1, static_cast<int>(gbuffer.width) - 1);
+    int left = std::max(x - 1, 0);
+    int down = std::min(y + 1, static_cast<int>(gbuffer.height) - 1);
+    int up = std::max(y - 1, 0);
+    float dx = loadDepth(gbuffer, right, y) - loadDepth(gbuffer, left, y);
+    float dy = loadDepth(gbuffer, x, down) - loadDepth(gbuffer, x, up);
+    return glm::vec2(dx / float(std::max(right - left, 1)), dy / float(std::max(down - up, 1)));
+}
+
+float geometryWeight(const glm::vec3& N, float depth, const glm::vec2& gradient, const glm::vec3& sampleN,
+                     float sampleDepth, const glm::vec2& offset)
+{
+    float depthDistance =
+        std::abs(sampleDepth - depth) / (SVGF_PHI_DEPTH * std::abs(glm::dot(gradient, offset)) + SVGF_EPSILON);
+    return std::pow(std::max(glm::dot(N, sampleN), 0.0f), SVGF_PHI_NORMAL) * std::exp(-depthDistance);
+}
+
+float blurredVariance(const DenoiseImage& input, int x, int y)
+{
+    const float kernel[2] = {0.25f, 0.125f};
+    float sum = 0.0f;
+    float weightSum = 0.0f;
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+            if (!isInsideImage(x + dx, y + dy, input))
+            {
+                continue;
+            }
+            float w = kernel[std::abs(dx)] * kernel[std::abs(dy)];
+            sum += input.pixel(x + dx, y + dy)[3] * w;
+            weightSum += w;
+        }
+    }
+    return sum / weightSum;
+}
+} // namespace
+
+void sigmaClipReference(const DenoiseImage& input, DenoiseImage& output)
+{
+    output = DenoiseImage(input.width, input.height);
+    int width = static_cast<int>(input.width);
+    int height = static_cast<int>(input.height);
+    parallelForRows(input.height, [&](int y) {
+        for (int x = 0; x < width; ++x)
+        {
+            glm::vec3 sum(0.0f);
+            glm::vec3 sumSq(0.0f);
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    int sx = std::clamp(x + dx, 0, width - 1); // 与 shader 一样，边界像素也要写出
+                    int sy = std::clamp(y + dy, 0, height - 1);
+                    glm::vec3 color = loadColor(input, sx, sy);
+                    sum += color;
+                    sumSq += color * color;
+                }
+            }
+            glm::vec3 mean = sum / 9.0f;
+            glm::vec3 stddev = glm::sqrt(glm::max(sumSq / 9.0f - mean * mean, glm::vec3(1e-6f)));
+            storeColor(output, x, y, glm::clamp(loadColor(input, x, y), mean - stddev, mean + stddev), 1.0f);
+        }
+    });
+}
+
+void bilateralReference(const DenoiseImage& input, const DenoiseGBuffer& gbuffer, DenoiseImage& output)
+{
+    checkGBuffer(input, gbuffer);
+    output = DenoiseImage(input.width, input.height);
+
+    // 与 svg_filter.comp 一致
+    const float sigmaColor = 0.3f;
+    const float sigmaNormal = 0.15f;
+    const float sigmaDepth = 0.2f;
+    const int kernelRadius = 2;
+
+    parallelForRows(input.height, [&](int y) {
+        for (int x = 0; x < static_cast<int>(input.width); ++x)
+        {
+            glm::vec3 centerColor = loadColor(input, x, y);
+            glm::vec3 centerNormal = loadEncodedNormal(gbuffer, x, y);
+            float centerDepth = loadDepth(gbuffer, x, y);
+
+            glm::vec3 accumulatedColor(0.0f);
+            float totalWeight = 0.0f;
+            for (int dy = -kernelRadius; dy <= kernelRadius; ++dy)
+            {
+                for (int dx = -kernelRadius; dx <= kernelRadius; ++dx)
+                {
+                    int sx = x + dx;
+                    int sy = y + dy;
+                    if (!isInsideImage(sx, sy, input))
+                    {
+                        continue;
+                    }
+                    glm::vec3 sampleColor = loadColor(input, sx, sy);
+                    glm::vec3 colorDiff = centerColor - sampleColor;
+                    float weightColor = std::exp(-glm::dot(colorDiff, colorDiff) / (2.0f * sigmaColor * sigmaColor));
+                    float normalDifference = 1.0f - glm::dot(centerNormal, loadEncodedNormal(gbuffer, sx, sy));
+                    float weightNormal =
+                        std::exp(-(normalDifference * normalDifference) / (2.0f * sigmaNormal * sigmaNormal));
+                    float depthDifference = std::abs(centerDepth - loadDepth(gbuffer, sx, sy));
+                    float weightDepth =
+                        std::exp(-(depthDifference * depthDifference) / (2.0f * sigmaDepth * sigmaDepth));
+
+                    float weight = weightColor * weightNormal * weightDepth;
+                    accumulatedColor += sampleColor * weight;
+                    totalWeight += weight;
+                }
+            }
+
+            glm::vec3 finalColor = totalWeight > 0.00001f ? accumulatedColor / totalWeight : centerColor;
+            storeColor(output, x, y, finalColor, 1.0f);
+        }
+    });
+}
+
+void jointBilateralReference(const DenoiseImage& input, const DenoiseGBuffer& gbuffer, DenoiseImage& output)
+{
+    checkGBuffer(input, gbuffer);
+    output = DenoiseImage(input.width, input.height);
+
+    // 与 joint_bilateral_denoise.comp 一致
+    const int halfSize = 1;
+    const float fixNorm = 9.0f;
+    const float depthSigma = 0.01f;
+    const float normalSigma = 8.0f;
+    const float colorSigma = 0.1f;
+    int width = static_cast<int>(input.width);
+    int height = static_cast<int>(input.height);
+
+    parallelForRows(input.height, [&](int y) {
+        for (int x = 0; x < width; ++x)
+        {
+            glm::vec3 sumColor(0.0f);
+            for (int dy = -halfSize; dy <= halfSize; ++dy)
+            {
+                for (int dx = -halfSize; dx <= halfSize; ++dx)
+                {
+                    sumColor += loadColor(input, std::clamp(x + dx, 0, width - 1), std::clamp(y + dy, 0, height - 1));
+                }
+            }
+            glm::vec3 meanColor = sumColor / fixNorm;
+
+            glm::vec3 varColor(0.0f);
+            for (int dy = -halfSize; dy <= halfSize; ++dy)
+            {
+                for (int dx = -halfSize; dx <= halfSize; ++dx)
+                {
+                    glm::vec3 d = loadColor(input, std::clamp(x + dx, 0, width - 1),
+                                            std::clamp(y + dy, 0, height - 1)) -
+                                  meanColor;
+                    varColor += d * d;
+                }
+            }
+            glm::vec3 sigmaColor = glm::sqrt(varColor / fixNorm);
+            glm::vec3 low = meanColor - sigmaColor;
+            glm::vec3 high = meanColor + sigmaColor;
+
+            glm::vec3 filteredColor = glm::clamp(loadColor(input, x, y), low, high);
+            glm::vec3 centerNormal = loadEncodedNormal(gbuffer, x, y);
+            float centerDepth = loadDepth(gbuffer, x, y);
+
+            glm::vec3 sum(0.0f);
+            float weightSum = 0.0f;
+            for (int dy = -halfSize; dy <= halfSize; ++dy)
+            {
+                for (int dx = -halfSize; dx <= halfSize; ++dx)
+                {
+                    int sx = std::clamp(x + dx, 0, width - 1);
+                    int sy = std::clamp(y + dy, 0, height - 1);
+                    glm::vec3 neighborColor = glm::clamp(loadColor(input, sx, sy), low, high);
+                    float colorDistance = glm::length(filteredColor - neighborColor);
+                    float depthDistance = std::abs(centerDepth - loadDepth(gbuffer, sx, sy));
+                    float normalDot = std::max(0.0f, glm::dot(centerNormal, loadEncodedNormal(gbuffer, sx, sy)));
+
+                    float weightDepth = std::exp(-depthDistance / (depthSigma + 1e-5f));
+                    float weightNormal = std::pow(normalDot, normalSigma);
+                    float weightColor = std::exp(-colorDistance / (colorSigma + 1e-5f));
+                    float w = weightDepth + weightNormal / fixNorm + weightColor / fixNorm;
+
+                    sum += w * neighborColor;
+                    weightSum += w;
+                }
+            }
+            storeColor(output, x, y, sum / std::max(weightSum, 1e-7f), 1.0f);
+        }
+    });
+}
+
+void atrousReference(const DenoiseImage& input, const DenoiseGBuffer& gbuffer, int stepSize, bool lastIteration,
+                     DenoiseImage& output)
+{
+    checkGBuffer(input, gbuffer);
+    output = DenoiseImage(input.width, input.height);
+
+    const float kernel[3] = {3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f};
+    parallelForRows(input.height, [&](int y) {
+        for (int x = 0; x < static_cast<int>(input.width); ++x)
+        {
+            const float* center = input.pixel(x, y);
+            glm::vec3 centerColor(center[0], center[1], center[2]);
+            float depth = loadDepth(gbuffer, x, y);
+            if (depth >= 1.0f)
+            {
+                storeColor(output, x, y, centerColor, lastIteration ? 1.0f : center[3]);
+                continue;
+            }
+
+            glm::vec3 N = glm::normalize(loadEncodedNormal(gbuffer, x, y));
+            glm::vec2 gradient = depthGradient(gbuffer, x, y);
+            float lumCenter = luminance(centerColor);
+            float phiLuminance =
+                SVGF_PHI_COLOR * std::sqrt(std::max(blurredVariance(input, x, y), 0.0f)) + SVGF_EPSILON;
+
+            glm::vec3 colorSum = centerColor * kernel[0] * kernel[0];
+            float varianceSum = center[3] * kernel[0] * kernel[0] * kernel[0] * kernel[0];
+            float weightSum = kernel[0] * kernel[0];
+            for (int dy = -2; dy <= 2; ++dy)
+            {
+                for (int dx = -2; dx <= 2; ++dx)
+                {
+                    if (dx == 0 && dy == 0)
+                    {
+                        continue;
+                    }
+                    glm::vec2 offset(dx * stepSize, dy * stepSize);
+                    int sx = x + dx * stepSize;
+                    int sy = y + dy * stepSize;
+                    if (!isInsideImage(sx, sy, input))
+                    {
+                        continue;
+                    }
+                    float sampleDepth = loadDepth(gbuffer, sx, sy);
+                    if (sampleDepth >= 1.0f)
+                    {
+                        continue; // 背景
+                    }
+
+                    const float* sample = input.pixel(sx, sy);
+                    glm::vec3 sampleColor(sample[0], sample[1], sample[2]);
+                    glm::vec3 sampleN = glm::normalize(loadEncodedNormal(gbuffer, sx, sy));
+                    float w = kernel[std::abs(dx)] * kernel[std::abs(dy)] *
+                              geometryWeight(N, depth, gradient, sampleN, sampleDepth, offset);
+                    w *= std::exp(-std::abs(luminance(sampleColor) - lumCenter) / phiLuminance);
+
+                    colorSum += sampleColor * w;
+                    varianceSum += sample[3] * w * w;
+                    weightSum += w;
+                }
+            }
+
+            float variance = varianceSum / (weightSum * weightSum);
+            storeColor(output, x, y, colorSum / weightSum, lastIteration ? 1.0f : variance);
+        }
+    });
+}
+
+DenoiseImageDifference compareDenoiseImages(const DenoiseImage& a, const DenoiseImage& b, float tolerance)
+{
+    if (a.width != b.width || a.height != b.height || a.data.size() != b.data.size())
+    {
+        throw std::runtime_error("Denoise reference: compared images have different sizes!");
+    }
+
+    DenoiseImageDifference difference{};
+    double errorSum = 0.0;
+    size_t pixelCount = size_t(a.width) * a.height;
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        bool mismatched = false;
+        for (size_t c = 0; c < 4; ++c)
+        {
+            float error = std::abs(a.data[i * 4 + c] - b.data[i * 4 + c]);
+            difference.maxError = std::max(difference.maxError, error);
+            if (c < 3)
+            {
+                errorSum += error;
+                mismatched = mismatched || error / std::max(std::abs(b.data[i * 4 + c]), 1.0f) > tolerance;
+            }
+        }
+        difference.mismatchedPixels += mismatched ? 1 : 0;
+    }
+    difference.meanError = pixelCount > 0 ? static_cast<float>(errorSum / (pixelCount * 3)) : 0.0f;
+    return difference;
+}
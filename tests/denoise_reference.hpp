@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 降噪核的 CPU 参考实现，逐像素对应 shader/sigma_clip_denoise.comp、svg_filter.comp、joint_bilateral_denoise.comp
+// 与 svgf_atrous.comp，只用于 denoise_reference_test，与存储的参考图像以及 GPU 的输出对照。
+// 图像按行分块交给多个线程，像素内的计算与 shader 一样使用 glm 向量
+
+// RGBA32F，行优先
+struct DenoiseImage
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<float> data;
+
+    DenoiseImage() = default;
+    DenoiseImage(uint32_t width, uint32_t height) : width(width), height(height), data(size_t(width) * height * 4)
+    {
+    }
+
+    float* pixel(int x, int y)
+    {
+        return data.data() + (size_t(y) * width + x) * 4;
+    }
+    const float* pixel(int x, int y) const
+    {
+        return data.data() + (size_t(y) * width + x) * 4;
+    }
+};
+
+// 与 G-buffer 附件的内容一致：normal 为 n * 0.5 + 0.5 (RGBA)，depth 为深度附件的值，背景为 1.0
+struct DenoiseGBuffer
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<float> normal;
+    std::vector<float> depth;
+};
+
+// 3x3 邻域均值 ± 标准差截断，边界按 clamp 取邻居
+void sigmaClipReference(const DenoiseImage& input, DenoiseImage& output);
+
+// 5x5 颜色 / 法线 / 深度双边滤波
+void bilateralReference(const DenoiseImage& input, const DenoiseGBuffer& gbuffer, DenoiseImage& output);
+
+// 3x3 离群点截断后的联合双边滤波
+void jointBilateralReference(const DenoiseImage& input, const DenoiseGBuffer& gbuffer, DenoiseImage& output);
+
+// SVGF 的一次 à-trous 迭代，input 的 alpha 为方差；lastIteration 时 alpha 写 1
+void atrousReference(const DenoiseImage& input, const DenoiseGBuffer& gbuffer, int stepSize, bool lastIteration,
+                     DenoiseImage& output);
+
+struct DenoiseImageDifference
+{
+    float maxError = 0.0f;         // 所有通道中最大的绝对误差
+    float meanError = 0.0f;        // RGB 通道的平均绝对误差
+    uint32_t mismatchedPixels = 0; // 任一 RGB 通道的相对误差超过容差的像素数
+};
+
+// 按 |a - b| / max(|b|, 1) 比较 RGB，b 视为参考；GPU 的超越函数与 half 存储都有误差，容差应按存储精度选取
+DenoiseImageDifference compareDenoiseImages(const DenoiseImage& a, const DenoiseImage& b, float tolerance);
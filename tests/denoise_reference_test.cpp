@@ -0,0 +1,330 @@
+// 降噪核的回归测试：
+// 1. 在 tests/data/denoise 下存储的输入上运行 CPU 参考实现，与存储的参考输出逐像素比较；
+// 2. 有可用的 Vulkan 实现 (独显驱动或 lavapipe) 时，再把对应的 shader dispatch 一次并与 CPU 结果比较。
+// 打印每个核的 CPU / GPU 耗时，任一比较失败时返回非零。
+// 用法：denoise_reference_test <仓库根目录> [--regenerate]，--regenerate 重新生成输入与参考输出
+#include "denoise_gpu_harness.hpp"
+#include "denoise_reference.hpp"
+#include "denoiser_chain.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr uint32_t TEST_WIDTH = 40; // 不是 16 的倍数，覆盖工作组越界的分支
+constexpr uint32_t TEST_HEIGHT = 28;
+constexpr float CPU_TOLERANCE = 1e-4f; // 与存储参考比较，只容许编译器 / libm 差异
+constexpr float GPU_TOLERANCE = 2e-2f; // GPU 的 exp / pow 精度较低，阈值附近的像素可能整体偏移
+constexpr uint32_t GPU_MISMATCH_DIVISOR = 200; // 允许至多 0.5% 的像素超出 GPU 容差
+
+struct KernelCase
+{
+    const char* name;
+    const char* referenceFile;
+    const char* shaderFile;
+    // 大于 0 时与 SVGFilterPass 一致：步长不超过它的 pass 使用 SHARED_MEMORY_TILE 版本的管线，其余使用全局内存版本
+    uint32_t sharedTileMaxStep;
+    std::function<DenoiseImage(const DenoiseImage&, const DenoiseGBuffer&)> cpu;
+    // 多次 dispatch 的核 (à-trous 链) 依次使用这些 push constant，每次的输出作为下一次的输入
+    std::vector<DenoiseGpuHarness::PushConstants> gpuPasses;
+};
+
+// 文件头为 width、height、通道数三个 uint32，随后是 float 数据
+void writeBuffer(const std::string& path, uint32_t width, uint32_t height, uint32_t channels,
+                 const std::vector<float>& data)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to write " + path);
+    }
+    uint32_t header[3] = {width, height, channels};
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+}
+
+std::vector<float> readBuffer(const std::string& path, uint32_t width, uint32_t height, uint32_t channels)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open " + path + " (run with --regenerate to create it)");
+    }
+    uint32_t header[3] = {};
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (header[0] != width || header[1] != height || header[2] != channels)
+    {
+        throw std::runtime_error(path + " has an unexpected size");
+    }
+    std::vector<float> data(size_t(width) * height * channels);
+    file.read(reinterpret_cast<char*>(data.data()), data.size() * sizeof(float));
+    if (!file)
+    {
+        throw std::runtime_error(path + " is truncated");
+    }
+    return data;
+}
+
+// 确定性的伪随机数，保证重新生成的输入在不同平台上一致
+float hashNoise(uint32_t x, uint32_t y, uint32_t channel)
+{
+    uint32_t h = x * 73856093u ^ y * 19349663u ^ channel * 83492791u;
+    h = (h ^ (h >> 16)) * 0x7feb352du;
+    h = (h ^ (h >> 15)) * 0x846ca68bu;
+    h ^= h >> 16;
+    return static_cast<float>(h & 0xFFFFFFu) / static_cast<float>(0x1000000u);
+}
+
+// 合成场景：地面、后墙、左侧斜面与右上角的背景，颜色带噪声与少量萤火虫像素，alpha 为方差
+void generateInputs(DenoiseImage& color, DenoiseGBuffer& gbuffer)
+{
+    color = DenoiseImage(TEST_WIDTH, TEST_HEIGHT);
+    gbuffer.width = TEST_WIDTH;
+    gbuffer.height = TEST_HEIGHT;
+    gbuffer.normal.assign(size_t(TEST_WIDTH) * TEST_HEIGHT * 4, 0.0f);
+    gbuffer.depth.assign(size_t(TEST_WIDTH) * TEST_HEIGHT, 1.0f);
+
+    for (uint32_t y = 0; y < TEST_HEIGHT; ++y)
+    {
+        for (uint32_t x = 0; x < TEST_WIDTH; ++x)
+        {
+            size_t index = size_t(y) * TEST_WIDTH + x;
+            float normal[3] = {0.0f, 0.0f, 1.0f};
+            float albedo[3] = {0.7f, 0.7f, 0.7f};
+            float depth = 1.0f;
+            if (y >= TEST_HEIGHT * 2 / 3)
+            {
+                normal[1] = 1.0f; // 地面，深度随行变化
+                normal[2] = 0.0f;
+                depth = 0.90f + 0.002f * float(TEST_HEIGHT - y);
+                albedo[0] = 0.8f;
+                albedo[1] = 0.6f;
+                albedo[2] = 0.4f;
+            }
+            else if (x < TEST_WIDTH / 4)
+            {
+                normal[0] = 0.7071f; // 左侧斜面
+                normal[2] = 0.7071f;
+                depth = 0.93f + 0.001f * float(x);
+                albedo[0] = 0.9f;
+                albedo[1] = 0.2f;
+                albedo[2] = 0.2f;
+            }
+            else if (!(x >= TEST_WIDTH * 3 / 4 && y < TEST_HEIGHT / 3))
+            {
+                depth = 0.95f; // 后墙
+            }
+
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                gbuffer.normal[index * 4 + c] = depth < 1.0f ? normal[c] * 0.5f + 0.5f : 0.0f;
+            }
+            gbuffer.normal[index * 4 + 3] = depth < 1.0f ? 1.0f : 0.0f;
+            gbuffer.depth[index] = depth;
+
+            float* pixel = color.pixel(x, y);
+            float noiseAmplitude = depth < 1.0f ? 0.3f : 0.05f;
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                float base = depth < 1.0f ? albedo[c] : 0.2f + 0.1f * float(c);
+                pixel[c] = std::max(base + (hashNoise(x, y, c) - 0.5f) * 2.0f * noiseAmplitude, 0.0f);
+            }
+            if (hashNoise(x, y, 3) > 0.985f)
+            {
+                pixel[0] = pixel[1] = pixel[2] = 40.0f; // 萤火虫
+            }
+            pixel[3] = noiseAmplitude * noiseAmplitude / 3.0f;
+        }
+    }
+}
+
+std::vector<KernelCase> makeKernelCases()
+{
+    std::vector<KernelCase> cases;
+    cases.push_back({"Sigma Clip", "sigma_clip.bin", "sigma_clip_denoise.comp", 0,
+                     [](const DenoiseImage& input, const DenoiseGBuffer&) {
+                         DenoiseImage output(input.width, input.height);
+                         sigmaClipReference(input, output);
+                         return output;
+                     },
+                     {{1, 0}}});
+    cases.push_back({"Bilateral", "bilateral.bin", "svg_filter.comp", 0,
+                     [](const DenoiseImage& input, const DenoiseGBuffer& gbuffer) {
+                         DenoiseImage output(input.width, input.height);
+                         bilateralReference(input, gbuffer, output);
+                         return output;
+                     },
+                     {{1, 0}}});
+    cases.push_back({"Joint Bilateral", "joint_bilateral.bin", "joint_bilateral_denoise.comp", 0,
+                     [](const DenoiseImage& input, const DenoiseGBuffer& gbuffer) {
+                         DenoiseImage output(input.width, input.height);
+                         jointBilateralReference(input, gbuffer, output);
+                         return output;
+                     },
+                     {{1, 0}}});
+
+    // SVGF 默认 5 次迭代，步长 1..16，最后一次把 alpha 写为 1
+    std::vector<DenoiseGpuHarness::PushConstants> chain;
+    for (int i = 0; i < 5; ++i)
+    {
+        chain.push_back({1 << i, i == 4 ? 1 : 0});
+    }
+    auto atrousChain = [chain](const DenoiseImage& input, const DenoiseGBuffer& gbuffer) {
+        DenoiseImage current = input;
+        DenoiseImage output(input.width, input.height);
+        for (const DenoiseGpuHarness::PushConstants& pass : chain)
+        {
+            atrousReference(current, gbuffer, pass.stepSize, pass.lastIteration != 0, output);
+            std::swap(current, output);
+        }
+        return current;
+    };
+    cases.push_back({"SVGF A-Trous", "atrous.bin", "svgf_atrous.comp", 0, atrousChain, chain});
+    cases.push_back({"SVGF A-Trous (shared tile)", "atrous.bin", "svgf_atrous.comp", SVGF_SHARED_TILE_MAX_STEP,
+                     atrousChain, chain});
+    return cases;
+}
+
+bool reportDifference(const char* name, const char* against, const DenoiseImageDifference& difference,
+                      uint32_t allowedMismatches)
+{
+    bool passed = difference.mismatchedPixels <= allowedMismatches;
+    std::printf("  %-28s vs %-9s max %.3e  mean %.3e  mismatched %u  %s\n", name, against, difference.maxError,
+                difference.meanError, difference.mismatchedPixels, passed ? "ok" : "FAILED");
+    return passed;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: denoise_reference_test <repository root> [--regenerate]" << std::endl;
+        return 2;
+    }
+    std::string root = argv[1];
+    bool regenerate = argc > 2 && std::strcmp(argv[2], "--regenerate") == 0;
+    std::string dataDirectory = root + "/tests/data/denoise/";
+    std::string shaderDirectory = root + "/shader/";
+
+    try
+    {
+        DenoiseImage color(TEST_WIDTH, TEST_HEIGHT);
+        DenoiseGBuffer gbuffer;
+        if (regenerate)
+        {
+            generateInputs(color, gbuffer);
+            writeBuffer(dataDirectory + "color.bin", TEST_WIDTH, TEST_HEIGHT, 4, color.data);
+            writeBuffer(dataDirectory + "normal.bin", TEST_WIDTH, TEST_HEIGHT, 4, gbuffer.normal);
+            writeBuffer(dataDirectory + "depth.bin", TEST_WIDTH, TEST_HEIGHT, 1, gbuffer.depth);
+        }
+        else
+        {
+            color.data = readBuffer(dataDirectory + "color.bin", TEST_WIDTH, TEST_HEIGHT, 4);
+            gbuffer.width = TEST_WIDTH;
+            gbuffer.height = TEST_HEIGHT;
+            gbuffer.normal = readBuffer(dataDirectory + "normal.bin", TEST_WIDTH, TEST_HEIGHT, 4);
+            gbuffer.depth = readBuffer(dataDirectory + "depth.bin", TEST_WIDTH, TEST_HEIGHT, 1);
+        }
+
+        auto gpu = std::make_unique<DenoiseGpuHarness>();
+        std::string reason;
+        bool gpuAvailable = !regenerate && gpu->init(gbuffer, reason);
+        if (gpuAvailable)
+        {
+            std::printf("GPU: %s\n", gpu->getDeviceName().c_str());
+        }
+        else if (!regenerate)
+        {
+            std::printf("GPU comparison skipped: %s\n", reason.c_str());
+        }
+
+        bool passed = true;
+        for (const KernelCase& kernel : makeKernelCases())
+        {
+            auto cpuBegin = std::chrono::high_resolution_clock::now();
+            DenoiseImage cpuOutput = kernel.cpu(color, gbuffer);
+            auto cpuEnd = std::chrono::high_resolution_clock::now();
+            float cpuMilliseconds = std::chrono::duration<float, std::milli>(cpuEnd - cpuBegin).count();
+
+            std::string referencePath = dataDirectory + kernel.referenceFile;
+            if (regenerate)
+            {
+                if (kernel.sharedTileMaxStep == 0) // 共享内存变体与基础版本共用参考输出
+                {
+                    writeBuffer(referencePath, TEST_WIDTH, TEST_HEIGHT, 4, cpuOutput.data);
+                    std::printf("wrote %s\n", referencePath.c_str());
+                }
+                continue;
+            }
+
+            DenoiseImage reference(TEST_WIDTH, TEST_HEIGHT);
+            reference.data = readBuffer(referencePath, TEST_WIDTH, TEST_HEIGHT, 4);
+            std::printf("%s: CPU %.3f ms", kernel.name, cpuMilliseconds);
+
+            DenoiseImage gpuOutput;
+            float gpuMilliseconds = 0.0f;
+            if (gpuAvailable)
+            {
+                std::string shaderPath = shaderDirectory + kernel.shaderFile;
+                VkPipeline pipeline = gpu->createPipeline(shaderPath);
+                VkPipeline tiledPipeline = VK_NULL_HANDLE;
+                if (kernel.sharedTileMaxStep > 0)
+                {
+                    std::string tileMacro = "SHARED_MEMORY_TILE=" + std::to_string(kernel.sharedTileMaxStep);
+                    tiledPipeline = gpu->createPipeline(shaderPath, {tileMacro});
+                }
+                DenoiseImage current = color;
+                for (const DenoiseGpuHarness::PushConstants& pass : kernel.gpuPasses)
+                {
+                    bool tiled = static_cast<uint32_t>(pass.stepSize) <= kernel.sharedTileMaxStep;
+                    float passMilliseconds = 0.0f;
+                    current = gpu->run(tiled ? tiledPipeline : pipeline, current, pass, passMilliseconds);
+                    gpuMilliseconds = passMilliseconds < 0.0f || gpuMilliseconds < 0.0f
+                                          ? -1.0f
+                                          : gpuMilliseconds + passMilliseconds;
+                }
+                gpuOutput = std::move(current);
+                if (gpuMilliseconds >= 0.0f)
+                {
+                    std::printf(", GPU %.3f ms", gpuMilliseconds);
+                }
+                else
+                {
+                    std::printf(", GPU (no timestamps)");
+                }
+            }
+            std::printf("\n");
+
+            passed &= reportDifference(kernel.name, "reference", compareDenoiseImages(cpuOutput, reference,
+                                                                                      CPU_TOLERANCE), 0);
+            if (gpuAvailable)
+            {
+                uint32_t allowed = TEST_WIDTH * TEST_HEIGHT / GPU_MISMATCH_DIVISOR;
+                passed &= reportDifference(kernel.name, "GPU", compareDenoiseImages(gpuOutput, cpuOutput,
+                                                                                    GPU_TOLERANCE), allowed);
+            }
+        }
+
+        if (regenerate)
+        {
+            return 0;
+        }
+        std::printf(passed ? "all denoise kernels match\n" : "denoise kernel mismatch\n");
+        return passed ? 0 : 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}